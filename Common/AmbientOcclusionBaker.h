@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bvh.h"
+#include "JobSystem.h"
+
+// Oclusão ambiente por vértice para objetos estáticos, calculada uma vez em CPU.
+// Cada vértice lança raios no hemisfério (distribuição de cosseno, então a fração de raios livres
+// já é a visibilidade ponderada) contra uma BVH dos oclusores, em pacotes SSE de 4 raios e com
+// os vértices repartidos no sistema de jobs. O resultado (1 = aberto, 0 = fechado) vai no atributo
+// 3 do VBO e multiplica o termo ambiente nos shaders.
+// O cache em disco usa como chave um hash dos vértices, da matriz model, dos oclusores e dos parâmetros.
+class AmbientOcclusionBaker
+{
+public:
+    AmbientOcclusionBaker();
+
+    // Arredondado para múltiplo de 4 (um pacote SSE)
+    void setSampleCount(int samples);
+    // Alcance dos raios em unidades de mundo: só o que está perto escurece
+    void setMaxDistance(float distance) { maxDistance_ = distance; }
+    // nullptr usa JobSystem::shared()
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+    void setCacheDirectory(const std::string& directory) { directory_ = directory; }
+    void setCacheEnabled(bool enabled) { cacheEnabled_ = enabled; }
+
+    // Triângulos em espaço do mundo (3 vértices por triângulo) de todos os objetos estáticos
+    void setOccluders(const std::vector<glm::vec3>& positions);
+
+    // vertices no layout do VBO (posição, normal, uv) em espaço do objeto; uma oclusão por vértice
+    std::vector<float> bake(const std::vector<float>& vertices, const glm::mat4& model);
+
+    int getCacheHits() const { return cacheHits_; }
+    int getBakedMeshes() const { return bakedMeshes_; }
+    unsigned long long getRayCount() const { return rays_; }
+    double getBakeMs() const { return bakeMs_; }
+
+private:
+    std::string pathFor(uint64_t key) const;
+    bool loadCache(uint64_t key, size_t count, std::vector<float>& occlusion) const;
+    void storeCache(uint64_t key, const std::vector<float>& occlusion) const;
+
+    Bvh bvh_;
+    uint64_t occluderHash_;
+    int samples_;
+    float maxDistance_;
+    JobSystem* jobs_;
+    std::string directory_;
+    bool cacheEnabled_;
+
+    int cacheHits_;
+    int bakedMeshes_;
+    unsigned long long rays_;
+    double bakeMs_;
+};
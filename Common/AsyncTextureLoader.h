@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+#include "JobSystem.h"
+#include "TextureCache.h"
+
+// Carregamento de texturas fora do thread de render.
+// request() devolve na hora uma textura 1x1 branca (neutra na multiplicação do object.fs) e agenda a
+// imagem: threads próprias abrem o container do TextureCache (mapeado do disco ou decodificado e
+// cozido) e copiam a imagem em faixas de linhas para um anel de staging — um GL_PIXEL_UNPACK_BUFFER
+// mapeado de forma persistente (GL 4.4 / ARB_buffer_storage). update(), no thread GL, só emite os
+// glTexSubImage2D a partir do PBO (a cópia para a textura corre assíncrona no driver), cria uma fence
+// por faixa e devolve ao anel as faixas cujas fences já passaram, sem nunca esperar por elas.
+// Containers em BC1/BC3 vão por glCompressedTexSubImage2D, com faixas em múltiplos de 4 linhas.
+// Os níveis chegam do menor para o maior e GL_TEXTURE_BASE_LEVEL acompanha o último nível completo:
+// uma textura grande aparece borrada e fica nítida ao longo de alguns frames, sem estourar o orçamento.
+// Sem buffer storage as faixas vão por um PBO órfão de streaming, copiadas no thread GL.
+// Com streaming ligado, request() carrega só os níveis até a prévia (lado <= getPreviewSize()) e os mais
+// finos vêm sob demanda: a cada frame requestScreenSize() diz quantos pixels a textura ocupa na tela, e
+// update() pede às threads os níveis que faltam para esse tamanho (os mais próximos primeiro). Acima do
+// orçamento de memória, os níveis além do que cada textura precisa são devolvidos, começando pelas
+// texturas usadas há mais tempo; a prévia fica sempre.
+// A cadeia alocada é sempre definida inteira de uma vez (definir um nível abaixo do BASE_LEVEL depois
+// perde os dados de níveis NPOT no Mesa): quando um nível mais fino chega, ou quando um despejo devolve
+// memória, todos os níveis são redefinidos e os que já estavam completos são reenviados do container.
+class AsyncTextureLoader
+{
+public:
+    AsyncTextureLoader();
+    ~AsyncTextureLoader();
+
+    AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+    AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+    // decoderThreads = 0 usa metade dos núcleos
+    bool initialize(size_t stagingBytes = 64u << 20, unsigned int decoderThreads = 0);
+
+    // Textura válida imediatamente; o conteúdo (todos os mips, ou só até a prévia com streaming) chega
+    // nos update() seguintes. maxLevel >= 0 corta a cadeia nesse nível (páginas de atlas: os níveis
+    // seguintes misturam imagens vizinhas), inclusive a prévia e os despejos
+    GLuint request(const std::string& path, int maxLevel = -1);
+    // Uma vez por frame no thread GL. Envia no máximo o orçamento de bytes por chamada (ao menos uma faixa)
+    void update();
+    // Espera todas as texturas pedidas, até a prévia com streaming (modo headless, ferramentas)
+    void finish();
+    // Para as threads e apaga o anel e os PBOs; com o contexto GL ainda ativo (o destrutor só repete)
+    void release();
+
+    // Também limita o tamanho das faixas
+    void setUploadBudget(size_t bytes) { uploadBudget_ = bytes > 0 ? bytes : 1; }
+    // Residência de mips sob demanda; antes do primeiro request()
+    void setStreaming(bool enabled) { streaming_ = enabled; }
+    void setPreviewSize(int texels) { previewSize_ = texels > 0 ? texels : 1; }
+    int getPreviewSize() const { return previewSize_; }
+    // Bytes de níveis alocados (todas as texturas) a partir dos quais detalhe distante é devolvido
+    void setMemoryBudget(size_t bytes) { memoryBudget_ = bytes; }
+    size_t getMemoryBudget() const { return memoryBudget_; }
+    // Lado em pixels que a imagem inteira ocupa na tela neste frame (maior pedido do frame vale);
+    // chamado antes do update(). Texturas que não são deste loader são ignoradas
+    void requestScreenSize(GLuint texture, float pixels);
+    size_t getResidentBytes() const { return residentBytes_; }
+    int getEvictions() const { return evictions_; }
+    int getStreamedLevels() const { return streamedLevels_; }
+    bool isPersistent() const { return mapped_ != nullptr; }
+    int getPending() const { return requested_ - completed_; }
+    int getCompleted() const { return completed_; }
+    // Tempo do primeiro request() até a última textura enviada
+    double getLoadMs() const { return loadMs_; }
+    // Maior custo de update() no thread de render
+    double getMaxUpdateMs() const { return maxUpdateMs_; }
+
+private:
+    struct Job {
+        GLuint texture;
+        std::string path;
+        bool opened = false;            // threads de decodificação
+        bool loaded = false;
+        CookedTexture image;
+        int preview = 0;
+        int maxLevel = -1;              // último nível da cadeia (-1: o do container)
+
+        // Thread GL; níveis contam a partir do 0 (maior)
+        int levels = 0;                 // 0 até a primeira faixa chegar
+        int allocated = 0;              // menor nível alocado na textura (levels: nenhum)
+        int resident = 0;               // menor nível completo, o BASE_LEVEL
+        int committed = 0;              // menor nível pedido às threads (e contado na memória)
+        bool pending = true;            // há faixas desta textura a caminho
+        float wantedPixels = 0.0f;
+        long long lastUse = -1;         // frame do último requestScreenSize
+        bool initial = true;            // ainda na primeira carga
+    };
+    // Níveis [finest, coarsest] de uma textura para as threads; -1 na primeira carga: a cadeia
+    // inteira até a prévia (ou até o nível 0 sem streaming)
+    struct Stream {
+        std::shared_ptr<Job> job;
+        int coarsest;
+        int finest;
+    };
+    // Linhas [y, y + rows) de um nível; level < 0 marca uma imagem que não pôde ser lida
+    struct Band {
+        std::shared_ptr<Job> job;
+        int level;
+        int y;
+        int rows;
+        size_t stagingOffset;            // NO_STAGING: copiada de job->image pelo PBO de streaming
+        bool last;                       // última faixa do Stream
+    };
+    // Áreas do anel em ordem de alocação; só a da frente pode voltar a ficar livre
+    struct Region {
+        size_t offset;
+        size_t size;
+        GLsync fence;
+    };
+
+    static const size_t NO_STAGING = (size_t)-1;
+
+    void decoderLoop();
+    bool allocate(std::unique_lock<std::mutex>& lock, size_t size, size_t& offset);
+    static size_t bandSize(const Band& band);
+    static int chainLength(const Job& job);
+    void releaseRegions();
+    void allocateChain(Job& job, int finest);
+    void upload(const Band& band);
+    size_t levelBytes(const Job& job, int finest, int coarsest) const;
+    int neededLevel(const Job& job) const;
+    void evict(Job& job, int level);
+    void schedule();
+
+    GLuint stagingBuffer_;
+    GLuint streamBuffer_;
+    unsigned char* mapped_;
+    size_t capacity_;
+    size_t head_;
+    std::deque<Region> regions_;
+
+    // Compressão das texturas cozidas na hora: sistema próprio, para o thread de render, ao esperar os
+    // seus parallelFor, não pegar blocos BC1/BC3 das threads de decodificação
+    std::unique_ptr<JobSystem> compressJobs_;
+    std::vector<std::thread> decoders_;
+    std::deque<Stream> decodeQueue_;
+    std::unordered_map<GLuint, std::shared_ptr<Job>> jobs_;
+    std::deque<Band> readyQueue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable space_;
+    bool stopping_;
+
+    std::atomic<size_t> uploadBudget_;     // lido também pelas threads (tamanho das faixas)
+    bool streaming_;
+    int previewSize_;
+    size_t memoryBudget_;
+    size_t residentBytes_;
+    int bufferResource_;    // GpuResources: anel de staging
+    int textureResource_;   // GpuResources: residentBytes_ (o orçamento daqui é o memoryBudget_)
+    long long frame_;
+    int evictions_;
+    int streamedLevels_;
+    int requested_;
+    int completed_;
+    std::chrono::steady_clock::time_point firstRequest_;
+    double loadMs_;
+    double maxUpdateMs_;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Curve.h"
+#include "JobSystem.h"
 
 class Bezier : public Curve
 {
@@ -10,8 +11,11 @@ public:
     float getSpeed() const { return speed_; }
     void setFollowTrajectory(bool f) { follow_trajectory_ = f; }
     bool getFollowTrajectory() const { return follow_trajectory_; }
+    // nullptr usa JobSystem::shared()
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
 
 private:
     float speed_;
     bool follow_trajectory_;
+    JobSystem* jobs_;
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+#include "JobSystem.h"
+
+// Compressão em blocos 4x4 para a GPU (formatos S3TC do GL_EXT_texture_compression_s3tc).
+// BC1: 8 bytes por bloco, dois endpoints RGB565 e 2 bits por texel (4:1 sobre RGB, 8:1 sobre RGBA8).
+// BC3: o bloco de cor do BC1 mais um bloco de alfa com dois endpoints de 8 bits e 3 bits por texel (4:1).
+// Os endpoints saem do eixo principal das cores do bloco (PCA), com refinamento por mínimos quadrados
+// sobre os índices escolhidos; a escolha dos índices testa os 4 pontos da paleta em 4 texels por vez
+// (SSE2). As linhas de blocos são divididas no sistema de jobs.
+class BlockCompressor
+{
+public:
+    enum Format { BC1, BC3 };
+
+    BlockCompressor();
+
+    // nullptr usa JobSystem::shared()
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+
+    static int blockBytes(Format format) { return format == BC1 ? 8 : 16; }
+    // Bytes de uma imagem width x height (blocos incompletos nas bordas contam inteiros)
+    static size_t compressedSize(Format format, int width, int height);
+
+    // rgba: width x height texels RGBA8; out: compressedSize() bytes, blocos em ordem de linha
+    void encode(Format format, const unsigned char* rgba, int width, int height, unsigned char* out) const;
+    // Inverso de encode, como a GPU amostra (para backends em CPU e para medir a qualidade)
+    static void decode(Format format, const unsigned char* blocks, int width, int height, unsigned char* rgba);
+
+    // PSNR em dB entre duas imagens RGBA8, nos canais [0, channels); infinito se forem iguais
+    static double psnr(const unsigned char* a, const unsigned char* b, size_t texels, int channels);
+
+private:
+    JobSystem* jobs_;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// BVH binária sobre triângulos, construída com SAH em bins, para traçado de raios em CPU.
+// Raios isolados (rebotes, sombra) percorrem a árvore um a um; raios primários coerentes
+// vão em pacotes de 4 (um quad 2x2 de pixels), com os testes de caixa e triângulo em SSE.
+class Bvh
+{
+public:
+    static const int MAX_LEAF_SIZE = 8;
+
+    struct Hit {
+        float t;       // na entrada é a distância máxima
+        int triangle;  // índice na ordem passada a build(), -1 se não acertou
+        float u, v;    // coordenadas baricêntricas dos vértices 1 e 2
+    };
+
+    Bvh();
+
+    // positions: 3 vértices por triângulo, já em espaço do mundo
+    void build(const std::vector<glm::vec3>& positions);
+
+    bool intersect(const glm::vec3& origin, const glm::vec3& direction, Hit& hit) const;
+    // Só responde se há algo antes de tMax (raios de sombra); para no primeiro acerto
+    bool occluded(const glm::vec3& origin, const glm::vec3& direction, float tMax) const;
+    // Pacote de 4 raios coerentes; cada hit[i].t entra como distância máxima do raio i
+    void intersect4(const glm::vec3 origin[4], const glm::vec3 direction[4], Hit hit[4]) const;
+    // 4 raios de sombra com a mesma origem (ex.: hemisfério de um vértice); bit i = raio i bloqueado
+    int occluded4(const glm::vec3& origin, const glm::vec3 direction[4], float tMax) const;
+
+    size_t getNodeCount() const { return nodes_.size(); }
+    size_t getTriangleCount() const { return triangles_.size(); }
+    int getDepth() const { return depth_; }
+
+private:
+    struct Node {
+        glm::vec3 boundsMin;
+        int first;    // folha: primeiro triângulo; interno: filho esquerdo (o direito vem logo depois)
+        glm::vec3 boundsMax;
+        int count;    // 0 nos nós internos
+    };
+
+    // Arestas pré-calculadas para o teste de Möller-Trumbore
+    struct Triangle {
+        glm::vec3 v0;
+        glm::vec3 edge1;
+        glm::vec3 edge2;
+    };
+
+    void subdivide(int node, int first, int count, int depth,
+                   const std::vector<glm::vec3>& boundsMin, const std::vector<glm::vec3>& boundsMax,
+                   const std::vector<glm::vec3>& centroids);
+
+    std::vector<Node> nodes_;
+    std::vector<Triangle> triangles_; // na ordem das folhas
+    std::vector<int> order_;          // triangles_[i] é o triângulo order_[i] de build()
+    int depth_;
+};
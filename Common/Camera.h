@@ -13,6 +13,7 @@ public:
 
     void initialize(Shader* shader, int width, int height);
     void update();
+    void apply(Shader* target) const;
     void setCameraPos(int key);
     void mouseCallback(GLFWwindow* window, double xpos, double ypos);
 
@@ -27,6 +28,10 @@ public:
     glm::vec3 getCameraPos() const;
     glm::mat4 getViewMatrix() const;
     glm::mat4 getProjectionMatrix() const;
+    float getFov() const { return fov_; }
+    float getAspect() const { return aspect_; }
+    float getNear() const { return near_; }
+    float getFar() const { return far_; }
 
 private:
     Shader* shader;
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "EnvironmentLighting.h"
+#include "FrameRing.h"
+#include "Shader.h"
+#include "Scene.h"
+
+// Forward+ clusterizado: divide o frustum da câmera em uma grade 3D (tiles de tela x fatias
+// exponenciais de profundidade), distribui as luzes pontuais nos clusters na CPU e envia as
+// listas para o shader, que percorre apenas as luzes do cluster do fragmento.
+class ClusteredLighting
+{
+public:
+    static const int MAX_LIGHTS = 256;
+    static const int CLUSTERS_X = 16;
+    static const int CLUSTERS_Y = 9;
+    static const int CLUSTERS_Z = 24;
+    static const int MAX_LIGHTS_PER_CLUSTER = 128;
+
+    // Unidades de textura e binding do UBO usados pelo object.fs
+    static const GLuint LIGHTS_UBO_BINDING = 0;
+    static const int GRID_TEXTURE_UNIT = 1;
+    static const int INDEX_TEXTURE_UNIT = 2;
+
+    ClusteredLighting();
+    ~ClusteredLighting();
+
+    void initialize(int screenWidth, int screenHeight);
+    // Buffers e texturas dos clusters; com o contexto GL ainda ativo (initialize recria)
+    void release();
+    void setLights(const std::vector<LightSourceConfig>& lights);
+    // Coeficientes SH do mapa de ambiente; o ambiente plano das luzes continua somado no termo constante
+    void setEnvironment(const EnvironmentLighting& environment);
+    // Com o anel, o bloco "Lights" vai inteiro para o segmento do frame em vez do glBufferSubData no
+    // UBO próprio (que faria o driver esperar o frame anterior); o UBO fica para quando o anel não couber
+    void setFrameRing(FrameRing* ring) { ring_ = ring; }
+    void update(const Camera& camera);
+    void bind(Shader* shader);
+
+    int getLightCount() const { return (int)lights_.size(); }
+    int getVisibleLightRefs() const { return (int)indexList_.size(); }
+    glm::vec3 getAmbient() const { return glm::vec3(block_.ambient); }
+
+private:
+    struct AABB {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Layout std140 do bloco "Lights" em object.fs
+    struct LightsBlock {
+        glm::vec4 ambient;
+        glm::uvec4 clusterDims;
+        glm::vec4 clusterDepth;
+        glm::vec4 clusterTile;
+        glm::vec4 shAmbient[EnvironmentLighting::SH_COEFFICIENTS];
+        glm::vec4 lightPosRadius[MAX_LIGHTS];
+        glm::vec4 lightDiffuse[MAX_LIGHTS];
+        glm::vec4 lightSpecular[MAX_LIGHTS];
+    };
+
+    void buildClusterBounds(const Camera& camera);
+    void binSlice(int z);
+    void uploadLights();
+
+    std::vector<LightSourceConfig> lights_;
+    glm::vec3 environment_[EnvironmentLighting::SH_COEFFICIENTS];
+    LightsBlock block_;
+
+    // Posições das luzes em espaço de câmera (SoA) para o teste vetorizado
+    std::vector<float> viewX_, viewY_, viewZ_, radius_;
+    std::vector<AABB> clusterBounds_;
+    float sliceDepth_[CLUSTERS_Z + 1];
+
+    // Listas temporárias por cluster, compactadas depois em indexList_
+    std::vector<uint16_t> clusterScratch_;
+    std::vector<uint16_t> clusterCounts_;
+    std::vector<GLuint> gridData_;
+    std::vector<uint16_t> indexList_;
+
+    int screenWidth_;
+    int screenHeight_;
+    float builtFov_, builtAspect_, builtNear_, builtFar_;
+    bool lightsDirty_;
+
+    FrameRing* ring_;
+    FrameRing::Allocation lightsRange_;
+    GLuint lightsUBO_;
+    GLuint gridBuffer_, gridTexture_;
+    GLuint indexBuffer_, indexTexture_;
+    int resource_;          // GpuResources: UBO e buffers de textura
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Componentes das entidades da cena no World (dados simples; a lógica fica nos sistemas do trab)
+
+// Pose do objeto. model é derivada: só é refeita (updateModel) quando a pose muda
+struct Transform
+{
+    glm::vec3 position;
+    float rotationAngle; // graus
+    glm::vec3 rotationAxis;
+    float scale;
+    glm::mat4 model;
+
+    void updateModel()
+    {
+        model = glm::translate(glm::mat4(1.0f), position);
+        model = glm::rotate(model, glm::radians(rotationAngle), rotationAxis);
+        model = glm::scale(model, glm::vec3(scale));
+    }
+};
+
+// Índice em meshes (geometria, texturas e material: o que os renderers desenham)
+struct Renderable
+{
+    int mesh;
+};
+
+// Curva (índice nas curvas da cena) seguida pelo objeto
+struct BezierPath
+{
+    int curve;
+    float speed;
+    bool follow;
+};
+
+// Posição na curva, em [0, 1)
+struct PathProgress
+{
+    float t;
+};
+
+// Luz pontual; a posição vem do Transform da entidade
+struct Light
+{
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float intensity;
+    float radius;
+    bool castsShadows;
+    int shadowResolution;
+};
@@ -3,7 +3,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <memory>
 #include <vector>
+#include "GpuResources.h"
 #include "Shader.h"
 
 using namespace std;
@@ -19,12 +21,15 @@ public:
     int getNbCurvePoints() { return curvePoints.size(); }
     glm::vec3 getPointOnCurve(int i) { return curvePoints[i]; }
     void setupCurveGeometry(); 
+    // Desligado no backend sem GPU: só os pontos da curva são gerados
+    void setGpuUpload(bool enabled) { gpuUpload = enabled; }
 
 protected:
     vector <glm::vec3> controlPoints;
     vector <glm::vec3> curvePoints;
     glm::mat4 M;
-    GLuint VAO_Curve;
-    GLuint VBO_Curve;
+    // Dividida entre as cópias da curva; regenerar reaproveita VAO e VBO se só esta cópia a usa
+    std::shared_ptr<GpuGeometry> geometry;
     Shader* shader;
+    bool gpuUpload;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "Shader.h"
+#include "GpuTimer.h"
+#include "ClusteredLighting.h"
+
+// Modo deferred: um passe de geometria grava o G-buffer (albedo, normal + Ns, Ks, ambiente e
+// profundidade) e um passe de tela cheia acumula as luzes usando as listas de ClusteredLighting.
+// O custo de iluminação passa a depender só da resolução, não da complexidade da malha.
+class DeferredRenderer
+{
+public:
+    DeferredRenderer();
+    ~DeferredRenderer();
+
+    bool initialize(int width, int height, const std::string& shaderDir = "../shaders/");
+    // G-buffer, shaders e timers; com o contexto GL ainda ativo
+    void release();
+
+    // Os meshes devem ser desenhados com getGeometryShader() entre begin e end (a câmera já vale
+    // para todas as permutações; trocar de uma para a outra só exige Use())
+    void beginGeometryPass(const Camera& camera);
+    void endGeometryPass();
+    void lightingPass(const Camera& camera, ClusteredLighting& lights);
+
+    // Permutação do gbuffer.fs para o mesh, como no forward: sem TEXTURED para meshes sem textura e
+    // TEXTURE_ARRAY para os com camada num array (TextureArrays). Compilada no primeiro pedido
+    Shader* getGeometryShader(bool textured, bool textureArray = false);
+    Shader* getLightingShader() const { return lightingShader_.get(); }
+    double getGeometryMs() const { return geometryTimer_.getMilliseconds(); }
+    double getLightingMs() const { return lightingTimer_.getMilliseconds(); }
+
+private:
+    enum { ALBEDO, NORMAL, SPECULAR, AMBIENT, TARGET_COUNT };
+    enum { GEOMETRY_UNTEXTURED, GEOMETRY_TEXTURED, GEOMETRY_ARRAY, GEOMETRY_COUNT };
+
+    void releaseTargets();
+
+    int width_;
+    int height_;
+    GLuint fbo_;
+    GLuint targets_[TARGET_COUNT];
+    GLuint depthTexture_;
+    GLuint emptyVAO_;
+    GLuint outputFBO_;
+    bool samplersBound_;
+    int resource_;          // GpuResources: G-buffer e profundidade
+
+    std::string shaderDir_;
+    std::unique_ptr<Shader> geometryShaders_[GEOMETRY_COUNT];
+    std::unique_ptr<Shader> lightingShader_;
+    GpuTimer geometryTimer_;
+    GpuTimer lightingTimer_;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+
+// Luz ambiente vinda de um mapa de ambiente, em harmônicos esféricos de ordem 2 (9 coeficientes RGB).
+// A projeção roda uma vez em CPU (redução paralela por faixas de linhas, 4 texels por vez em SSE) e
+// os coeficientes já saem convoluídos com o cosseno e multiplicados pelas constantes da base e por 1/π,
+// então o shader só avalia os polinômios:
+//   ambiente(n) = c0 + c1*y + c2*z + c3*x + c4*x*y + c5*y*z + c6*(3z^2 - 1) + c7*x*z + c8*(x^2 - y^2)
+// Sem mapa carregado todos os coeficientes são zero; o ambiente plano das luzes é somado em c0 por quem usa.
+class EnvironmentLighting
+{
+public:
+    static const int SH_COEFFICIENTS = 9;
+
+    EnvironmentLighting();
+
+    // Imagem equirretangular (PNG/JPG em sRGB ou .hdr linear), linha de cima = +Y, centro = -Z
+    bool loadEquirectangular(const std::string& path, float intensity = 1.0f);
+    // rgb linear, width x height texels, linha 0 em cima
+    void project(const float* rgb, int width, int height, float intensity = 1.0f);
+    void clear();
+
+    // nullptr usa JobSystem::shared()
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+
+    bool isLoaded() const { return loaded_; }
+    const glm::vec3* getCoefficients() const { return coefficients_; }
+    // Mesmo polinômio do object.fs, para os backends em CPU
+    glm::vec3 evaluate(const glm::vec3& normal) const;
+    double getProjectMs() const { return projectMs_; }
+
+private:
+    glm::vec3 coefficients_[SH_COEFFICIENTS];
+    bool loaded_;
+    JobSystem* jobs_;
+    double projectMs_;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+
+// Captura de frames sem travar o pipeline: glReadPixels vai para um anel de PBOs com fence e
+// o buffer só é mapeado alguns frames depois, quando a GPU já terminou. A codificação (PNG ou
+// PPM, pela extensão do arquivo) roda em threads próprias.
+class FrameCapture
+{
+public:
+    FrameCapture();
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // encoderThreads = 0 usa metade dos núcleos; ringSize = 0 dispensa a OpenGL (só write())
+    bool initialize(int width, int height, int ringSize = 3, unsigned int encoderThreads = 0);
+
+    // framebuffer 0 lê o back buffer da janela (chamar antes do swap)
+    void capture(GLuint framebuffer, const std::string& path);
+    // Grava uma imagem já em memória (RGBA8, linhas de baixo para cima), ex.: do SoftwareRasterizer
+    void write(const std::string& path, const unsigned char* bottomUpPixels);
+    // Entrega para os encoders as leituras que a GPU já concluiu, sem bloquear
+    void poll();
+    // Espera todas as leituras e gravações pendentes
+    void flush();
+    // Para os encoders e apaga os PBOs (sem esperar o pendente: flush antes); com o contexto GL ainda ativo
+    void release();
+
+    // Custo médio de capture() no thread de render
+    double getCaptureMs() const { return captureMs_; }
+    int getWrittenFrames() const { return written_.load(); }
+
+private:
+    struct Slot {
+        GLuint pbo;
+        GLsync fence;
+        std::string path;
+    };
+    struct EncodeJob {
+        std::string path;
+        std::vector<unsigned char> pixels;
+    };
+
+    void readback(Slot& slot);
+    EncodeJob makeJob(const std::string& path, const unsigned char* bottomUpPixels) const;
+    void submit(EncodeJob&& job);
+    void encoderLoop();
+    bool writeImage(const EncodeJob& job) const;
+
+    int width_;
+    int height_;
+    std::vector<Slot> slots_;
+    int head_;
+    int resource_;          // GpuResources: os PBOs
+
+    std::vector<std::thread> encoders_;
+    std::deque<EncodeJob> queue_;
+    size_t maxQueued_;
+    int busyEncoders_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    bool stopping_;
+
+    std::atomic<int> written_;
+    double captureMs_;
+    int captureSamples_;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+
+// Anel para os dados que mudam todo frame (blocos por objeto, luzes): um buffer dividido em FRAMES
+// segmentos, mapeado uma vez só (GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT) quando há
+// ARB_buffer_storage. Cada frame escreve no seu segmento e termina com um fence; ao voltar ao mesmo
+// segmento, FRAMES frames depois, beginFrame espera esse fence (na prática já sinalizado), então a
+// CPU nunca escreve no que a GPU ainda lê e não há sincronização implícita do driver.
+// Sem a extensão (GL 3.3) as escritas vão para uma cópia em CPU e flush() órfã o buffer (glBufferData
+// com nullptr) no primeiro envio do frame. Em regime nada é alocado por frame: se um frame não coube,
+// o anel dobra de tamanho no beginFrame seguinte. Só no thread GL
+class FrameRing
+{
+public:
+    static const int FRAMES = 3;
+
+    // data é nulo se não coube no segmento do frame
+    struct Allocation {
+        void* data = nullptr;
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;
+    };
+
+    FrameRing();
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    bool initialize(size_t frameBytes);
+    void release();
+
+    void beginFrame();
+    // alignment 0: GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT (para glBindBufferRange em GL_UNIFORM_BUFFER)
+    Allocation allocate(size_t bytes, size_t alignment = 0);
+    // Envia o que foi escrito desde o último flush (sem efeito com o mapeamento persistente); antes dos draws
+    void flush();
+    void endFrame();
+
+    void bindRange(GLenum target, GLuint index, const Allocation& allocation) const
+    {
+        glBindBufferRange(target, index, buffer_, allocation.offset, allocation.size);
+    }
+
+    GLuint getBuffer() const { return buffer_; }
+    bool isPersistent() const { return mapped_ != nullptr; }
+    size_t getFrameBytes() const { return frameBytes_; }
+    size_t getPeakBytes() const { return peakBytes_; }
+    // Frames em que o fence do segmento ainda não tinha sinalizado, e o tempo total esperando
+    int getWaits() const { return waits_; }
+    double getWaitMs() const { return waitMs_; }
+    int getOverflows() const { return overflows_; }
+
+private:
+    bool create(size_t frameBytes);
+    void destroy();
+    void wait(int segment);
+
+    GLuint buffer_;
+    unsigned char* mapped_;
+    std::vector<unsigned char> shadow_;
+    GLsync fences_[FRAMES];
+    size_t frameBytes_;
+    size_t alignment_;
+    int segment_;
+    size_t head_;
+    size_t flushed_;
+    bool orphaned_;
+    bool overflowed_;
+    int resource_;
+
+    size_t peakBytes_;
+    int waits_;
+    double waitMs_;
+    int overflows_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <glad/glad.h>
+
+// O glad do projeto foi gerado para GL 4.0 sem extensões. O que vem depois disso (program
+// binaries, ...) é carregado aqui, depois de gladLoadGLLoader, com o mesmo loader do glad.
+
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+
+typedef void (APIENTRYP PFNGLEXTGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLEXTPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLEXTPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLEXTMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+typedef void (APIENTRYP PFNGLEXTBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+namespace GLExtensions
+{
+    // Chamar uma vez com o contexto corrente; retorna false se o loader for nulo
+    bool initialize(GLADloadproc loader);
+    bool isInitialized();
+
+    bool isSupported(const std::string& extension);
+    bool hasVersion(int major, int minor);
+
+    // GL 4.1 / GL_ARB_get_program_binary, com pelo menos um formato disponível
+    bool hasProgramBinary();
+    // GL_KHR/ARB_parallel_shader_compile: compilação em threads do driver e GL_COMPLETION_STATUS_KHR
+    bool hasParallelShaderCompile();
+    // GL 4.4 / GL_ARB_buffer_storage: buffers imutáveis que podem ficar mapeados (GL_MAP_PERSISTENT_BIT)
+    bool hasBufferStorage();
+    // GL_EXT_texture_compression_s3tc: BC1 (DXT1) e BC3 (DXT5) em glCompressedTexImage2D
+    bool hasTextureCompressionS3TC();
+
+    extern PFNGLEXTGETPROGRAMBINARYPROC GetProgramBinary;
+    extern PFNGLEXTPROGRAMBINARYPROC ProgramBinary;
+    extern PFNGLEXTPROGRAMPARAMETERIPROC ProgramParameteri;
+    extern PFNGLEXTMAXSHADERCOMPILERTHREADSPROC MaxShaderCompilerThreads;
+    extern PFNGLEXTBUFFERSTORAGEPROC BufferStorage;
+}
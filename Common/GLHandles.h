@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <glad/glad.h>
+
+// Dono de um nome GL: só move, apaga no destrutor (ou em reset). get() devolve o nome sem passar a posse
+template <typename Traits>
+class GLHandle
+{
+public:
+    GLHandle() : id_(0) {}
+    explicit GLHandle(GLuint id) : id_(id) {}
+    ~GLHandle() { reset(); }
+
+    GLHandle(GLHandle&& other) noexcept : id_(other.release()) {}
+    GLHandle& operator=(GLHandle&& other) noexcept
+    {
+        if (this != &other)
+            reset(other.release());
+        return *this;
+    }
+    GLHandle(const GLHandle&) = delete;
+    GLHandle& operator=(const GLHandle&) = delete;
+
+    static GLHandle create() { return GLHandle(Traits::create()); }
+
+    GLuint get() const { return id_; }
+    explicit operator bool() const { return id_ != 0; }
+    // Devolve o nome e deixa de ser dono dele
+    GLuint release()
+    {
+        GLuint id = id_;
+        id_ = 0;
+        return id;
+    }
+    void reset(GLuint id = 0)
+    {
+        if (id_ != 0)
+            Traits::destroy(id_);
+        id_ = id;
+    }
+
+private:
+    GLuint id_;
+};
+
+struct GLVertexArrayTraits
+{
+    static GLuint create();
+    static void destroy(GLuint id);
+};
+
+struct GLTextureTraits
+{
+    static GLuint create();
+    static void destroy(GLuint id);
+};
+
+struct GLProgramTraits
+{
+    static GLuint create();
+    static void destroy(GLuint id);
+};
+
+typedef GLHandle<GLVertexArrayTraits> GLVertexArray;
+typedef GLHandle<GLTextureTraits> GLTexture;
+typedef GLHandle<GLProgramTraits> GLProgram;
+
+// Buffer com capacidade fixa, vindo do GLBufferPool e devolvido a ele no destrutor (em vez de glDeleteBuffers).
+// O conteúdo é enviado com glBufferSubData; quando não cabe, o buffer é trocado por um do bucket que serve
+class GLBuffer
+{
+public:
+    GLBuffer() : id_(0), capacity_(0) {}
+    ~GLBuffer() { reset(); }
+
+    GLBuffer(GLBuffer&& other) noexcept;
+    GLBuffer& operator=(GLBuffer&& other) noexcept;
+    GLBuffer(const GLBuffer&) = delete;
+    GLBuffer& operator=(const GLBuffer&) = delete;
+
+    // data pode ser nulo (conteúdo indefinido)
+    static GLBuffer create(size_t bytes, const void* data = nullptr);
+    // Troca o conteúdo; o nome muda se precisar de um buffer maior (quem aponta para ele, como um VAO, refaz o vínculo)
+    void upload(size_t bytes, const void* data);
+
+    GLuint get() const { return id_; }
+    size_t getCapacity() const { return capacity_; }
+    explicit operator bool() const { return id_ != 0; }
+    // Devolve ao pool
+    void reset();
+    // Apaga de vez, sem passar pelo pool (despejo: a memória precisa sair)
+    void destroy();
+
+private:
+    GLuint id_;
+    size_t capacity_;
+};
+
+// Buffers livres agrupados por capacidade. Os buckets sobem em quartos de potência de 2 (256, 320, 384,
+// 448, 512, 640...), então um buffer desperdiça no máximo 25% e objetos e curvas criados e apagados em
+// sequência reaproveitam os mesmos buffers sem glGenBuffers/glDeleteBuffers. O que passa de maxPooledBytes
+// é apagado; os livres aparecem como "buffers" no GpuResources e saem num despejo. Só no thread GL
+class GLBufferPool
+{
+public:
+    static GLBufferPool& instance();
+    static size_t bucketSize(size_t bytes);
+
+    // Buffer com exatamente capacity bytes alocados (capacity vem de bucketSize)
+    GLuint acquire(size_t capacity);
+    void recycle(GLuint id, size_t capacity);
+    // Apaga os livres (fim do contexto ou despejo)
+    void clear();
+
+    void setMaxPooledBytes(size_t bytes) { maxPooledBytes_ = bytes; }
+    size_t getPooledBytes() const { return pooledBytes_; }
+    int getHits() const { return hits_; }
+    int getMisses() const { return misses_; }
+
+private:
+    GLBufferPool();
+    void track();
+
+    std::map<size_t, std::vector<GLuint>> free_;
+    size_t pooledBytes_;
+    size_t maxPooledBytes_;
+    int hits_;
+    int misses_;
+    int resource_;
+};
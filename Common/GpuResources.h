@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "GLHandles.h"
+
+// VAO com os VBOs presos a ele, dividido entre as cópias do dono (Mesh e Curve são copiados por
+// valor): o último dono tira o registro do GpuResources, apaga o VAO e devolve os buffers ao pool
+struct GpuGeometry
+{
+    GLVertexArray vao;
+    std::vector<GLBuffer> buffers;
+    int resource = -1;
+
+    GpuGeometry() = default;
+    GpuGeometry(const GpuGeometry&) = delete;
+    GpuGeometry& operator=(const GpuGeometry&) = delete;
+    ~GpuGeometry();
+
+    // Apaga VAO e buffers sem devolvê-los ao pool (despejo); o registro continua
+    void destroy();
+};
+
+// Categorias do relatório de memória de vídeo
+enum class GpuCategory { Geometry, Texture, Lightmap, RenderTarget, Buffer, Count };
+
+// Registro da memória de vídeo de todos os buffers e texturas, por categoria, com orçamento.
+// Cada recurso informa os bytes que ocupa; os que sabem se recriar (geometria com cópia em CPU,
+// texturas do cache em disco, lightmaps) podem ser despejados. No fim de cada frame, se o total passar
+// do orçamento, os despejáveis que não foram usados no frame saem, do desenhado há mais tempo para o
+// mais recente, e use() os traz de volta no próximo draw. No despejo as texturas mantêm o nome GL (só
+// o conteúdo sai), então quem guarda o id não percebe. Só no thread GL.
+class GpuResources
+{
+public:
+    // Libera a memória do recurso; os nomes GL podem continuar existindo, vazios
+    typedef std::function<void()> Evict;
+    // Recria o conteúdo despejado; devolve os bytes ocupados
+    typedef std::function<size_t()> Reload;
+
+    static GpuResources& instance();
+    static const char* categoryName(GpuCategory category);
+
+    // Registra um recurso já criado; sem evict e reload ele fica sempre residente
+    int add(GpuCategory category, size_t bytes, Evict evict = Evict(), Reload reload = Reload());
+    void resize(int id, size_t bytes);
+    // Esquece o recurso (quem o criou apaga os objetos GL); ids negativos são ignorados
+    void remove(int id);
+    // Marca o recurso como usado neste frame, recarregando se tiver sido despejado
+    void use(int id);
+    // Uma vez por frame, depois de desenhar: aplica o orçamento
+    void endFrame();
+
+    // 0: sem orçamento (nada é despejado)
+    void setBudget(size_t bytes) { budget_ = bytes; }
+    size_t getBudget() const { return budget_; }
+    bool hasBudget() const { return budget_ > 0; }
+
+    // Bytes residentes
+    size_t getBytes(GpuCategory category) const { return bytes_[(int)category]; }
+    size_t getTotalBytes() const;
+    size_t getPeakBytes() const { return peakBytes_; }
+    int getResourceCount() const { return count_; }
+    int getEvictions() const { return evictions_; }
+    int getReloads() const { return reloads_; }
+    // Total, orçamento e bytes por categoria numa linha
+    std::string describe() const;
+
+    // Redefine todos os níveis da textura 2D com tamanho 0: o nome continua válido e sem memória
+    static void clearTexture(GLuint texture);
+
+private:
+    GpuResources();
+
+    struct Entry {
+        GpuCategory category;
+        size_t bytes;
+        Evict evict;
+        Reload reload;
+        bool active;
+        bool resident;
+        long long lastUse;
+    };
+
+    void addBytes(GpuCategory category, size_t bytes);
+
+    std::vector<Entry> entries_;
+    std::vector<int> free_;
+    size_t bytes_[(int)GpuCategory::Count];
+    size_t budget_;
+    size_t peakBytes_;
+    long long frame_;
+    int count_;
+    int evictions_;
+    int reloads_;
+};
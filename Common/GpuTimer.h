@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Mede o tempo de GPU de um passe com GL_TIME_ELAPSED. Usa um anel de queries para ler
+// resultados de frames anteriores sem bloquear a CPU esperando a GPU.
+class GpuTimer
+{
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin();
+    void end();
+    // Apaga as queries (recriadas no próximo begin); com o contexto GL ainda ativo
+    void release();
+
+    // Média móvel em milissegundos dos resultados já disponíveis
+    double getMilliseconds() const { return averageMs_; }
+
+private:
+    static const int QUERY_COUNT = 4;
+
+    void collect();
+
+    GLuint queries_[QUERY_COUNT];
+    bool pending_[QUERY_COUNT];
+    int current_;
+    bool active_;
+    double averageMs_;
+};
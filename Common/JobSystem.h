@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Sistema de jobs com roubo de trabalho: um worker por núcleo (o thread que espera também trabalha),
+// cada um com a sua deque de Chase-Lev. O dono empilha e desempilha no fundo sem trava; quem está sem
+// trabalho rouba do topo das deques dos outros. Jobs formam árvores de fork-join: cada um conta os
+// filhos ainda não terminados e só termina depois deles, então wait(raiz) espera a árvore inteira
+// (executando outros jobs enquanto isso, o que torna parallelFor reentrante).
+// Threads de fora ganham uma deque na primeira vez que publicam um job. Quem espera pode executar
+// qualquer job do sistema: trabalho que não pode cair no thread de render (a compressão do
+// AsyncTextureLoader) usa um JobSystem próprio. Os jobs vêm de um anel por thread, sem alocação:
+// no máximo JOBS_PER_THREAD pendentes por thread
+class JobSystem
+{
+public:
+    typedef void (*Function)(const void* data, int begin, int end);
+
+    struct Job;
+
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // function(data, begin, end); com parent, o pai só termina depois deste job
+    Job* create(Function function, const void* data, int begin = 0, int end = 1, Job* parent = nullptr);
+    // Publica na deque do thread atual (ou executa na hora, se ela estiver cheia)
+    void run(Job* job);
+    // Executa jobs (os próprios ou roubados) até job e todos os seus filhos terminarem
+    void wait(Job* job);
+
+    // fn(i) para i em [0, count), em blocos de grain índices (0: ~4 blocos por thread); só retorna no fim
+    void parallelFor(int count, const std::function<void(int)>& fn, int grain = 0);
+
+    unsigned int getThreadCount() const { return (unsigned int)workers_.size() + 1; }
+    // Jobs executados por um thread que não era o dono da deque
+    unsigned long long getSteals() const { return steals_.load(); }
+
+    static JobSystem& shared();
+
+    static const int MAX_THREADS = 64;
+    static const int JOBS_PER_THREAD = 4096;
+
+private:
+    class WorkQueue;
+
+    int currentSlot();
+    int claimSlot();
+    Job* getJob(int slot);
+    void execute(Job* job);
+    void finish(Job* job);
+    void workerLoop();
+
+    std::unique_ptr<WorkQueue> slots_[MAX_THREADS];
+    std::atomic<int> slotCount_;
+    std::mutex slotMutex_;
+    std::unordered_map<std::thread::id, int> threadSlots_;
+    uint64_t serial_;
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<int> queued_;
+    std::atomic<int> sleeping_;
+    std::atomic<bool> stopping_;
+    std::atomic<unsigned long long> steals_;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bvh.h"
+#include "Scene.h"
+#include "JobSystem.h"
+
+// Lightmap de um mesh: luz difusa direta por texel e a segunda UV que aponta para ele
+struct Lightmap
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> texels; // RGB linear, linha 0 em v = 0 (ordem do glTexImage2D)
+    std::vector<float> uvs;    // 2 por vértice, no atributo 4 do VBO
+};
+
+// Assa a iluminação difusa direta (com sombras) de objetos estáticos em lightmaps.
+// A segunda UV sai de charts: triângulos vizinhos com normais próximas crescem juntos e são
+// projetados no plano da normal do chart, depois empacotados em prateleiras no atlas do mesh.
+// Cada texel coberto guarda posição e normal em mundo; a luz de cada um vem das luzes pontuais da
+// cena com raios de sombra (das luzes com castsShadows) contra a BVH dos oclusores estáticos, com as
+// linhas no sistema de jobs. A sombra dos objetos animados sobre o lightmap fica para o object.fs.
+// Texels vazios em volta dos charts são preenchidos (dilatação) para o filtro bilinear não puxar preto.
+// O resultado vai para o cache em disco (.hdr + .uv2), com a chave cobrindo geometria, luzes e parâmetros.
+class LightmapBaker
+{
+public:
+    static const int PADDING = 2;
+
+    LightmapBaker();
+
+    // Lado do atlas de cada mesh, em texels
+    void setResolution(int resolution) { resolution_ = resolution; }
+    // nullptr usa JobSystem::shared()
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+    void setCacheDirectory(const std::string& directory) { directory_ = directory; }
+    void setCacheEnabled(bool enabled) { cacheEnabled_ = enabled; }
+
+    // Triângulos em espaço do mundo (3 vértices por triângulo) que fazem sombra
+    void setOccluders(const std::vector<glm::vec3>& positions);
+    void setLights(const std::vector<LightSourceConfig>& lights);
+
+    // vertices no layout do VBO (posição, normal, uv) em espaço do objeto
+    bool bake(const std::vector<float>& vertices, const glm::mat4& model, Lightmap& lightmap);
+
+    int getCacheHits() const { return cacheHits_; }
+    int getBakedMeshes() const { return bakedMeshes_; }
+    int getLastChartCount() const { return lastCharts_; }
+    double getBakeMs() const { return bakeMs_; }
+
+private:
+    struct Chart {
+        std::vector<int> triangles;
+        glm::vec3 tangent, bitangent;
+        glm::vec2 boundsMin, boundsMax;
+        int x, y, width, height; // no atlas, com margem
+    };
+
+    void buildCharts(const std::vector<float>& vertices, const std::vector<glm::vec3>& faceNormals, std::vector<Chart>& charts) const;
+    bool packCharts(std::vector<Chart>& charts, float scale) const;
+    void computeLighting(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                         const std::vector<glm::vec3>& offsets, const std::vector<unsigned char>& covered,
+                         std::vector<float>& texels) const;
+
+    std::string pathFor(uint64_t key, const char* extension) const;
+    bool loadCache(uint64_t key, size_t vertexCount, Lightmap& lightmap) const;
+    void storeCache(uint64_t key, const Lightmap& lightmap) const;
+
+    Bvh bvh_;
+    std::vector<LightSourceConfig> lights_;
+    uint64_t occluderHash_;
+    uint64_t lightHash_;
+    int resolution_;
+    JobSystem* jobs_;
+    std::string directory_;
+    bool cacheEnabled_;
+
+    int cacheHits_;
+    int bakedMeshes_;
+    int lastCharts_;
+    double bakeMs_;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Alocador linear para dados temporários (listas do frame, resultados do culling, rascunho dos
+// loaders): cada alocação só avança um ponteiro no bloco atual, deallocate não faz nada e reset()
+// volta ao início em O(1), mantendo os blocos para o próximo uso. Se um bloco enche, passa para o
+// seguinte ou pede um novo ao heap (o dobro do último), então em regime nada vem do heap.
+// É um std::pmr::memory_resource: std::pmr::vector<T> v(&arena) usa o arena sem mudar o código.
+// Um arena é de um thread só (os dados podem ser lidos por outros enquanto valem)
+class LinearArena : public std::pmr::memory_resource
+{
+public:
+    static const size_t DEFAULT_BLOCK_BYTES = 64 * 1024;
+
+    // Posição do arena para rewind (escopos aninhados dentro de um frame)
+    struct Marker
+    {
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
+    explicit LinearArena(size_t blockBytes = DEFAULT_BLOCK_BYTES);
+    ~LinearArena() override;
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    // Tudo o que foi alocado deixa de valer (os containers precisam ter saído de uso antes)
+    void reset() { current_ = 0; offset_ = 0; }
+    Marker mark() const { Marker marker; marker.block = current_; marker.offset = offset_; return marker; }
+    void rewind(const Marker& marker) { current_ = marker.block; offset_ = marker.offset; }
+    // Devolve os blocos ao heap
+    void release();
+
+    // Arena de rascunho do thread atual, para usar dentro de um ArenaScope (jobs inclusive: um job
+    // executado durante a espera de outro termina antes dele, então os escopos continuam em pilha)
+    static LinearArena& forThread();
+
+    size_t getUsedBytes() const;
+    size_t getReservedBytes() const { return reserved_; }
+    // Pedidos atendidos pelo arena (cada um seria uma alocação no heap) e blocos pedidos ao heap
+    uint64_t getAllocations() const { return allocations_; }
+    uint64_t getBlockAllocations() const { return blockAllocations_; }
+
+    // Somas de todos os arenas do processo
+    static uint64_t getTotalAllocations();
+    static uint64_t getTotalBlockAllocations();
+    static uint64_t getTotalBytes();
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    void* allocateSlow(size_t bytes, size_t alignment);
+
+    std::vector<Block> blocks_;
+    size_t blockBytes_;
+    size_t current_;
+    size_t offset_;
+    size_t reserved_;
+    uint64_t allocations_;
+    uint64_t blockAllocations_;
+};
+
+// Volta o arena à posição da construção ao sair do escopo
+class ArenaScope
+{
+public:
+    explicit ArenaScope(LinearArena& arena) : arena_(arena), marker_(arena.mark()) {}
+    ~ArenaScope() { arena_.rewind(marker_); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    LinearArena& arena() { return arena_; }
+
+private:
+    LinearArena& arena_;
+    LinearArena::Marker marker_;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Arquivo mapeado em memória só para leitura (mmap / MapViewOfFile).
+// As páginas só são lidas do disco quando acessadas e não há cópia para um buffer intermediário.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_;
+    size_t size_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#endif
+};
@@ -1,39 +1,113 @@
 #pragma once
 
+#include <memory>
+#include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include "GpuResources.h"
 #include "Shader.h" 
 
+// Cópia em CPU da geometria e da textura, para backends sem GPU (SoftwareRasterizer)
+struct MeshCpuData
+{
+    std::vector<float> vertices; // posição(3), normal(3), uv(2) intercalados, como no VBO
+    std::vector<float> occlusion; // oclusão ambiente por vértice (atributo 3), vazia se não foi assada
+    std::vector<unsigned char> texture; // RGBA8, vazia se o objeto não tem textura
+    int textureWidth = 0;
+    int textureHeight = 0;
+};
+
 class Mesh
 {
 public:
-    Mesh() : VAO(0), nVertices(0), shader(nullptr), textureID(0), 
+    // Unidade do lightmap: depois do atlas de sombras (8)
+    static const int LIGHTMAP_TEXTURE_UNIT = 9;
+    // Binding do bloco "Object" (o 0 é o das luzes do ClusteredLighting)
+    static const GLuint OBJECT_UBO_BINDING = 1;
+
+    // Layout std140 do bloco "Object" em object.vs, object.fs e gbuffer.fs: transformação e material,
+    // escritos uma vez por frame no FrameRing em vez de cinco glUniform por draw
+    struct ObjectBlock {
+        glm::mat4 model;
+        glm::mat4 normalMatrix; // inversa transposta de model, para o shader não inverter por vértice
+        glm::vec4 Ka;
+        glm::vec4 Kd;
+        glm::vec4 Ks;           // a: Ns
+    };
+
+    Mesh() : nVertices(0), shader(nullptr), textureID(0), textureResource_(-1), textureLayer_(-1), textureExtent_(1.0f),
+             lightmapID_(0), lightmapResource_(-1), bakedLights_(0),
              position_(0.0f), rotation_angle_(0.0f), rotation_axis_(0.0f, 1.0f, 0.0f), scale_(1.0f),
-             Ka(0.0f), Kd(0.0f), Ks(0.0f), Ns(0.0f) {}
+             Ka(0.0f), Kd(0.0f), Ks(0.0f), Ns(0.0f),
+             model_(1.0f), boundsCenter_(0.0f), boundsRadius_(0.0f) {}
 
     ~Mesh() {}
-    void initialize(GLuint VAO, int nVertices, Shader* shader); 
+    // geometry pode ser nulo (sem GPU); as cópias do Mesh dividem a mesma geometria
+    void initialize(std::shared_ptr<GpuGeometry> geometry, int nVertices, Shader* shader); 
     void update(bool rotateX, bool rotateY, bool rotateZ); 
-    void draw(); 
+    // O bloco "Object" do mesh já precisa estar vinculado em OBJECT_UBO_BINDING (writeObjectBlock)
+    // bindTexture = false reaproveita a textura já vinculada na unidade 0 (objetos com a mesma textura em sequência)
+    void draw(bool bindTexture = true); 
+    void drawDepth(Shader* depthShader) const;
+    void writeObjectBlock(ObjectBlock& block) const;
+    // Liga o bloco "Object" do programa a OBJECT_UBO_BINDING
+    static void bindObjectBlock(Shader* shader);
 
     void setPosition(glm::vec3 pos) { position_ = pos; }
     void setRotation(float angle, glm::vec3 axis) { rotation_angle_ = angle; rotation_axis_ = axis; }
     void setScale(float s) { scale_ = s; }
-    void setTextureID(GLuint id) { textureID = id; }
+    // resource: registro da textura no GpuResources, trazida de volta no draw se tiver sido despejada
+    void setTextureID(GLuint id, int resource = -1) { textureID = id; textureResource_ = resource; }
+    void setShader(Shader* shader_in) { shader = shader_in; }
+    Shader* getShader() const { return shader; }
+    GLuint getTextureID() const { return textureID; }
+    // Camada no GL_TEXTURE_2D_ARRAY de textureID (TextureArrays); -1 para uma textura 2D comum
+    void setTextureLayer(int layer) { textureLayer_ = layer; }
+    int getTextureLayer() const { return textureLayer_; }
+    // Maior lado da caixa das UVs: 1 se o objeto cobre a imagem uma vez, menos numa página de atlas
+    void setTextureExtent(float extent) { textureExtent_ = extent; }
+    float getTextureExtent() const { return textureExtent_; }
+    // Lightmap assado (LightmapBaker) com a luz difusa das primeiras bakedLights luzes da cena
+    void setLightmap(GLuint id, int bakedLights, int resource = -1) { lightmapID_ = id; bakedLights_ = bakedLights; lightmapResource_ = resource; }
+    GLuint getLightmapID() const { return lightmapID_; }
     void setMaterialProperties(glm::vec3 ka, glm::vec3 kd, glm::vec3 ks, float ns) {
         Ka = ka; Kd = kd; Ks = ks; Ns = ns;
     }
     void setCurrentPosition(glm::vec3 pos) { position_ = pos; } 
+    // Pose calculada fora (Transform do World), no lugar de update
+    void setModelMatrix(const glm::mat4& model, float scale) { model_ = model; scale_ = scale; }
     glm::vec3 getPosition() const { return position_; } 
+    const glm::mat4& getModelMatrix() const { return model_; }
+    glm::vec3 getKa() const { return Ka; }
+    glm::vec3 getKd() const { return Kd; }
+    glm::vec3 getKs() const { return Ks; }
+    float getNs() const { return Ns; }
+
+    void setCpuData(std::shared_ptr<const MeshCpuData> data) { cpuData_ = data; }
+    const MeshCpuData* getCpuData() const { return cpuData_.get(); }
+
+    // Esfera envolvente em espaço do objeto, calculada a partir dos vértices ao carregar
+    void setBounds(glm::vec3 center, float radius) { boundsCenter_ = center; boundsRadius_ = radius; }
+    glm::vec3 getWorldBoundsCenter() const { return glm::vec3(model_ * glm::vec4(boundsCenter_, 1.0f)); }
+    float getWorldBoundsRadius() const { return boundsRadius_ * scale_; }
     
 public: 
-    GLuint VAO;
     float scale_; 
 protected: 
+    // Marca geometria e texturas como usadas no frame (recarregando as despejadas); true se algo voltou
+    bool useResources() const;
+
+    std::shared_ptr<GpuGeometry> geometry_;
     int nVertices;
     Shader* shader;
     GLuint textureID; 
+    int textureResource_;
+    int textureLayer_;
+    float textureExtent_;
+    GLuint lightmapID_;
+    int lightmapResource_;
+    int bakedLights_;
 
     glm::vec3 position_;
     float rotation_angle_;
@@ -43,4 +117,9 @@ protected:
     glm::vec3 Kd;
     glm::vec3 Ks;
     float Ns;
+
+    glm::mat4 model_;
+    glm::vec3 boundsCenter_;
+    float boundsRadius_;
+    std::shared_ptr<const MeshCpuData> cpuData_;
 };
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+
+// Framebuffer com cor RGBA8 e profundidade/stencil para renderizar sem janela visível (modo
+// headless). A profundidade usa o mesmo formato do G-buffer para que o blit do deferred funcione.
+class OffscreenTarget
+{
+public:
+    OffscreenTarget();
+    ~OffscreenTarget();
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    bool initialize(int width, int height);
+    // Com o contexto GL ainda ativo
+    void release();
+
+    // Vincula o framebuffer e ajusta a viewport para o tamanho do alvo
+    void bind() const;
+
+    // Copia a cor para a CPU (RGBA8, primeira linha é a de baixo, como na OpenGL)
+    void readPixels(std::vector<unsigned char>& pixels) const;
+
+    GLuint getFramebuffer() const { return fbo_; }
+    int getWidth() const { return width_; }
+    int getHeight() const { return height_; }
+
+private:
+    int width_;
+    int height_;
+    GLuint fbo_;
+    GLuint colorBuffer_;
+    GLuint depthBuffer_;
+    int resource_;
+};
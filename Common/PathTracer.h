@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bvh.h"
+#include "Camera.h"
+#include "Mesh.h"
+#include "Scene.h"
+#include "JobSystem.h"
+
+// Path tracer offline sobre os mesmos Mesh (com MeshCpuData), materiais MTL e luzes da cena.
+// Difuso Kd (vezes a textura) e especular Phong normalizado Ks/Ns; as luzes pontuais usam a
+// mesma atenuação por raio do object.fs e os raios que escapam recebem a soma dos termos
+// ambientes das luzes, como um céu uniforme.
+// Cada renderPass() soma uma amostra por pixel no acumulador (renderização progressiva), com a
+// imagem dividida em tiles distribuídos no sistema de jobs. Raios primários vão em pacotes 2x2
+// pela BVH; rebotes e raios de sombra vão um a um.
+class PathTracer
+{
+public:
+    static const int TILE_SIZE = 32;
+
+    PathTracer();
+
+    // Copia a geometria em espaço do mundo (usa a matriz model atual de cada mesh) e monta a BVH
+    void setScene(const std::vector<Mesh>& meshes, const std::vector<LightSourceConfig>& lights);
+    // Trocar cena, câmera ou tamanho zera o acumulador
+    void setCamera(const Camera& camera);
+    void resize(int width, int height);
+    void setMaxDepth(int depth) { maxDepth_ = depth; }
+    // nullptr usa JobSystem::shared()
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+
+    void reset();
+    void renderPass();
+
+    // Média das amostras, RGBA8 com a primeira linha embaixo (como glReadPixels)
+    void resolve(std::vector<unsigned char>& pixels) const;
+
+    int getPassCount() const { return passes_; }
+    unsigned long long getRayCount() const { return rays_.load(); }
+    double getBuildMs() const { return buildMs_; }
+    size_t getTriangleCount() const { return bvh_.getTriangleCount(); }
+    const Bvh& getBvh() const { return bvh_; }
+
+private:
+    struct Material {
+        glm::vec3 Kd, Ks;
+        float Ns;
+        int texture; // índice em textures_, -1 sem textura
+    };
+
+    // Atributos por vértice que o BVH não guarda
+    struct TriangleData {
+        glm::vec3 normal[3];
+        glm::vec2 uv[3];
+        glm::vec3 geometricNormal;
+        int material;
+    };
+
+    struct Light {
+        glm::vec3 position;
+        float radius;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+    };
+
+    struct TextureData {
+        int width;
+        int height;
+        const unsigned char* texels; // RGBA8, mantido vivo pelo MeshCpuData da cena
+    };
+
+    void renderTile(int tile, unsigned int pass);
+    glm::vec3 shade(glm::vec3 origin, glm::vec3 direction, const Bvh::Hit& primary, unsigned int& rng, unsigned long long& rays) const;
+    glm::vec3 primaryDirection(float x, float y, glm::vec3& origin) const;
+
+    Bvh bvh_;
+    std::vector<TriangleData> triangleData_;
+    std::vector<Material> materials_;
+    std::vector<TextureData> textures_;
+    std::vector<Light> lights_;
+    glm::vec3 environment_;
+
+    glm::mat4 inverseViewProjection_;
+
+    int width_;
+    int height_;
+    int tilesX_;
+    int tilesY_;
+    int maxDepth_;
+    JobSystem* jobs_;
+
+    std::vector<glm::vec3> accumulator_;
+    int passes_;
+    std::atomic<unsigned long long> rays_;
+    double buildMs_;
+};
@@ -1,14 +1,22 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <glm/glm.hpp>
 #include <nlohmann/json.hpp>
 
 #include "Camera.h"
+#include "EnvironmentLighting.h"
+#include "GLHandles.h"
 #include "Mesh.h"
 #include "Shader.h"
 #include "Bezier.h"
+#include "TextureArrays.h"
+#include "TextureAtlas.h"
+
+class AsyncTextureLoader;
 
 struct LightSourceConfig {
     glm::vec3 position;
@@ -16,6 +24,13 @@ struct LightSourceConfig {
     glm::vec3 diffuse;
     glm::vec3 specular;
     float intensity;
+    float radius;           // 0 (sem "radius" no JSON): sem atenuação, alcance ilimitado
+    bool castsShadows;
+    int shadowResolution;
+
+    // Alcance usado na atenuação e no culling; sem raio, grande o bastante para a atenuação dar 1
+    static constexpr float UNBOUNDED_RANGE = 1e18f;
+    float range() const { return radius > 0.0f ? radius : UNBOUNDED_RANGE; }
 };
 
 struct ObjectTransformConfig {
@@ -41,11 +56,20 @@ struct ObjectConfig {
     ObjectAnimationConfig animation;
 };
 
+// Um por mesh criado no setupScene, na mesma ordem: o objeto de origem em objects e a curva em
+// bezierCurves que o anima (-1 se nenhuma)
+struct LoadedObject {
+    size_t config;
+    int curve;
+};
+
 class Scene {
 public:
     Scene();
     bool loadConfig(const std::string& configFilePath);
     void setupScene(GLFWwindow* window, Shader* shader, Camera* camera, std::vector<Mesh>& meshes, std::vector<Bezier>& bezierCurves);
+    // Apaga as texturas e lightmaps criados pela cena (a geometria sai com o último Mesh); com contexto GL
+    void release();
     
     glm::vec3 cameraInitialPos;
     glm::vec3 cameraInitialFront;
@@ -57,10 +81,58 @@ public:
 
     std::vector<LightSourceConfig> lightSources;
     std::vector<ObjectConfig> objects;
+    std::vector<LoadedObject> loadedObjects;
+
+    // Mapa de ambiente opcional ("environment" no JSON), projetado em SH no setupScene
+    std::string environmentPath;
+    float environmentIntensity;
+    EnvironmentLighting environment;
+
+    // false: nenhum recurso OpenGL é criado (backend em software, máquinas sem GPU)
+    bool uploadToGpu;
+    // Guarda vértices e textura em CPU em cada Mesh (MeshCpuData)
+    bool keepCpuData;
+    // Oclusão ambiente por vértice dos objetos estáticos (animation "none"), em cache em ../cache/ao/
+    bool bakeAmbientOcclusion;
+    int ambientOcclusionSamples;
+    float ambientOcclusionDistance;
+    // Lightmaps com a luz difusa direta das luzes da cena nos objetos estáticos, em cache em ../cache/lightmaps/
+    bool bakeLightmaps;
+    int lightmapResolution;
+    // Se definido, as texturas dos objetos chegam em segundo plano (placeholder branco até o upload)
+    AsyncTextureLoader* textureLoader;
+    // Texturas dos objetos em páginas de atlas ("texture_atlas" no JSON): objetos cujas UVs ficam em
+    // [0, 1] amostram a página com as UVs remapeadas e passam a compartilhar a mesma textura
+    bool atlasTextures;
+    TextureAtlas atlas;
+    // Alternativa ao atlas ("texture_arrays" no JSON, tem precedência sobre ele): texturas redimensionadas
+    // para buckets de tamanho e agrupadas em GL_TEXTURE_2D_ARRAYs; cada Mesh guarda a sua camada
+    bool arrayTextures;
+    TextureArrays textureArrays;
+    // Residência de mips sob demanda no textureLoader ("texture_streaming" no JSON): prévia de até
+    // texturePreviewSize texels e orçamento de textureMemoryBudgetMB para os níveis finos
+    bool streamTextures;
+    int texturePreviewSize;
+    int textureMemoryBudgetMB;
+    // Orçamento do GpuResources ("gpu_memory" no JSON), 0 sem limite. Com orçamento, geometria e
+    // lightmaps guardam uma cópia em CPU para voltar depois de um despejo
+    int gpuMemoryBudgetMB;
 
 private:
     void loadMaterials(const std::string& mtlFilePath, glm::vec3& Ka, glm::vec3& Kd, glm::vec3& Ks, float& Ns);
-    GLuint loadTexture(const std::string& filePath);
-    int loadOBJ(const std::string& filePath, std::vector<GLfloat>& out_vertices, std::vector<GLfloat>& out_textures, std::vector<GLfloat>& out_normals);
+    // Os vetores do OBJ são rascunho: pmr para virem de um LinearArena
+    int loadOBJ(const std::string& filePath, std::pmr::vector<GLfloat>& out_vertices, std::pmr::vector<GLfloat>& out_textures, std::pmr::vector<GLfloat>& out_normals);
+    // Textura criada pela cena e o seu registro no GpuResources (-1 se o AsyncTextureLoader a contabiliza)
+    struct OwnedTexture {
+        GLTexture texture;
+        int resource = -1;
+    };
+
+    // maxLevel >= 0: último mip amostrado (páginas de atlas)
+    const OwnedTexture& loadTexture(const std::string& filePath, int maxLevel = -1);
+    bool loadTextureCpu(const std::string& filePath, MeshCpuData& data);
     std::string basePath;
+    // Uma textura por caminho: objetos com a mesma imagem (ou página do atlas) dividem o mesmo id
+    std::unordered_map<std::string, OwnedTexture> textures_;
+    std::vector<OwnedTexture> lightmaps_;
 };
\ No newline at end of file
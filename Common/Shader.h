@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <map>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -12,79 +13,43 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "GLHandles.h"
+
 using namespace std;
 
+// Defines de compilação de uma permutação (nome -> valor; valor vazio vira só "#define NOME")
+typedef std::map<std::string, std::string> ShaderDefines;
+
 class Shader
 {
 public:
+    // Nome do programa; o Shader é o dono (program_) e o apaga no destrutor
     GLuint ID;
-    Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
-    {
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        vShaderFile.exceptions(std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::badbit);
-        try
-        {
-            // Open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            vShaderFile.close();
-            fShaderFile.close();
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        }
-        const GLchar* vShaderCode = vertexCode.c_str();
-        const GLchar * fShaderCode = fragmentCode.c_str();
-        GLuint vertex, fragment;
-        GLint success;
-        GLchar infoLog[512];
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-        this->ID = glCreateProgram();
-        glAttachShader(this->ID, vertex);
-        glAttachShader(this->ID, fragment);
-        glLinkProgram(this->ID);
-        glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
-        if (!success)
-        {
-            glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        }
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    Shader(const GLchar* vertexPath, const GLchar* fragmentPath);
+    Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const ShaderDefines& defines);
+    // Um programa nunca usado ainda tem os estágios pendentes: são apagados aqui (com contexto GL)
+    ~Shader();
 
-    }
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // Lê o fonte de um estágio: tabela embutida em tempo de build (EMBED_SHADERS) ou disco
+    static std::string readSource(const std::string& path);
+    // Insere os defines logo depois da linha #version, mantendo a numeração de linhas do arquivo nos erros
+    static std::string injectDefines(const std::string& source, const ShaderDefines& defines);
+
+    // O construtor só dispara a compilação; erros são verificados aqui no primeiro uso (ou em finish)
     void Use()
     {
+        if (pending_) finish();
         glUseProgram(this->ID);
     }
 
+    // Não bloqueia quando há GL_KHR_parallel_shader_compile; sem a extensão sempre retorna true
+    bool isReady() const;
+    // Espera o link, reporta erros de compilação e grava o binário no cache
+    void finish();
+
     void setBool(const std::string& name, bool value) const
     {
         glUniform1i(glGetUniformLocation(this->ID, name.c_str()), (int)value);
@@ -125,4 +90,13 @@ public:
     {
         glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
     }
+
+private:
+    void build(const std::string& vertexCode, const std::string& fragmentCode);
+
+    GLProgram program_;
+    GLuint vertex_;
+    GLuint fragment_;
+    bool pending_;
+    std::string cacheKey_;
 };
\ No newline at end of file
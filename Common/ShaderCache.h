@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <glad/glad.h>
+
+// Cache em disco de programas linkados (glGetProgramBinary/glProgramBinary).
+// A chave é um hash do código-fonte dos estágios + GL_RENDERER + GL_VERSION, então trocar de
+// driver ou editar um shader gera uma entrada nova. Binários rejeitados pelo driver são apagados
+// e o programa é recompilado a partir do fonte.
+class ShaderCache
+{
+public:
+    static ShaderCache& instance();
+
+    void setDirectory(const std::string& directory) { directory_ = directory; }
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    bool isActive() const;
+
+    std::string makeKey(const std::string& vertexCode, const std::string& fragmentCode) const;
+
+    // Tenta criar o programa a partir do binário salvo; retorna 0 se não houver ou se falhar
+    GLuint load(const std::string& key);
+    void store(GLuint program, const std::string& key);
+
+    int getHits() const { return hits_; }
+    int getMisses() const { return misses_; }
+
+private:
+    ShaderCache();
+
+    std::string pathFor(const std::string& key) const;
+
+    std::string directory_;
+    bool enabled_;
+    int hits_;
+    int misses_;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Shader.h"
+
+// Guarda as permutações de shader já compiladas. Cada combinação (vs, fs, defines) é compilada
+// só na primeira vez que alguém pede por ela; as chamadas seguintes devolvem o mesmo programa.
+// get() não espera o driver: a verificação de erros fica para o primeiro Use() de cada programa.
+class ShaderLibrary
+{
+public:
+    explicit ShaderLibrary(const std::string& shaderDir = "../shaders/");
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    Shader* get(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines = ShaderDefines());
+
+    size_t getVariantCount() const { return variants_.size(); }
+    // Programas que o driver ainda está compilando (só é exato com GL_KHR_parallel_shader_compile)
+    int getPendingCount() const;
+    void finishAll();
+    // Apaga todos os programas (os Shader* devolvidos deixam de valer); com o contexto GL ainda ativo
+    void release() { variants_.clear(); }
+
+private:
+    static std::string makeKey(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines);
+
+    std::string shaderDir_;
+    std::unordered_map<std::string, std::unique_ptr<Shader>> variants_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Mesh.h"
+#include "Shader.h"
+#include "Scene.h"
+
+// Shadow maps das luzes com "shadow" habilitado em Scene::lightSources.
+// Cada luz ocupa uma região (com resolução própria) de um atlas de profundidade. Há duas camadas:
+// - atlas estático: só objetos sem animação, refeito apenas quando um deles ou uma luz se move;
+// - atlas do frame: cópia do estático + objetos animados, refeito todo frame.
+// Os shaders amostram o atlas do frame com PCF 3x3 sobre comparação em hardware.
+class ShadowMaps
+{
+public:
+    static const int MAX_SHADOWED_LIGHTS = 4;
+    static const int ATLAS_TEXTURE_UNIT = 8;
+    // Atlas estático, para os objetos com lightmap separarem a sombra dos animados
+    static const int STATIC_ATLAS_TEXTURE_UNIT = 10;
+    static const int MAX_ATLAS_SIZE = 8192;
+
+    ShadowMaps();
+    ~ShadowMaps();
+
+    bool initialize(const std::string& shaderDir = "../shaders/");
+    // Atlas, framebuffers e shader; com o contexto GL ainda ativo
+    void release();
+
+    // isStatic[i] diz se meshes[i] entra no atlas estático
+    void update(const std::vector<LightSourceConfig>& lights, const std::vector<Mesh>& meshes,
+                const std::vector<bool>& isStatic);
+    void invalidate() { staticValid_ = false; }
+    void bind(Shader* shader) const;
+
+    int getShadowedLightCount() const { return (int)shadowed_.size(); }
+    int getStaticRebuilds() const { return staticRebuilds_; }
+
+private:
+    struct ShadowedLight {
+        int lightIndex;
+        int resolution;
+        glm::ivec4 rect;        // x, y, largura, altura no atlas
+        glm::mat4 viewProjection;
+        glm::mat4 atlasMatrix;  // mundo -> (uv no atlas, profundidade)
+    };
+
+    void layoutAtlas(const std::vector<LightSourceConfig>& lights);
+    void allocateAtlas(int size);
+    void fitFrustums(const std::vector<LightSourceConfig>& lights, const std::vector<Mesh>& meshes);
+    unsigned long long staticStateHash(const std::vector<LightSourceConfig>& lights, const std::vector<Mesh>& meshes,
+                                       const std::vector<bool>& isStatic) const;
+    void renderCasters(const std::vector<Mesh>& meshes, const std::vector<bool>& isStatic, bool staticPass);
+
+    std::vector<ShadowedLight> shadowed_;
+    int atlasSize_;
+    GLuint staticAtlas_, frameAtlas_;
+    GLuint staticFBO_, frameFBO_;
+    int resource_;          // GpuResources: os dois atlas
+    std::unique_ptr<Shader> depthShader_;
+
+    unsigned long long staticHash_;
+    bool staticValid_;
+    int staticRebuilds_;
+};
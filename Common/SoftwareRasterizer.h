@@ -0,0 +1,122 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "EnvironmentLighting.h"
+#include "Mesh.h"
+#include "Scene.h"
+#include "JobSystem.h"
+
+struct ImageDifference {
+    double meanError;       // média do erro absoluto por canal (0..255)
+    int maxError;
+    double mismatchPercent; // pixels com algum canal acima da tolerância
+};
+
+// Backend de renderização só em CPU, para máquinas sem GPU. Usa os mesmos Mesh (com MeshCpuData),
+// Camera e luzes da cena e reproduz o object.fs (Phong com atenuação por raio, textura trilinear).
+// Os triângulos são distribuídos em tiles e cada tile é rasterizado por uma thread, quad 2x2 por
+// vez com funções de aresta em SSE. Sombras e curvas não são desenhadas.
+class SoftwareRasterizer
+{
+public:
+    static const int TILE_SIZE = 32;
+
+    SoftwareRasterizer();
+
+    void resize(int width, int height);
+    void setClearColor(glm::vec3 color) { clearColor_ = color; }
+    // nullptr usa JobSystem::shared()
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+    // Ambiente em SH, como o bloco Lights do object.fs; nullptr fica só com o ambiente plano das luzes
+    void setEnvironment(const EnvironmentLighting* environment) { environment_ = environment; }
+
+    void render(const Camera& camera, const std::vector<Mesh>& meshes, const std::vector<LightSourceConfig>& lights);
+
+    // RGBA8, primeira linha é a de baixo (mesma ordem do glReadPixels)
+    const std::vector<unsigned char>& getColor() const { return color_; }
+    int getWidth() const { return width_; }
+    int getHeight() const { return height_; }
+    double getLastMs() const { return lastMs_; }
+    size_t getLastTriangleCount() const { return lastTriangles_; }
+
+    static ImageDifference compare(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance);
+
+private:
+    struct MipLevel {
+        int width;
+        int height;
+        std::vector<unsigned char> texels;
+    };
+    struct Texture {
+        std::vector<MipLevel> levels;
+    };
+
+    // Triângulo já em espaço de tela, pronto para rasterizar
+    struct Triangle {
+        float edgeA[3], edgeB[3], edgeC[3]; // E(x, y) = A*x + B*y + C, positiva dentro
+        bool topLeft[3];
+        float invArea;
+        float depth[3];   // profundidade [0, 1] por vértice (linear em tela)
+        float invW[3];
+        glm::vec3 world[3];
+        glm::vec3 normal[3];
+        glm::vec2 uv[3];
+        float occlusion[3];
+        int minX, minY, maxX, maxY;
+        int mesh;
+    };
+
+    // Material e textura de um mesh, resolvidos uma vez por frame
+    struct MeshState {
+        glm::vec3 Ka, Kd, Ks;
+        float Ns;
+        const Texture* texture;
+    };
+
+    struct ShadingLight {
+        glm::vec3 position;
+        float radius;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+    };
+
+    void setupChunk(int chunk, int chunkCount, const glm::mat4& viewProjection);
+    void addTriangle(int chunk, int mesh, const glm::vec4 clip[3], const glm::vec3 world[3], const glm::vec3 normal[3], const glm::vec2 uv[3],
+                     const float occlusion[3]);
+    void rasterizeTile(int tile);
+    void rasterizeTriangle(const Triangle& tri, int tileX0, int tileY0, int tileX1, int tileY1, float* tileDepth);
+
+    const Texture* getTexture(const MeshCpuData* data);
+
+    int width_;
+    int height_;
+    int tilesX_;
+    int tilesY_;
+    glm::vec3 clearColor_;
+    JobSystem* jobs_;
+    const EnvironmentLighting* environment_;
+
+    std::vector<unsigned char> color_;
+
+    // Por frame
+    const std::vector<Mesh>* meshes_;
+    std::vector<MeshState> meshStates_;
+    std::vector<size_t> meshFirstTriangle_;
+    std::vector<ShadingLight> lights_;
+    glm::vec3 shAmbient_[EnvironmentLighting::SH_COEFFICIENTS];
+    glm::vec3 viewPos_;
+
+    // Cada chunk de triângulos tem sua lista e seus bins, para a preparação rodar em paralelo
+    // sem travas; percorrer os chunks em ordem mantém a ordem de submissão
+    std::vector<std::vector<Triangle>> chunkTriangles_;
+    std::vector<std::vector<std::vector<int>>> chunkBins_;
+
+    std::unordered_map<const MeshCpuData*, Texture> textures_;
+
+    double lastMs_;
+    size_t lastTriangles_;
+};
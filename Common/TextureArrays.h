@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+// Camada de uma imagem num dos arrays; layer = -1 se a imagem ficou de fora
+struct TextureArraySlot
+{
+    GLuint texture = 0;
+    int layer = -1;
+};
+
+// Alternativa ao atlas: as texturas da cena vão para GL_TEXTURE_2D_ARRAYs, um por tamanho e formato.
+// Cada imagem é redimensionada para o bucket mais próximo (lados quadrados em potência de 2, escolhido
+// em escala log pelo lado médio sqrt(w * h), entre o mínimo e o máximo) ao ser cozida pelo TextureCache,
+// que guarda o container redimensionado à parte. As UVs não mudam e o GL_REPEAT continua valendo, já que
+// o wrap é por camada. Meshes com imagens diferentes no mesmo array não trocam de textura: só o
+// uniform da camada (object.fs/gbuffer.fs com TEXTURE_ARRAY).
+class TextureArrays
+{
+public:
+    struct ArrayInfo {
+        GLuint texture;
+        int size;
+        GLenum internalFormat;
+        int layers;
+        int levels;
+        size_t bytes;           // cadeia inteira de todas as camadas, no formato da GPU
+    };
+
+    TextureArrays();
+    ~TextureArrays();
+
+    TextureArrays(const TextureArrays&) = delete;
+    TextureArrays& operator=(const TextureArrays&) = delete;
+
+    void setSizeRange(int minSize, int maxSize) { minSize_ = minSize; maxSize_ = maxSize; }
+    static int bucketSize(int width, int height, int minSize, int maxSize);
+    static const char* formatName(GLenum internalFormat);
+
+    // Cozinha as imagens no tamanho do bucket e, com createTextures, monta os arrays (precisa de
+    // contexto GL; sem ele só prepara os containers, como no lightbake). Caminhos repetidos contam uma vez
+    bool build(const std::vector<std::string>& paths, bool createTextures = true);
+    TextureArraySlot find(const std::string& path) const;
+
+    const std::vector<ArrayInfo>& getArrays() const { return arrays_; }
+    size_t getTotalBytes() const;
+    double getBuildMs() const { return buildMs_; }
+
+    void release();
+
+private:
+    int minSize_;
+    int maxSize_;
+    std::vector<ArrayInfo> arrays_;
+    std::unordered_map<std::string, TextureArraySlot> slots_;
+    std::vector<int> resources_;    // GpuResources, um por array criado
+    double buildMs_;
+};
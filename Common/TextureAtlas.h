@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Posição de uma imagem numa página do atlas, em texels (sem a margem)
+struct TextureAtlasEntry
+{
+    int page = -1;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Junta as texturas da cena em páginas de atlas, para objetos diferentes compartilharem a mesma
+// textura (e o mesmo glBindTexture). As imagens são empacotadas em skyline (bottom-left), maiores
+// primeiro; cada uma ocupa uma célula alinhada a uma potência de 2, com as bordas replicadas em volta.
+// Até o nível de mip log2(alinhamento) nenhum texel mistura imagens vizinhas, e o filtro bilinear
+// desses níveis só alcança a margem replicada: getMaxLod() é o último nível amostrado das páginas.
+// As páginas vão para o cache em disco como PNG (depois cozidas pelo TextureCache como qualquer
+// textura) com a disposição num binário ao lado; a chave cobre o conteúdo das imagens e os parâmetros.
+// Imagens maiores que a página, com menos de 3 canais ou sozinhas numa página ficam de fora.
+class TextureAtlas
+{
+public:
+    TextureAtlas();
+
+    // Lado máximo das páginas; as páginas gravadas são cortadas na área ocupada
+    void setPageSize(int size) { pageSize_ = size; }
+    int getPageSize() const { return pageSize_; }
+    // Texels replicados em volta de cada imagem
+    void setPadding(int texels) { padding_ = texels > 0 ? texels : 0; }
+    void setCacheDirectory(const std::string& directory) { directory_ = directory; }
+
+    // Empacota as imagens (caminhos repetidos contam uma vez); false se nenhuma entrou no atlas
+    bool build(const std::vector<std::string>& paths);
+
+    // nullptr se a imagem ficou de fora
+    const TextureAtlasEntry* find(const std::string& path) const;
+    int getPageCount() const { return (int)pages_.size(); }
+    const std::string& getPagePath(int page) const { return pages_[page].path; }
+    int getPageWidth(int page) const { return pages_[page].width; }
+    int getPageHeight(int page) const { return pages_[page].height; }
+    int getEntryCount() const { return (int)entries_.size(); }
+
+    // Lado das células (múltiplo de 4 para os blocos BC) e maior LOD sem mistura entre imagens
+    int getAlignment() const;
+    float getMaxLod() const;
+    // uv na página = uv * (x, y) + (z, w)
+    glm::vec4 getUvTransform(const TextureAtlasEntry& entry) const;
+    // vertices no layout do VBO (posição, normal, uv); as uv precisam estar em [0, 1]
+    void remapUVs(const TextureAtlasEntry& entry, std::vector<float>& vertices) const;
+    static bool uvsInUnitSquare(const std::vector<float>& vertices);
+
+    bool wasCached() const { return cached_; }
+    double getBuildMs() const { return buildMs_; }
+
+private:
+    struct Page {
+        std::string path;
+        int width;
+        int height;
+    };
+    // Célula com margem e alinhamento; (x, y) alinhados
+    struct Cell {
+        int source;
+        int width;
+        int height;
+        int x;
+        int y;
+        int page;
+    };
+    struct SkylineNode {
+        int x;
+        int y;
+        int width;
+    };
+
+    bool place(std::vector<SkylineNode>& skyline, int width, int height, int& x, int& y) const;
+    std::string pathFor(uint64_t key, const char* suffix) const;
+    bool loadCache(uint64_t key, const std::vector<std::string>& paths);
+    void storeCache(uint64_t key, const std::vector<std::string>& paths) const;
+
+    int pageSize_;
+    int padding_;
+    std::string directory_;
+    std::vector<Page> pages_;
+    std::unordered_map<std::string, TextureAtlasEntry> entries_;
+    bool cached_;
+    double buildMs_;
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "BlockCompressor.h"
+#include "MappedFile.h"
+
+// Container cozido aberto: mapeado do disco ou recém-gerado em memória.
+// Os níveis ficam contíguos (alinhados a 16 bytes) a partir de getData(), em RGBA8 ou em blocos BC1/BC3.
+class CookedTexture
+{
+public:
+    enum Format { RGBA8, BC1, BC3 };
+
+    struct Level {
+        int width;
+        int height;
+        size_t offset; // a partir de getData()
+        size_t size;
+    };
+
+    bool isValid() const { return base_ != nullptr; }
+    int getWidth() const { return levels_.empty() ? 0 : levels_[0].width; }
+    int getHeight() const { return levels_.empty() ? 0 : levels_[0].height; }
+    // Canais da imagem original (1, 3 ou 4): define o formato interno no upload
+    int getChannels() const { return channels_; }
+    Format getFormat() const { return format_; }
+    bool isCompressed() const { return format_ != RGBA8; }
+    // Linhas de texels por linha de dados (4 nos formatos em blocos) e bytes de cada uma num nível
+    int getRowGranularity() const { return isCompressed() ? 4 : 1; }
+    size_t getRowPitch(int level) const;
+    int getLevelCount() const { return (int)levels_.size(); }
+    const Level& getLevel(int level) const { return levels_[level]; }
+    const unsigned char* getData() const { return base_; }
+    size_t getDataSize() const { return levels_.empty() ? 0 : levels_.back().offset + levels_.back().size; }
+
+private:
+    friend class TextureCache;
+
+    MappedFile mapped_;
+    std::vector<unsigned char> memory_;
+    const unsigned char* base_ = nullptr;
+    int channels_ = 0;
+    Format format_ = RGBA8;
+    std::vector<Level> levels_;
+};
+
+// Resultado de um cozimento, para relatórios (lightbake)
+struct TextureCookReport
+{
+    std::string path;
+    int width;
+    int height;
+    CookedTexture::Format format;
+    size_t rgbaBytes;       // cadeia inteira em RGBA8
+    size_t cookedBytes;     // cadeia inteira no formato gravado
+    double psnr;            // do nível 0 contra a imagem original, nos canais dela (infinito sem compressão)
+    double encodeMs;        // só a compressão em blocos
+};
+
+// Cache em disco de texturas "cozidas": o PNG é decodificado uma vez e gravado com a cadeia de mips
+// inteira (filtro de caixa 2x2 em SSE2, o mesmo resultado do glGenerateMipmap), em RGBA8 ou, com
+// compressão ligada, em BC1 (imagens opacas) e BC3 (com alfa), de 4 a 8 vezes menores na VRAM.
+// Imagens de 1 canal continuam em RGBA8 (amostradas como GL_RED).
+// Nas execuções seguintes o arquivo é mapeado em memória e cada nível vai direto para o glTexImage2D,
+// sem decodificar PNG nem gerar mips no driver. O nome do arquivo vem do caminho da imagem e o
+// cabeçalho guarda um hash do conteúdo da imagem: editar a imagem invalida a entrada.
+// open() pode ser chamado de várias threads ao mesmo tempo (AsyncTextureLoader).
+class TextureCache
+{
+public:
+    static TextureCache& instance();
+
+    void setDirectory(const std::string& directory) { directory_ = directory; }
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    // Sem setCompression, BC1/BC3 só com o GLExtensions inicializado e GL_EXT_texture_compression_s3tc
+    // presente; senão os containers são (re)cozidos em RGBA8. Ferramentas sem contexto (lightbake)
+    // escolhem explicitamente
+    void setCompression(bool enabled) { compression_ = enabled; compressionSet_ = true; }
+    bool isCompressionEnabled() const;
+    // Ignora os containers existentes e cozinha de novo
+    void setRecook(bool recook) { recook_ = recook; }
+
+    // Textura com todos os mips (REPEAT, trilinear); 0 se a imagem não pôde ser lida
+    GLuint load(const std::string& path);
+    // Mesmo conteúdo numa textura já existente (recarga depois de um despejo); devolve os bytes
+    // da cadeia, 0 se a imagem não pôde ser lida
+    size_t upload(const std::string& path, GLuint texture);
+    // Só o nível 0 em RGBA8 (blocos decodificados como na GPU), para backends em CPU
+    bool loadPixels(const std::string& path, std::vector<unsigned char>& rgba, int& width, int& height);
+    // Gera o arquivo cozido se estiver ausente ou desatualizado, sem OpenGL (ferramentas offline)
+    bool cook(const std::string& path);
+    // Abre (ou cozinha) o container da imagem, sem OpenGL. Com width e height a imagem é redimensionada
+    // para esse tamanho antes dos mips, num container separado do tamanho original (TextureArrays).
+    // jobs: onde a compressão em blocos se divide (nullptr: JobSystem::shared())
+    bool open(const std::string& path, CookedTexture& texture, int width = 0, int height = 0, JobSystem* jobs = nullptr);
+    // Formato interno do container: o dos blocos, ou o dos canais da imagem original para RGBA8
+    static GLenum internalFormat(const CookedTexture& texture);
+    // Envia um nível inteiro (glTexImage2D ou glCompressedTexImage2D); data pode ser nulo ou um offset de PBO
+    static void uploadLevel(const CookedTexture& texture, int level, const void* data);
+    // Só as linhas [y, y + rows) de um nível já alocado; y múltiplo de getRowGranularity()
+    static void uploadRows(const CookedTexture& texture, int level, int y, int rows, const void* data);
+    // Um nível inteiro numa camada de um GL_TEXTURE_2D_ARRAY já alocado com o mesmo tamanho e formato
+    static void uploadLayer(const CookedTexture& texture, int level, int layer, const void* data);
+
+    // Nível seguinte da cadeia: max(1, w/2) x max(1, h/2), média arredondada de 2x2 texels RGBA8
+    static void downsample(const unsigned char* src, int width, int height, unsigned char* dst);
+    // Reamostragem RGBA8 separável com filtro triangular (alargado na redução, para não serrilhar)
+    static void resize(const unsigned char* src, int width, int height, unsigned char* dst, int dstWidth, int dstHeight);
+
+    int getHits() const { return hits_.load(); }
+    int getMisses() const { return misses_.load(); }
+    double getLoadMs() const { return loadMs_; }
+    std::vector<TextureCookReport> getCookReports() const;
+
+private:
+    TextureCache();
+
+    std::string pathFor(const std::string& sourcePath, int width, int height) const;
+    bool build(const std::vector<unsigned char>& source, uint64_t sourceHash, const std::string& path,
+               int resizeWidth, int resizeHeight, JobSystem* jobs, std::vector<unsigned char>& container);
+
+    std::string directory_;
+    bool enabled_;
+    bool compression_;
+    bool compressionSet_;
+    bool recook_;
+    mutable std::mutex reportMutex_;
+    std::vector<TextureCookReport> reports_;
+    std::atomic<int> hits_;
+    std::atomic<int> misses_;
+    double loadMs_;
+};
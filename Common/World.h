@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "JobSystem.h"
+#include "LinearArena.h"
+
+// Identificador de entidade: índice no World e geração (um índice reaproveitado não vale para a entidade antiga)
+struct Entity
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// Entidades agrupadas por arquétipo (o conjunto exato de componentes). Cada arquétipo guarda as suas
+// entidades em chunks de CHUNK_BYTES, com um array denso por componente (SoA), então each<A, B>() visita
+// só os arquétipos que têm A e B e percorre memória contígua; parallelEach distribui os chunks no
+// JobSystem. Adicionar ou remover um componente move a entidade de arquétipo; remover uma entidade
+// traz a última do arquétipo para o buraco. Componentes são dados simples (trivialmente copiáveis),
+// copiados com memcpy ao mudar de lugar. Só mudanças estruturais (create, add, remove, destroy) fora de each
+class World
+{
+public:
+    static const size_t CHUNK_BYTES = 16 * 1024;
+    static const int MAX_COMPONENTS = 32;
+    typedef uint32_t Mask;
+
+    World() = default;
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    template <typename... C>
+    Entity create(const C&... components)
+    {
+        Entity entity = createEntity(maskOf<C...>());
+        int assign[] = { 0, (*get<C>(entity) = components, 0)... };
+        (void)assign;
+        return entity;
+    }
+    void destroy(Entity entity);
+    bool isAlive(Entity entity) const;
+    // Remove todas as entidades e arquétipos
+    void clear();
+
+    // nullptr se a entidade não existe mais ou não tem o componente
+    template <typename C>
+    C* get(Entity entity)
+    {
+        const Record* record = find(entity);
+        if (!record)
+            return nullptr;
+        int column = record->archetype->columns[componentId<C>()];
+        return column < 0 ? nullptr : static_cast<C*>(record->archetype->at(column, record->row));
+    }
+    template <typename C>
+    bool has(Entity entity) const
+    {
+        const Record* record = find(entity);
+        return record && (record->archetype->mask & bit<C>()) != 0;
+    }
+    // Substitui o valor se o componente já existir
+    template <typename C>
+    void add(Entity entity, const C& component)
+    {
+        const Record* record = find(entity);
+        if (!record)
+            return;
+        if ((record->archetype->mask & bit<C>()) == 0)
+            move(entity, record->archetype->mask | bit<C>());
+        *get<C>(entity) = component;
+    }
+    template <typename C>
+    void remove(Entity entity)
+    {
+        const Record* record = find(entity);
+        if (record && (record->archetype->mask & bit<C>()) != 0)
+            move(entity, record->archetype->mask & ~bit<C>());
+    }
+
+    // fn(Entity, C&...) para cada entidade com todos os componentes C
+    template <typename... C, typename F>
+    void each(F fn)
+    {
+        Mask mask = maskOf<C...>();
+        for (auto& archetype : archetypes_)
+        {
+            if ((archetype->mask & mask) != mask)
+                continue;
+            for (size_t chunk = 0; chunk < archetype->chunks.size(); ++chunk)
+                eachInChunk<C...>(*archetype, chunk, fn);
+        }
+    }
+    // Como each, um job por chunk: fn não pode mudar a estrutura do World nem tocar outras entidades dos mesmos componentes.
+    // A lista de chunks sai do arena do thread
+    template <typename... C, typename F>
+    void parallelEach(JobSystem& jobs, F fn)
+    {
+        Mask mask = maskOf<C...>();
+        ArenaScope scope(LinearArena::forThread());
+        std::pmr::vector<std::pair<Archetype*, size_t>> chunks(&scope.arena());
+        for (auto& archetype : archetypes_)
+        {
+            if ((archetype->mask & mask) != mask)
+                continue;
+            for (size_t chunk = 0; chunk < archetype->chunks.size(); ++chunk)
+                chunks.push_back(std::make_pair(archetype.get(), chunk));
+        }
+        jobs.parallelFor((int)chunks.size(), [&chunks, &fn](int i) {
+            eachInChunk<C...>(*chunks[i].first, chunks[i].second, fn);
+        }, 1);
+    }
+    template <typename... C>
+    size_t count() const
+    {
+        Mask mask = maskOf<C...>();
+        size_t total = 0;
+        for (const auto& archetype : archetypes_)
+        {
+            if ((archetype->mask & mask) == mask)
+                total += archetype->count;
+        }
+        return total;
+    }
+
+    size_t getEntityCount() const { return records_.size() - freeRecords_.size(); }
+    size_t getArchetypeCount() const { return archetypes_.size(); }
+    size_t getChunkCount() const;
+
+private:
+    struct Archetype
+    {
+        Mask mask = 0;
+        // Coluna de cada componente (-1 se ausente) e, por coluna, o id, o tamanho e o deslocamento no chunk
+        int columns[MAX_COMPONENTS];
+        std::vector<int> components;
+        std::vector<size_t> sizes;
+        std::vector<size_t> offsets;
+        // Entidades por chunk; o chunk começa pelos Entity das linhas, depois vêm as colunas
+        size_t capacity = 0;
+        size_t count = 0;
+        std::vector<std::unique_ptr<unsigned char[]>> chunks;
+
+        Entity* entities(size_t chunk) { return reinterpret_cast<Entity*>(chunks[chunk].get()); }
+        size_t rowsIn(size_t chunk) const { return std::min(capacity, count - chunk * capacity); }
+        void* column(size_t chunk, int column) { return chunks[chunk].get() + offsets[column]; }
+        void* at(int column, size_t row) { return chunks[row / capacity].get() + offsets[column] + (row % capacity) * sizes[column]; }
+    };
+
+    struct Record
+    {
+        Archetype* archetype = nullptr;
+        size_t row = 0;
+        uint32_t generation = 0;
+    };
+
+    template <typename C>
+    static int componentId()
+    {
+        static_assert(std::is_trivially_copyable<C>::value, "componentes do World são copiados com memcpy");
+        static const int id = registerComponent(sizeof(C));
+        return id;
+    }
+    template <typename C>
+    static Mask bit() { return Mask(1) << componentId<C>(); }
+    template <typename... C>
+    static Mask maskOf()
+    {
+        Mask mask = 0;
+        int bits[] = { 0, (mask |= bit<C>(), 0)... };
+        (void)bits;
+        return mask;
+    }
+
+    template <typename... C, typename F>
+    static void eachInChunk(Archetype& archetype, size_t chunk, F& fn)
+    {
+        eachRow(fn, archetype.rowsIn(chunk), archetype.entities(chunk),
+                static_cast<C*>(archetype.column(chunk, archetype.columns[componentId<C>()]))...);
+    }
+    template <typename F, typename... P>
+    static void eachRow(F& fn, size_t rows, const Entity* entities, P*... columns)
+    {
+        for (size_t row = 0; row < rows; ++row)
+            fn(entities[row], columns[row]...);
+    }
+
+    static int registerComponent(size_t size);
+
+    const Record* find(Entity entity) const;
+    Entity createEntity(Mask mask);
+    Archetype* archetypeFor(Mask mask);
+    size_t appendRow(Archetype& archetype, Entity entity);
+    void removeRow(Archetype& archetype, size_t row);
+    void move(Entity entity, Mask mask);
+
+    std::vector<std::unique_ptr<Archetype>> archetypes_;
+    std::vector<Record> records_;
+    std::vector<uint32_t> freeRecords_;
+};
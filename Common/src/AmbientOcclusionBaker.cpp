@@ -0,0 +1,222 @@
+#include "AmbientOcclusionBaker.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x4F414356; // "VCAO"
+    const uint32_t CACHE_VERSION = 1;
+    const int VERTICES_PER_TASK = 64;
+    const float PI = 3.14159265358979f;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+    };
+
+    void fnv1a(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    // Vértices repetidos do triangle soup (mesma posição e normal) são calculados uma vez só
+    struct VertexKey {
+        glm::vec3 position;
+        glm::vec3 normal;
+        bool operator==(const VertexKey& other) const { return std::memcmp(this, &other, sizeof(VertexKey)) == 0; }
+    };
+
+    struct VertexKeyHash {
+        size_t operator()(const VertexKey& key) const
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            fnv1a(hash, &key, sizeof(key));
+            return (size_t)hash;
+        }
+    };
+
+    float radicalInverse(unsigned int bits)
+    {
+        bits = (bits << 16u) | (bits >> 16u);
+        bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+        bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+        bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+        bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+        return bits * 2.3283064365386963e-10f;
+    }
+
+    // Base ortonormal sem ramificação (Duff et al. 2017)
+    void orthonormalBasis(const glm::vec3& n, glm::vec3& tangent, glm::vec3& bitangent)
+    {
+        float sign = std::copysign(1.0f, n.z);
+        float a = -1.0f / (sign + n.z);
+        float b = n.x * n.y * a;
+        tangent = glm::vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+        bitangent = glm::vec3(b, sign + n.y * n.y * a, -n.y);
+    }
+}
+
+AmbientOcclusionBaker::AmbientOcclusionBaker() :
+    occluderHash_(14695981039346656037ULL), samples_(64), maxDistance_(0.5f), jobs_(nullptr),
+    directory_("../cache/ao/"), cacheEnabled_(true),
+    cacheHits_(0), bakedMeshes_(0), rays_(0), bakeMs_(0.0)
+{
+}
+
+void AmbientOcclusionBaker::setSampleCount(int samples)
+{
+    samples_ = std::max(4, (samples + 3) / 4 * 4);
+}
+
+void AmbientOcclusionBaker::setOccluders(const std::vector<glm::vec3>& positions)
+{
+    occluderHash_ = 14695981039346656037ULL;
+    if (!positions.empty())
+        fnv1a(occluderHash_, positions.data(), positions.size() * sizeof(glm::vec3));
+    bvh_.build(positions);
+}
+
+std::string AmbientOcclusionBaker::pathFor(uint64_t key) const
+{
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)key);
+    return directory_ + hex + ".ao";
+}
+
+bool AmbientOcclusionBaker::loadCache(uint64_t key, size_t count, std::vector<float>& occlusion) const
+{
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file.is_open()) return false;
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.count != count)
+        return false;
+
+    occlusion.resize(count);
+    return (bool)file.read(reinterpret_cast<char*>(occlusion.data()), count * sizeof(float));
+}
+
+void AmbientOcclusionBaker::storeCache(uint64_t key, const std::vector<float>& occlusion) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+
+    std::ofstream file(pathFor(key), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "AmbientOcclusionBaker: não foi possível gravar " << pathFor(key) << std::endl;
+        return;
+    }
+
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, (uint32_t)occlusion.size() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(occlusion.data()), occlusion.size() * sizeof(float));
+}
+
+std::vector<float> AmbientOcclusionBaker::bake(const std::vector<float>& vertices, const glm::mat4& model)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t vertexCount = vertices.size() / 8;
+    std::vector<float> occlusion;
+
+    uint64_t key = occluderHash_;
+    fnv1a(key, vertices.data(), vertices.size() * sizeof(float));
+    fnv1a(key, &model[0][0], sizeof(glm::mat4));
+    fnv1a(key, &samples_, sizeof(samples_));
+    fnv1a(key, &maxDistance_, sizeof(maxDistance_));
+    if (cacheEnabled_ && loadCache(key, vertexCount, occlusion))
+    {
+        ++cacheHits_;
+        bakeMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return occlusion;
+    }
+
+    // Vértices em mundo, sem repetição
+    glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+    std::unordered_map<VertexKey, int, VertexKeyHash> uniqueIndex;
+    std::vector<VertexKey> unique;
+    std::vector<int> remap(vertexCount);
+    uniqueIndex.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* v = &vertices[i * 8];
+        VertexKey vertex;
+        vertex.position = glm::vec3(model * glm::vec4(v[0], v[1], v[2], 1.0f));
+        glm::vec3 normal = normalMatrix * glm::vec3(v[3], v[4], v[5]);
+        float length = glm::length(normal);
+        vertex.normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        auto inserted = uniqueIndex.emplace(vertex, (int)unique.size());
+        if (inserted.second) unique.push_back(vertex);
+        remap[i] = inserted.first->second;
+    }
+
+    // Hammersley com distribuição de cosseno no espaço tangente; cada vértice gira o conjunto
+    // por um ângulo próprio para trocar bandas por ruído
+    std::vector<glm::vec3> pattern(samples_);
+    for (int s = 0; s < samples_; ++s)
+    {
+        float r1 = (s + 0.5f) / samples_;
+        float r2 = radicalInverse((unsigned int)s);
+        float radius = std::sqrt(r1);
+        float phi = 2.0f * PI * r2;
+        pattern[s] = glm::vec3(radius * std::cos(phi), radius * std::sin(phi), std::sqrt(std::max(0.0f, 1.0f - r1)));
+    }
+
+    std::vector<float> uniqueOcclusion(unique.size());
+    int tasks = (int)((unique.size() + VERTICES_PER_TASK - 1) / VERTICES_PER_TASK);
+    float offset = maxDistance_ * 1e-3f;
+    JobSystem& jobs = jobs_ ? *jobs_ : JobSystem::shared();
+    jobs.parallelFor(tasks, [&](int task) {
+        size_t begin = (size_t)task * VERTICES_PER_TASK;
+        size_t end = std::min(begin + VERTICES_PER_TASK, unique.size());
+        for (size_t i = begin; i < end; ++i)
+        {
+            const VertexKey& vertex = unique[i];
+            glm::vec3 tangent, bitangent;
+            orthonormalBasis(vertex.normal, tangent, bitangent);
+            float angle = radicalInverse((unsigned int)i * 2654435761u) * 2.0f * PI;
+            float c = std::cos(angle), s = std::sin(angle);
+            glm::vec3 axisX = tangent * c + bitangent * s;
+            glm::vec3 axisY = bitangent * c - tangent * s;
+            glm::vec3 origin = vertex.position + vertex.normal * offset;
+
+            int blocked = 0;
+            for (int sample = 0; sample < samples_; sample += 4)
+            {
+                glm::vec3 directions[4];
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const glm::vec3& local = pattern[sample + lane];
+                    directions[lane] = axisX * local.x + axisY * local.y + vertex.normal * local.z;
+                }
+                int mask = bvh_.occluded4(origin, directions, maxDistance_);
+                blocked += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+            }
+            uniqueOcclusion[i] = 1.0f - (float)blocked / samples_;
+        }
+    });
+
+    occlusion.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+        occlusion[i] = uniqueOcclusion[remap[i]];
+
+    rays_ += (unsigned long long)unique.size() * samples_;
+    ++bakedMeshes_;
+    if (cacheEnabled_)
+        storeCache(key, occlusion);
+    bakeMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return occlusion;
+}
@@ -0,0 +1,510 @@
+#include "AsyncTextureLoader.h"
+#include "GLExtensions.h"
+#include "GpuResources.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // Offsets das áreas do anel: múltiplos de 256 bytes
+    const size_t STAGING_ALIGNMENT = 256;
+    const unsigned char PLACEHOLDER_TEXEL[4] = { 255, 255, 255, 255 };
+}
+
+AsyncTextureLoader::AsyncTextureLoader() :
+    stagingBuffer_(0), streamBuffer_(0), mapped_(nullptr), capacity_(0), head_(0), stopping_(false),
+    uploadBudget_(16u << 20), streaming_(false), previewSize_(64), memoryBudget_((size_t)256 << 20), residentBytes_(0),
+    bufferResource_(-1), textureResource_(-1), frame_(0), evictions_(0), streamedLevels_(0), requested_(0), completed_(0), loadMs_(0.0), maxUpdateMs_(0.0)
+{
+}
+
+// Como no FrameCapture: não espera nada pendente (o contexto pode já ter sido destruído)
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+    release();
+}
+
+void AsyncTextureLoader::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    space_.notify_all();
+    for (auto& decoder : decoders_)
+        decoder.join();
+    decoders_.clear();
+    compressJobs_.reset();
+    decodeQueue_.clear();
+    readyQueue_.clear();
+    jobs_.clear();
+    residentBytes_ = 0;
+    GpuResources::instance().remove(bufferResource_);
+    GpuResources::instance().remove(textureResource_);
+    bufferResource_ = textureResource_ = -1;
+
+    for (auto& region : regions_)
+        if (region.fence) glDeleteSync(region.fence);
+    regions_.clear();
+    if (stagingBuffer_)
+    {
+        if (mapped_)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer_);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &stagingBuffer_);
+    }
+    if (streamBuffer_)
+        glDeleteBuffers(1, &streamBuffer_);
+    stagingBuffer_ = 0;
+    streamBuffer_ = 0;
+    mapped_ = nullptr;
+    capacity_ = 0;
+    head_ = 0;
+}
+
+bool AsyncTextureLoader::initialize(size_t stagingBytes, unsigned int decoderThreads)
+{
+    release();
+    stopping_ = false;
+
+    // Anel imutável e mapeado uma vez só; coerente, então as cópias das threads não precisam de flush
+    if (GLExtensions::hasBufferStorage() && stagingBytes > 0)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &stagingBuffer_);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer_);
+        GLExtensions::BufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)stagingBytes, nullptr, flags);
+        mapped_ = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)stagingBytes, flags));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (mapped_)
+            capacity_ = stagingBytes;
+        else
+            std::cerr << "AsyncTextureLoader: mapeamento persistente indisponível, usando PBO de streaming" << std::endl;
+    }
+    glGenBuffers(1, &streamBuffer_);
+    bufferResource_ = GpuResources::instance().add(GpuCategory::Buffer, capacity_);
+    textureResource_ = GpuResources::instance().add(GpuCategory::Texture, 0);
+
+    if (decoderThreads == 0)
+    {
+        decoderThreads = std::thread::hardware_concurrency() / 2;
+        if (decoderThreads == 0) decoderThreads = 1;
+    }
+    compressJobs_.reset(new JobSystem(decoderThreads));
+    for (unsigned int i = 0; i < decoderThreads; ++i)
+        decoders_.emplace_back(&AsyncTextureLoader::decoderLoop, this);
+    return true;
+}
+
+GLuint AsyncTextureLoader::request(const std::string& path, int maxLevel)
+{
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_TEXEL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (requested_ == completed_)
+        firstRequest_ = std::chrono::steady_clock::now();
+    ++requested_;
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->texture = texID;
+    job->path = path;
+    job->maxLevel = maxLevel;
+    jobs_[texID] = job;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        decodeQueue_.push_back({ std::move(job), -1, -1 });
+    }
+    wake_.notify_one();
+    return texID;
+}
+
+void AsyncTextureLoader::requestScreenSize(GLuint texture, float pixels)
+{
+    auto it = jobs_.find(texture);
+    if (it == jobs_.end())
+        return;
+    Job& job = *it->second;
+    job.wantedPixels = job.lastUse == frame_ ? std::max(job.wantedPixels, pixels) : pixels;
+    job.lastUse = frame_;
+}
+
+bool AsyncTextureLoader::allocate(std::unique_lock<std::mutex>& lock, size_t size, size_t& offset)
+{
+    // Chamado pelas threads de decodificação com mutex_ travado; espera o update() liberar áreas
+    for (;;)
+    {
+        if (stopping_)
+            return false;
+        if (regions_.empty())
+            head_ = 0;
+        size_t tail = regions_.empty() ? capacity_ : regions_.front().offset;
+        bool fits = false;
+        if (regions_.empty() || head_ > tail)
+        {
+            // Livre: [head_, capacity_) e, dando a volta, [0, tail)
+            if (head_ + size <= capacity_)
+                fits = true;
+            else if (!regions_.empty() && size <= tail)
+            {
+                head_ = 0;
+                fits = true;
+            }
+        }
+        else if (head_ + size <= tail)
+            fits = true;
+
+        if (fits)
+        {
+            offset = head_;
+            head_ += size;
+            regions_.push_back({ offset, size, 0 });
+            return true;
+        }
+        space_.wait(lock);
+    }
+}
+
+void AsyncTextureLoader::decoderLoop()
+{
+    for (;;)
+    {
+        Stream stream;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !decodeQueue_.empty(); });
+            if (stopping_) return;
+            stream = std::move(decodeQueue_.front());
+            decodeQueue_.pop_front();
+        }
+
+        // Um Stream por vez para cada textura: o thread GL só pede o próximo depois da última faixa
+        const std::shared_ptr<Job>& job = stream.job;
+        if (!job->opened)
+        {
+            job->opened = true;
+            job->loaded = TextureCache::instance().open(job->path, job->image, 0, 0, compressJobs_.get());
+            if (!job->loaded)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                readyQueue_.push_back({ job, -1, 0, 0, NO_STAGING, true });
+                continue;
+            }
+            // Prévia: o maior nível com os dois lados dentro do tamanho de prévia
+            int preview = chainLength(*job) - 1;
+            while (streaming_ && preview > 0 && std::max(job->image.getLevel(preview - 1).width, job->image.getLevel(preview - 1).height) <= previewSize_)
+                --preview;
+            job->preview = streaming_ ? preview : 0;
+        }
+
+        // Faixas pequenas o bastante para caber no orçamento de um frame e para o anel ter várias em voo
+        const CookedTexture& image = job->image;
+        size_t budget = uploadBudget_.load(std::memory_order_relaxed);
+        size_t bandBytes = mapped_ ? std::min(budget, capacity_ / 4) : budget;
+        int granularity = image.getRowGranularity();
+        int coarsest = stream.coarsest < 0 ? chainLength(*job) - 1 : stream.coarsest;
+        int finest = stream.finest < 0 ? job->preview : stream.finest;
+        for (int level = coarsest; level >= finest; --level)
+        {
+            const CookedTexture::Level& info = image.getLevel(level);
+            size_t pitch = image.getRowPitch(level);
+            int rows = (int)std::max<size_t>(1, bandBytes / pitch) * granularity;
+            for (int y = 0; y < info.height; y += rows)
+            {
+                Band band = { job, level, y, std::min(rows, info.height - y), NO_STAGING, level == finest && y + rows >= info.height };
+                size_t bytes = bandSize(band);
+                size_t size = (bytes + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+                if (mapped_ && size <= capacity_)
+                {
+                    size_t offset;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        if (!allocate(lock, size, offset))
+                            return;
+                    }
+                    // A cópia para o PBO é feita aqui, fora do thread de render
+                    std::memcpy(mapped_ + offset, image.getData() + info.offset + (size_t)(y / granularity) * pitch, bytes);
+                    band.stagingOffset = offset;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                readyQueue_.push_back(std::move(band));
+            }
+        }
+    }
+}
+
+size_t AsyncTextureLoader::bandSize(const Band& band)
+{
+    const CookedTexture& image = band.job->image;
+    int granularity = image.getRowGranularity();
+    return (size_t)((band.rows + granularity - 1) / granularity) * image.getRowPitch(band.level);
+}
+
+int AsyncTextureLoader::chainLength(const Job& job)
+{
+    int count = job.image.getLevelCount();
+    return job.maxLevel >= 0 ? std::min(count, job.maxLevel + 1) : count;
+}
+
+void AsyncTextureLoader::releaseRegions()
+{
+    bool released = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!regions_.empty() && regions_.front().fence)
+        {
+            // Consulta sem espera; o flush garante que a fence chegue à GPU
+            GLenum status = glClientWaitSync(regions_.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            glDeleteSync(regions_.front().fence);
+            regions_.pop_front();
+            released = true;
+        }
+    }
+    if (released)
+        space_.notify_all();
+}
+
+size_t AsyncTextureLoader::levelBytes(const Job& job, int finest, int coarsest) const
+{
+    size_t bytes = 0;
+    for (int level = finest; level <= coarsest; ++level)
+        bytes += job.image.getLevel(level).size;
+    return bytes;
+}
+
+void AsyncTextureLoader::allocateChain(Job& job, int finest)
+{
+    // Níveis acima da cadeia com tamanho 0; os já completos voltam do container (com a textura vinculada
+    // e sem PBO), os que ainda vão chegar só são alocados
+    const CookedTexture& image = job.image;
+    GLenum format = TextureCache::internalFormat(image);
+    for (int i = 0; i < finest; ++i)
+    {
+        if (image.isCompressed())
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, format, 0, 0, 0, 0, nullptr);
+        else
+            glTexImage2D(GL_TEXTURE_2D, i, format, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    for (int i = finest; i < job.levels; ++i)
+        TextureCache::uploadLevel(image, i, i >= job.resident ? image.getData() + image.getLevel(i).offset : nullptr);
+    job.allocated = finest;
+}
+
+void AsyncTextureLoader::upload(const Band& band)
+{
+    Job& job = *band.job;
+    const CookedTexture& image = job.image;
+    const CookedTexture::Level& level = image.getLevel(band.level);
+    size_t bytes = bandSize(band);
+    glBindTexture(GL_TEXTURE_2D, job.texture);
+
+    // Primeira faixa da imagem (o menor nível da cadeia): sai do placeholder e passa a amostrar só os
+    // níveis completos
+    if (job.levels == 0)
+    {
+        job.levels = chainLength(job);
+        job.allocated = job.resident = job.levels;
+        job.committed = job.preview;
+        residentBytes_ += levelBytes(job, job.preview, job.levels - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, job.levels - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, job.levels - 1);
+    }
+    // Primeira faixa de um Stream que passa dos níveis alocados: a cadeia inteira até o nível mais fino
+    // pedido de uma vez, e as faixas seguintes só enviam dados
+    if (band.level < job.allocated)
+        allocateChain(job, job.committed);
+
+    // Com o PBO vinculado o último argumento é um offset dentro dele
+    size_t base = 0;
+    if (band.stagingOffset != NO_STAGING)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer_);
+        base = band.stagingOffset;
+    }
+    else
+    {
+        // PBO órfão: o driver dá um armazenamento novo se o anterior ainda estiver em uso
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamBuffer_);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_DRAW);
+        void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (destination)
+        {
+            std::memcpy(destination, image.getData() + level.offset + (size_t)(band.y / image.getRowGranularity()) * image.getRowPitch(band.level), bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+    }
+    TextureCache::uploadRows(image, band.level, band.y, band.rows, reinterpret_cast<const void*>(base));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (band.y + band.rows == level.height)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, band.level);
+        job.resident = band.level;
+        if (!job.initial)
+            ++streamedLevels_;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (band.stagingOffset != NO_STAGING)
+    {
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& region : regions_)
+            if (region.offset == band.stagingOffset && !region.fence)
+            {
+                region.fence = fence;
+                break;
+            }
+    }
+}
+
+// Nível mais fino que a textura precisa agora: o da prévia se ninguém a desenhou neste frame
+int AsyncTextureLoader::neededLevel(const Job& job) const
+{
+    if (job.lastUse != frame_ || job.wantedPixels <= 0.0f)
+        return job.preview;
+    const CookedTexture::Level& top = job.image.getLevel(0);
+    float ratio = std::max(top.width, top.height) / job.wantedPixels;
+    int level = ratio > 1.0f ? (int)std::floor(std::log2(ratio)) : 0;
+    return std::min(level, job.preview);
+}
+
+void AsyncTextureLoader::evict(Job& job, int level)
+{
+    // Cadeia nova a partir de level (tamanho 0 acima devolve a memória); os níveis que ficam são
+    // reenviados do container, no máximo um terço do que sai
+    residentBytes_ -= levelBytes(job, job.resident, level - 1);
+    job.resident = job.committed = level;
+    glBindTexture(GL_TEXTURE_2D, job.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    allocateChain(job, level);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    ++evictions_;
+}
+
+void AsyncTextureLoader::schedule()
+{
+    std::vector<Job*> candidates;
+
+    // Acima do orçamento: devolve o detalhe que passa do necessário, das texturas usadas há mais tempo primeiro
+    if (residentBytes_ > memoryBudget_)
+    {
+        for (auto& entry : jobs_)
+        {
+            Job& job = *entry.second;
+            if (job.levels > 0 && !job.pending && job.resident < neededLevel(job))
+                candidates.push_back(&job);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Job* a, const Job* b) { return a->lastUse < b->lastUse; });
+        for (Job* job : candidates)
+        {
+            if (residentBytes_ <= memoryBudget_) break;
+            evict(*job, neededLevel(*job));
+        }
+    }
+
+    // Detalhe que falta, das texturas que mais precisam de resolução para as que menos precisam; cada
+    // pedido para antes de passar do orçamento
+    candidates.clear();
+    for (auto& entry : jobs_)
+    {
+        Job& job = *entry.second;
+        if (job.levels > 0 && !job.pending && neededLevel(job) < job.resident)
+            candidates.push_back(&job);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](const Job* a, const Job* b) { return neededLevel(*a) < neededLevel(*b); });
+    bool queued = false;
+    for (Job* job : candidates)
+    {
+        int finest = neededLevel(*job);
+        while (finest < job->resident && residentBytes_ + levelBytes(*job, finest, job->resident - 1) > memoryBudget_)
+            ++finest;
+        if (finest >= job->resident)
+            continue;
+
+        residentBytes_ += levelBytes(*job, finest, job->resident - 1);
+        job->committed = finest;
+        job->pending = true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        decodeQueue_.push_back({ jobs_[job->texture], job->resident - 1, finest });
+        queued = true;
+    }
+    if (queued)
+        wake_.notify_all();
+}
+
+void AsyncTextureLoader::update()
+{
+    if (!streaming_ && requested_ == completed_)
+        return;
+    auto start = std::chrono::steady_clock::now();
+
+    releaseRegions();
+
+    size_t sent = 0;
+    for (;;)
+    {
+        Band band;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (readyQueue_.empty())
+                break;
+            const Band& next = readyQueue_.front();
+            size_t bytes = next.level < 0 ? 0 : bandSize(next);
+            if (sent > 0 && sent + bytes > uploadBudget_.load(std::memory_order_relaxed))
+                break;
+            sent += std::max<size_t>(bytes, 1);
+            band = std::move(readyQueue_.front());
+            readyQueue_.pop_front();
+        }
+
+        // Imagem ilegível fica com o placeholder; a primeira carga termina na última faixa do seu Stream
+        if (band.level >= 0)
+            upload(band);
+        if (band.last)
+        {
+            band.job->pending = false;
+            if (band.job->initial)
+            {
+                band.job->initial = false;
+                ++completed_;
+                if (completed_ == requested_)
+                    loadMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - firstRequest_).count();
+            }
+        }
+    }
+
+    if (streaming_)
+        schedule();
+    GpuResources::instance().resize(textureResource_, residentBytes_);
+    ++frame_;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    maxUpdateMs_ = std::max(maxUpdateMs_, ms);
+}
+
+void AsyncTextureLoader::finish()
+{
+    while (requested_ != completed_)
+    {
+        update();
+        if (requested_ != completed_)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
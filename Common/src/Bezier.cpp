@@ -1,6 +1,11 @@
 #include "Bezier.h"
 
-Bezier::Bezier() : speed_(0.01f), follow_trajectory_(false)
+namespace {
+    // Segmentos por job: curvas comuns (poucos segmentos) são avaliadas direto no thread chamador
+    const int SEGMENT_GRAIN = 16;
+}
+
+Bezier::Bezier() : speed_(0.01f), follow_trajectory_(false), jobs_(nullptr)
 {
     M = glm::mat4(
         -1.0f,  3.0f, -3.0f, 1.0f,
@@ -21,23 +26,31 @@ void Bezier::generateCurve(int pointsPerSegment)
     curvePoints.clear();
     float step = 1.0f / (float)pointsPerSegment;
 
-    for (int i = 0; i <= (int)controlPoints.size() - 4; i += 3)
+    // Os mesmos t (com o mesmo acúmulo em float) em todo segmento: cada um escreve na sua faixa
+    std::vector<float> ts;
+    for (float t = 0.0; t <= 1.0; t += step)
+        ts.push_back(t);
+
+    int segments = ((int)controlPoints.size() - 1) / 3;
+    curvePoints.resize(segments * ts.size());
+    JobSystem& jobs = jobs_ ? *jobs_ : JobSystem::shared();
+    jobs.parallelFor(segments, [this, &ts](int segment)
     {
+        int i = segment * 3;
         glm::vec3 P0 = controlPoints[i];
         glm::vec3 P1 = controlPoints[i + 1];
         glm::vec3 P2 = controlPoints[i + 2];
         glm::vec3 P3 = controlPoints[i + 3];
 
         glm::mat4x3 G_mat(P0, P1, P2, P3);
+        glm::vec3* out = &curvePoints[segment * ts.size()];
 
-        for (float t = 0.0; t <= 1.0; t += step)
+        for (float t : ts)
         {
             glm::vec4 T_vec(t*t*t, t*t, t, 1.0f);
             
-            glm::vec3 p = G_mat * M * T_vec; 
-
-            curvePoints.push_back(p);
+            *out++ = G_mat * M * T_vec; 
         }
-    }
+    }, SEGMENT_GRAIN);
     setupCurveGeometry();
 }
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include "BlockCompressor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BLOCK_COMPRESSOR_USE_SSE 1
+#endif
+
+namespace {
+    // Peso do endpoint 0 para cada índice do bloco de cor em modo de 4 cores
+    const float COLOR_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    uint16_t packRgb565(const float color[3])
+    {
+        int r = (int)(std::min(255.0f, std::max(0.0f, color[0])) * 31.0f / 255.0f + 0.5f);
+        int g = (int)(std::min(255.0f, std::max(0.0f, color[1])) * 63.0f / 255.0f + 0.5f);
+        int b = (int)(std::min(255.0f, std::max(0.0f, color[2])) * 31.0f / 255.0f + 0.5f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRgb565(uint16_t color, unsigned char out[4])
+    {
+        int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+        out[0] = (unsigned char)((r << 3) | (r >> 2));
+        out[1] = (unsigned char)((g << 2) | (g >> 4));
+        out[2] = (unsigned char)((b << 3) | (b >> 2));
+        out[3] = 255;
+    }
+
+    // Paleta do bloco de cor; fourColors = false é o modo de 3 cores + preto transparente do BC1
+    void colorPalette(uint16_t c0, uint16_t c1, bool fourColors, unsigned char palette[4][4])
+    {
+        unpackRgb565(c0, palette[0]);
+        unpackRgb565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            if (fourColors)
+            {
+                palette[2][c] = (unsigned char)((2 * palette[0][c] + palette[1][c]) / 3);
+                palette[3][c] = (unsigned char)((palette[0][c] + 2 * palette[1][c]) / 3);
+            }
+            else
+            {
+                palette[2][c] = (unsigned char)((palette[0][c] + palette[1][c]) / 2);
+                palette[3][c] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = fourColors ? 255 : 0;
+    }
+
+    // Índice mais próximo (RGB) de cada texel; devolve a soma dos erros quadráticos
+    uint32_t selectIndices(const unsigned char* texels, const unsigned char palette[4][4], uint32_t& indices)
+    {
+        uint32_t error = 0;
+        indices = 0;
+        int i = 0;
+#ifdef BLOCK_COMPRESSOR_USE_SSE
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+        __m128i entries[4];
+        for (int k = 0; k < 4; ++k)
+            entries[k] = _mm_set_epi16(0, palette[k][2], palette[k][1], palette[k][0], 0, palette[k][2], palette[k][1], palette[k][0]);
+        for (; i < 16; i += 4)
+        {
+            __m128i pixels = _mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(texels + i * 4)), rgbMask);
+            __m128i low = _mm_unpacklo_epi8(pixels, zero);
+            __m128i high = _mm_unpackhi_epi8(pixels, zero);
+            __m128i best = _mm_set1_epi32(std::numeric_limits<int>::max());
+            __m128i bestIndex = zero;
+            for (int k = 0; k < 4; ++k)
+            {
+                // (dr² + dg², db²) por texel com madd; as duas metades somadas dão a distância
+                __m128i dl = _mm_sub_epi16(low, entries[k]);
+                __m128i dh = _mm_sub_epi16(high, entries[k]);
+                __m128 ml = _mm_castsi128_ps(_mm_madd_epi16(dl, dl));
+                __m128 mh = _mm_castsi128_ps(_mm_madd_epi16(dh, dh));
+                __m128i distance = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(ml, mh, _MM_SHUFFLE(2, 0, 2, 0))),
+                                                 _mm_castps_si128(_mm_shuffle_ps(ml, mh, _MM_SHUFFLE(3, 1, 3, 1))));
+                __m128i closer = _mm_cmplt_epi32(distance, best);
+                best = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best));
+                bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)), _mm_andnot_si128(closer, bestIndex));
+            }
+            alignas(16) uint32_t distances[4], chosen[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(distances), best);
+            _mm_store_si128(reinterpret_cast<__m128i*>(chosen), bestIndex);
+            for (int j = 0; j < 4; ++j)
+            {
+                error += distances[j];
+                indices |= chosen[j] << (2 * (i + j));
+            }
+        }
+#endif
+        for (; i < 16; ++i)
+        {
+            const unsigned char* texel = texels + i * 4;
+            uint32_t best = std::numeric_limits<uint32_t>::max();
+            uint32_t bestIndex = 0;
+            for (uint32_t k = 0; k < 4; ++k)
+            {
+                int dr = texel[0] - palette[k][0], dg = texel[1] - palette[k][1], db = texel[2] - palette[k][2];
+                uint32_t distance = (uint32_t)(dr * dr + dg * dg + db * db);
+                if (distance < best)
+                {
+                    best = distance;
+                    bestIndex = k;
+                }
+            }
+            error += best;
+            indices |= bestIndex << (2 * i);
+        }
+        return error;
+    }
+
+    // Canais do bloco em float, um vetor por canal, para as somas andarem de 4 em 4 texels
+    struct BlockChannels {
+        alignas(16) float r[16];
+        alignas(16) float g[16];
+        alignas(16) float b[16];
+    };
+
+    void loadChannels(const unsigned char* texels, BlockChannels& channels)
+    {
+#ifdef BLOCK_COMPRESSOR_USE_SSE
+        const __m128i byteMask = _mm_set1_epi32(0xFF);
+        for (int i = 0; i < 16; i += 4)
+        {
+            __m128i pixels = _mm_load_si128(reinterpret_cast<const __m128i*>(texels + i * 4));
+            _mm_store_ps(channels.r + i, _mm_cvtepi32_ps(_mm_and_si128(pixels, byteMask)));
+            _mm_store_ps(channels.g + i, _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask)));
+            _mm_store_ps(channels.b + i, _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask)));
+        }
+#else
+        for (int i = 0; i < 16; ++i)
+        {
+            channels.r[i] = texels[i * 4];
+            channels.g[i] = texels[i * 4 + 1];
+            channels.b[i] = texels[i * 4 + 2];
+        }
+#endif
+    }
+
+    // Soma de a[i] * b[i] nos 16 texels
+    float dot16(const float* a, const float* b)
+    {
+#ifdef BLOCK_COMPRESSOR_USE_SSE
+        __m128 sum = _mm_mul_ps(_mm_load_ps(a), _mm_load_ps(b));
+        for (int i = 4; i < 16; i += 4)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        return _mm_cvtss_f32(sum);
+#else
+        float sum = 0.0f;
+        for (int i = 0; i < 16; ++i)
+            sum += a[i] * b[i];
+        return sum;
+#endif
+    }
+
+    float sum16(const float* a)
+    {
+        alignas(16) static const float ones[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+        return dot16(a, ones);
+    }
+
+    // Endpoints que minimizam o erro para índices fixos (mínimos quadrados, como no stb_dxt)
+    bool refineEndpoints(const BlockChannels& channels, uint32_t indices, uint16_t& c0, uint16_t& c1)
+    {
+        alignas(16) float a[16], b[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            a[i] = COLOR_WEIGHTS[(indices >> (2 * i)) & 3];
+            b[i] = 1.0f - a[i];
+        }
+        float aa = dot16(a, a), bb = dot16(b, b), ab = dot16(a, b);
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        const float* values[3] = { channels.r, channels.g, channels.b };
+        float e0[3], e1[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            float ax = dot16(a, values[c]), bx = dot16(b, values[c]);
+            e0[c] = (ax * bb - bx * ab) / determinant;
+            e1[c] = (bx * aa - ax * ab) / determinant;
+        }
+        c0 = packRgb565(e0);
+        c1 = packRgb565(e1);
+        return true;
+    }
+
+    void encodeColorBlock(const unsigned char* texels, unsigned char* out)
+    {
+        BlockChannels channels;
+        loadChannels(texels, channels);
+        float mean[3] = { sum16(channels.r) / 16.0f, sum16(channels.g) / 16.0f, sum16(channels.b) / 16.0f };
+        int lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < 3; ++c)
+            {
+                lo[c] = std::min(lo[c], (int)texels[i * 4 + c]);
+                hi[c] = std::max(hi[c], (int)texels[i * 4 + c]);
+            }
+
+        uint16_t c0, c1;
+        uint32_t indices = 0;
+        if (lo[0] == hi[0] && lo[1] == hi[1] && lo[2] == hi[2])
+        {
+            c0 = c1 = packRgb565(mean);
+        }
+        else
+        {
+            // Eixo principal da covariância por iteração de potência, partindo da diagonal da caixa
+            BlockChannels centered;
+            for (int i = 0; i < 16; ++i)
+            {
+                centered.r[i] = channels.r[i] - mean[0];
+                centered.g[i] = channels.g[i] - mean[1];
+                centered.b[i] = channels.b[i] - mean[2];
+            }
+            float cov[6] = { dot16(centered.r, centered.r), dot16(centered.r, centered.g), dot16(centered.r, centered.b),
+                             dot16(centered.g, centered.g), dot16(centered.g, centered.b), dot16(centered.b, centered.b) };
+            float axis[3] = { (float)(hi[0] - lo[0]), (float)(hi[1] - lo[1]), (float)(hi[2] - lo[2]) };
+            for (int iteration = 0; iteration < 4; ++iteration)
+            {
+                float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+                float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+                float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+                float length = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+                if (length < 1e-6f) break;
+                axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+            }
+
+            // Texels extremos ao longo do eixo viram os endpoints
+            alignas(16) float dots[16];
+            for (int i = 0; i < 16; ++i)
+                dots[i] = channels.r[i] * axis[0] + channels.g[i] * axis[1] + channels.b[i] * axis[2];
+            int minTexel = 0, maxTexel = 0;
+            for (int i = 1; i < 16; ++i)
+            {
+                if (dots[i] < dots[minTexel]) minTexel = i;
+                if (dots[i] > dots[maxTexel]) maxTexel = i;
+            }
+            float e0[3] = { channels.r[maxTexel], channels.g[maxTexel], channels.b[maxTexel] };
+            float e1[3] = { channels.r[minTexel], channels.g[minTexel], channels.b[minTexel] };
+            c0 = packRgb565(e0);
+            c1 = packRgb565(e1);
+
+            unsigned char palette[4][4];
+            colorPalette(c0, c1, true, palette);
+            uint32_t error = selectIndices(texels, palette, indices);
+            for (int iteration = 0; iteration < 2 && error > 0; ++iteration)
+            {
+                uint16_t r0, r1;
+                if (!refineEndpoints(channels, indices, r0, r1) || (r0 == c0 && r1 == c1))
+                    break;
+                uint32_t refinedIndices;
+                colorPalette(r0, r1, true, palette);
+                uint32_t refinedError = selectIndices(texels, palette, refinedIndices);
+                if (refinedError >= error)
+                    break;
+                c0 = r0;
+                c1 = r1;
+                indices = refinedIndices;
+                error = refinedError;
+            }
+        }
+
+        // c0 > c1 seleciona o modo de 4 cores; trocar os endpoints troca 0<->1 e 2<->3
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            indices ^= 0x55555555u;
+        }
+        else if (c0 == c1)
+            indices = 0;
+        out[0] = (unsigned char)(c0 & 0xFF);
+        out[1] = (unsigned char)(c0 >> 8);
+        out[2] = (unsigned char)(c1 & 0xFF);
+        out[3] = (unsigned char)(c1 >> 8);
+        std::memcpy(out + 4, &indices, 4);
+    }
+
+    void alphaPalette(unsigned char a0, unsigned char a1, unsigned char palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int i = 1; i < 7; ++i)
+                palette[i + 1] = (unsigned char)(((7 - i) * a0 + i * a1) / 7);
+        }
+        else
+        {
+            for (int i = 1; i < 5; ++i)
+                palette[i + 1] = (unsigned char)(((5 - i) * a0 + i * a1) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void encodeAlphaBlock(const unsigned char* texels, unsigned char* out)
+    {
+        unsigned char a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; ++i)
+        {
+            a0 = std::max(a0, texels[i * 4 + 3]);
+            a1 = std::min(a1, texels[i * 4 + 3]);
+        }
+        unsigned char palette[8];
+        alphaPalette(a0, a1, palette);
+        uint64_t indices = 0;
+        if (a0 != a1)
+        {
+            unsigned char chosen[16];
+#ifdef BLOCK_COMPRESSOR_USE_SSE
+            // Os 16 alfas num registro; |a - p| em 8 bits com subtrações saturadas
+            alignas(16) unsigned char alphas[16];
+            for (int i = 0; i < 16; ++i)
+                alphas[i] = texels[i * 4 + 3];
+            __m128i alpha = _mm_load_si128(reinterpret_cast<const __m128i*>(alphas));
+            __m128i best = _mm_set1_epi8((char)0xFF);
+            __m128i bestIndex = _mm_setzero_si128();
+            for (int k = 0; k < 8; ++k)
+            {
+                __m128i entry = _mm_set1_epi8((char)palette[k]);
+                __m128i distance = _mm_or_si128(_mm_subs_epu8(alpha, entry), _mm_subs_epu8(entry, alpha));
+                __m128i closer = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_max_epu8(distance, best), distance), _mm_set1_epi8((char)0xFF));
+                best = _mm_min_epu8(distance, best);
+                bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi8((char)k)), _mm_andnot_si128(closer, bestIndex));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(chosen), bestIndex);
+#else
+            for (int i = 0; i < 16; ++i)
+            {
+                int best = 256;
+                chosen[i] = 0;
+                for (int k = 0; k < 8; ++k)
+                {
+                    int distance = std::abs(texels[i * 4 + 3] - palette[k]);
+                    if (distance < best) { best = distance; chosen[i] = (unsigned char)k; }
+                }
+            }
+#endif
+            for (int i = 0; i < 16; ++i)
+                indices |= (uint64_t)chosen[i] << (3 * i);
+        }
+        out[0] = a0;
+        out[1] = a1;
+        for (int i = 0; i < 6; ++i)
+            out[2 + i] = (unsigned char)(indices >> (8 * i));
+    }
+
+    void decodeColorBlock(const unsigned char* block, bool alwaysFourColors, unsigned char texels[64])
+    {
+        uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8)), c1 = (uint16_t)(block[2] | (block[3] << 8));
+        unsigned char palette[4][4];
+        colorPalette(c0, c1, alwaysFourColors || c0 > c1, palette);
+        uint32_t indices;
+        std::memcpy(&indices, block + 4, 4);
+        for (int i = 0; i < 16; ++i)
+            std::memcpy(texels + i * 4, palette[(indices >> (2 * i)) & 3], 4);
+    }
+
+    void decodeAlphaBlock(const unsigned char* block, unsigned char texels[64])
+    {
+        unsigned char palette[8];
+        alphaPalette(block[0], block[1], palette);
+        uint64_t indices = 0;
+        for (int i = 0; i < 6; ++i)
+            indices |= (uint64_t)block[2 + i] << (8 * i);
+        for (int i = 0; i < 16; ++i)
+            texels[i * 4 + 3] = palette[(indices >> (3 * i)) & 7];
+    }
+}
+
+BlockCompressor::BlockCompressor() : jobs_(nullptr)
+{
+}
+
+size_t BlockCompressor::compressedSize(Format format, int width, int height)
+{
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+void BlockCompressor::encode(Format format, const unsigned char* rgba, int width, int height, unsigned char* out) const
+{
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    int bytes = blockBytes(format);
+    JobSystem& jobs = jobs_ ? *jobs_ : JobSystem::shared();
+    jobs.parallelFor(blocksY, [&](int by) {
+        alignas(16) unsigned char texels[64];
+        unsigned char* row = out + (size_t)by * blocksX * bytes;
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            // Blocos que passam da borda repetem o último texel
+            for (int y = 0; y < 4; ++y)
+            {
+                int sy = std::min(by * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x)
+                {
+                    int sx = std::min(bx * 4 + x, width - 1);
+                    std::memcpy(texels + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+                }
+            }
+            unsigned char* block = row + (size_t)bx * bytes;
+            if (format == BC3)
+            {
+                encodeAlphaBlock(texels, block);
+                block += 8;
+            }
+            encodeColorBlock(texels, block);
+        }
+    });
+}
+
+void BlockCompressor::decode(Format format, const unsigned char* blocks, int width, int height, unsigned char* rgba)
+{
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    int bytes = blockBytes(format);
+    unsigned char texels[64];
+    for (int by = 0; by < blocksY; ++by)
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            const unsigned char* block = blocks + ((size_t)by * blocksX + bx) * bytes;
+            // No BC3 o bloco de cor é sempre de 4 cores
+            decodeColorBlock(format == BC3 ? block + 8 : block, format == BC3, texels);
+            if (format == BC3)
+                decodeAlphaBlock(block, texels);
+            for (int y = 0; y < 4 && by * 4 + y < height; ++y)
+                for (int x = 0; x < 4 && bx * 4 + x < width; ++x)
+                    std::memcpy(rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+        }
+}
+
+double BlockCompressor::psnr(const unsigned char* a, const unsigned char* b, size_t texels, int channels)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < texels; ++i)
+        for (int c = 0; c < channels; ++c)
+        {
+            double difference = (double)a[i * 4 + c] - (double)b[i * 4 + c];
+            sum += difference * difference;
+        }
+    if (sum == 0.0)
+        return std::numeric_limits<double>::infinity();
+    double mse = sum / ((double)texels * channels);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
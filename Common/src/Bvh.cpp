@@ -0,0 +1,542 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BVH_USE_SSE 1
+#endif
+
+namespace {
+    const int SAH_BINS = 12;
+    const int STACK_SIZE = 64;
+    const float RAY_EPSILON = 1e-4f;
+
+    float surfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        glm::vec3 e = boundsMax - boundsMin;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    // Slab test; retorna a distância de entrada ou FLT_MAX se não acerta antes de tMax
+    inline float intersectBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                                 const glm::vec3& origin, const glm::vec3& invDirection, float tMax)
+    {
+        glm::vec3 t1 = (boundsMin - origin) * invDirection;
+        glm::vec3 t2 = (boundsMax - origin) * invDirection;
+        float tNear = std::max(std::max(std::min(t1.x, t2.x), std::min(t1.y, t2.y)), std::max(std::min(t1.z, t2.z), 0.0f));
+        float tFar = std::min(std::min(std::max(t1.x, t2.x), std::max(t1.y, t2.y)), std::min(std::max(t1.z, t2.z), tMax));
+        return tNear <= tFar ? tNear : FLT_MAX;
+    }
+
+    inline glm::vec3 safeInverse(const glm::vec3& d)
+    {
+        // Direção paralela a um eixo: infinito com sinal, o slab test continua correto
+        return glm::vec3(d.x != 0.0f ? 1.0f / d.x : 1e30f, d.y != 0.0f ? 1.0f / d.y : 1e30f, d.z != 0.0f ? 1.0f / d.z : 1e30f);
+    }
+}
+
+Bvh::Bvh() : depth_(0)
+{
+}
+
+void Bvh::build(const std::vector<glm::vec3>& positions)
+{
+    int count = (int)(positions.size() / 3);
+    nodes_.clear();
+    triangles_.clear();
+    order_.resize(count);
+    depth_ = 0;
+    if (count == 0) return;
+
+    std::vector<glm::vec3> boundsMin(count), boundsMax(count), centroids(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const glm::vec3& a = positions[i * 3 + 0];
+        const glm::vec3& b = positions[i * 3 + 1];
+        const glm::vec3& c = positions[i * 3 + 2];
+        boundsMin[i] = glm::min(glm::min(a, b), c);
+        boundsMax[i] = glm::max(glm::max(a, b), c);
+        centroids[i] = (boundsMin[i] + boundsMax[i]) * 0.5f;
+        order_[i] = i;
+    }
+
+    nodes_.reserve((size_t)count * 2);
+    nodes_.push_back(Node());
+    subdivide(0, 0, count, 1, boundsMin, boundsMax, centroids);
+
+    triangles_.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const glm::vec3* v = &positions[(size_t)order_[i] * 3];
+        triangles_[i] = { v[0], v[1] - v[0], v[2] - v[0] };
+    }
+}
+
+void Bvh::subdivide(int node, int first, int count, int depth,
+                    const std::vector<glm::vec3>& boundsMin, const std::vector<glm::vec3>& boundsMax,
+                    const std::vector<glm::vec3>& centroids)
+{
+    depth_ = std::max(depth_, depth);
+
+    glm::vec3 nodeMin(FLT_MAX), nodeMax(-FLT_MAX), centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+    for (int i = first; i < first + count; ++i)
+    {
+        int tri = order_[i];
+        nodeMin = glm::min(nodeMin, boundsMin[tri]);
+        nodeMax = glm::max(nodeMax, boundsMax[tri]);
+        centroidMin = glm::min(centroidMin, centroids[tri]);
+        centroidMax = glm::max(centroidMax, centroids[tri]);
+    }
+    nodes_[node].boundsMin = nodeMin;
+    nodes_[node].boundsMax = nodeMax;
+    nodes_[node].first = first;
+    nodes_[node].count = count;
+    if (count <= 2) return;
+
+    // SAH em bins nos três eixos: custo = área(esq) * n(esq) + área(dir) * n(dir)
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.0f) continue;
+
+        glm::vec3 binMin[SAH_BINS], binMax[SAH_BINS];
+        int binCount[SAH_BINS] = {};
+        for (int b = 0; b < SAH_BINS; ++b)
+        {
+            binMin[b] = glm::vec3(FLT_MAX);
+            binMax[b] = glm::vec3(-FLT_MAX);
+        }
+        float scale = SAH_BINS / extent;
+        for (int i = first; i < first + count; ++i)
+        {
+            int tri = order_[i];
+            int b = std::min(SAH_BINS - 1, (int)((centroids[tri][axis] - centroidMin[axis]) * scale));
+            binMin[b] = glm::min(binMin[b], boundsMin[tri]);
+            binMax[b] = glm::max(binMax[b], boundsMax[tri]);
+            ++binCount[b];
+        }
+
+        // Varredura da direita para a esquerda guarda o custo de cada lado direito
+        float rightArea[SAH_BINS];
+        int rightCount[SAH_BINS];
+        glm::vec3 accumMin(FLT_MAX), accumMax(-FLT_MAX);
+        int accumCount = 0;
+        for (int b = SAH_BINS - 1; b > 0; --b)
+        {
+            accumMin = glm::min(accumMin, binMin[b]);
+            accumMax = glm::max(accumMax, binMax[b]);
+            accumCount += binCount[b];
+            rightArea[b] = accumCount ? surfaceArea(accumMin, accumMax) : 0.0f;
+            rightCount[b] = accumCount;
+        }
+
+        accumMin = glm::vec3(FLT_MAX);
+        accumMax = glm::vec3(-FLT_MAX);
+        accumCount = 0;
+        for (int b = 0; b < SAH_BINS - 1; ++b)
+        {
+            accumMin = glm::min(accumMin, binMin[b]);
+            accumMax = glm::max(accumMax, binMax[b]);
+            accumCount += binCount[b];
+            if (accumCount == 0 || rightCount[b + 1] == 0) continue;
+            float cost = surfaceArea(accumMin, accumMax) * accumCount + rightArea[b + 1] * rightCount[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b + 1;
+            }
+        }
+    }
+
+    // Dividir só compensa se o custo esperado cair abaixo de testar todos os triângulos da folha
+    float leafCost = surfaceArea(nodeMin, nodeMax) * count;
+    bool splitHelps = bestAxis >= 0 && bestCost < leafCost;
+    if (!splitHelps && count <= MAX_LEAF_SIZE) return;
+
+    int mid;
+    if (bestAxis >= 0)
+    {
+        float extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+        float scale = SAH_BINS / extent;
+        int* split = std::partition(order_.data() + first, order_.data() + first + count, [&](int tri) {
+            int b = std::min(SAH_BINS - 1, (int)((centroids[tri][bestAxis] - centroidMin[bestAxis]) * scale));
+            return b < bestSplit;
+        });
+        mid = (int)(split - order_.data());
+    }
+    else
+    {
+        // Todos os centróides coincidem: divide ao meio para limitar o tamanho da folha
+        mid = first + count / 2;
+    }
+    if (mid == first || mid == first + count)
+        mid = first + count / 2;
+
+    int left = (int)nodes_.size();
+    nodes_.push_back(Node());
+    nodes_.push_back(Node());
+    nodes_[node].first = left;
+    nodes_[node].count = 0;
+    subdivide(left, first, mid - first, depth + 1, boundsMin, boundsMax, centroids);
+    subdivide(left + 1, mid, first + count - mid, depth + 1, boundsMin, boundsMax, centroids);
+}
+
+bool Bvh::intersect(const glm::vec3& origin, const glm::vec3& direction, Hit& hit) const
+{
+    hit.triangle = -1;
+    if (nodes_.empty()) return false;
+
+    glm::vec3 invDirection = safeInverse(direction);
+    struct Entry {
+        int node;
+        float t;
+    };
+    Entry stack[STACK_SIZE];
+    int stackSize = 0;
+    float tRoot = intersectBounds(nodes_[0].boundsMin, nodes_[0].boundsMax, origin, invDirection, hit.t);
+    if (tRoot != FLT_MAX)
+        stack[stackSize++] = { 0, tRoot };
+
+    while (stackSize > 0)
+    {
+        Entry entry = stack[--stackSize];
+        // Empilhado antes de um acerto mais próximo
+        if (entry.t >= hit.t) continue;
+        const Node& current = nodes_[entry.node];
+
+        if (current.count == 0)
+        {
+            int nearNode = current.first, farNode = current.first + 1;
+            float tNear = intersectBounds(nodes_[nearNode].boundsMin, nodes_[nearNode].boundsMax, origin, invDirection, hit.t);
+            float tFar = intersectBounds(nodes_[farNode].boundsMin, nodes_[farNode].boundsMax, origin, invDirection, hit.t);
+            if (tFar < tNear)
+            {
+                std::swap(tNear, tFar);
+                std::swap(nearNode, farNode);
+            }
+            // O filho mais próximo fica no topo da pilha
+            if (tFar != FLT_MAX && stackSize < STACK_SIZE) stack[stackSize++] = { farNode, tFar };
+            if (tNear != FLT_MAX && stackSize < STACK_SIZE) stack[stackSize++] = { nearNode, tNear };
+            continue;
+        }
+
+        for (int i = current.first; i < current.first + current.count; ++i)
+        {
+            // Möller-Trumbore
+            const Triangle& tri = triangles_[i];
+            glm::vec3 p = glm::cross(direction, tri.edge2);
+            float det = glm::dot(tri.edge1, p);
+            if (std::fabs(det) < 1e-12f) continue;
+            float invDet = 1.0f / det;
+            glm::vec3 s = origin - tri.v0;
+            float u = glm::dot(s, p) * invDet;
+            if (u < 0.0f || u > 1.0f) continue;
+            glm::vec3 q = glm::cross(s, tri.edge1);
+            float v = glm::dot(direction, q) * invDet;
+            if (v < 0.0f || u + v > 1.0f) continue;
+            float t = glm::dot(tri.edge2, q) * invDet;
+            if (t > RAY_EPSILON && t < hit.t)
+            {
+                hit.t = t;
+                hit.u = u;
+                hit.v = v;
+                hit.triangle = i;
+            }
+        }
+    }
+
+    if (hit.triangle >= 0)
+        hit.triangle = order_[hit.triangle];
+    return hit.triangle >= 0;
+}
+
+bool Bvh::occluded(const glm::vec3& origin, const glm::vec3& direction, float tMax) const
+{
+    if (nodes_.empty()) return false;
+
+    glm::vec3 invDirection = safeInverse(direction);
+    int stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& current = nodes_[stack[--stackSize]];
+        if (intersectBounds(current.boundsMin, current.boundsMax, origin, invDirection, tMax) == FLT_MAX)
+            continue;
+
+        if (current.count == 0)
+        {
+            if (stackSize + 2 <= STACK_SIZE)
+            {
+                stack[stackSize++] = current.first + 1;
+                stack[stackSize++] = current.first;
+            }
+            continue;
+        }
+
+        for (int i = current.first; i < current.first + current.count; ++i)
+        {
+            const Triangle& tri = triangles_[i];
+            glm::vec3 p = glm::cross(direction, tri.edge2);
+            float det = glm::dot(tri.edge1, p);
+            if (std::fabs(det) < 1e-12f) continue;
+            float invDet = 1.0f / det;
+            glm::vec3 s = origin - tri.v0;
+            float u = glm::dot(s, p) * invDet;
+            if (u < 0.0f || u > 1.0f) continue;
+            glm::vec3 q = glm::cross(s, tri.edge1);
+            float v = glm::dot(direction, q) * invDet;
+            if (v < 0.0f || u + v > 1.0f) continue;
+            float t = glm::dot(tri.edge2, q) * invDet;
+            if (t > RAY_EPSILON && t < tMax)
+                return true;
+        }
+    }
+    return false;
+}
+
+#ifdef BVH_USE_SSE
+
+void Bvh::intersect4(const glm::vec3 origin[4], const glm::vec3 direction[4], Hit hit[4]) const
+{
+    for (int i = 0; i < 4; ++i)
+        hit[i].triangle = -1;
+    if (nodes_.empty()) return;
+
+    // Estrutura de arrays: cada registrador guarda a mesma componente dos 4 raios
+    __m128 ox = _mm_setr_ps(origin[0].x, origin[1].x, origin[2].x, origin[3].x);
+    __m128 oy = _mm_setr_ps(origin[0].y, origin[1].y, origin[2].y, origin[3].y);
+    __m128 oz = _mm_setr_ps(origin[0].z, origin[1].z, origin[2].z, origin[3].z);
+    __m128 dx = _mm_setr_ps(direction[0].x, direction[1].x, direction[2].x, direction[3].x);
+    __m128 dy = _mm_setr_ps(direction[0].y, direction[1].y, direction[2].y, direction[3].y);
+    __m128 dz = _mm_setr_ps(direction[0].z, direction[1].z, direction[2].z, direction[3].z);
+    glm::vec3 inv[4] = { safeInverse(direction[0]), safeInverse(direction[1]), safeInverse(direction[2]), safeInverse(direction[3]) };
+    __m128 ix = _mm_setr_ps(inv[0].x, inv[1].x, inv[2].x, inv[3].x);
+    __m128 iy = _mm_setr_ps(inv[0].y, inv[1].y, inv[2].y, inv[3].y);
+    __m128 iz = _mm_setr_ps(inv[0].z, inv[1].z, inv[2].z, inv[3].z);
+    __m128 tBest = _mm_setr_ps(hit[0].t, hit[1].t, hit[2].t, hit[3].t);
+    __m128 uBest = _mm_setzero_ps(), vBest = _mm_setzero_ps();
+    __m128i triBest = _mm_set1_epi32(-1);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 epsilon = _mm_set1_ps(RAY_EPSILON);
+    const __m128 minDet = _mm_set1_ps(1e-12f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    // Distância de entrada por raio; lanes que não acertam ficam com +inf
+    auto boundsEntry = [&](const Node& n, int& mask) {
+        __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.boundsMin.x), ox), ix);
+        __m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.boundsMax.x), ox), ix);
+        __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.boundsMin.y), oy), iy);
+        __m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.boundsMax.y), oy), iy);
+        __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.boundsMin.z), oz), iz);
+        __m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.boundsMax.z), oz), iz);
+        __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_max_ps(_mm_min_ps(t1z, t2z), zero));
+        __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_min_ps(_mm_max_ps(t1z, t2z), tBest));
+        __m128 hitMask = _mm_cmple_ps(tNear, tFar);
+        mask = _mm_movemask_ps(hitMask);
+        return _mm_or_ps(_mm_and_ps(hitMask, tNear), _mm_andnot_ps(hitMask, _mm_set1_ps(FLT_MAX)));
+    };
+
+    // Menor distância de entrada entre as lanes, para ordenar os filhos
+    auto minLane = [](__m128 v) {
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    };
+
+    int stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& current = nodes_[stack[--stackSize]];
+        int active;
+        boundsEntry(current, active);
+        if (!active) continue;
+
+        if (current.count == 0)
+        {
+            int maskLeft, maskRight;
+            float tLeft = minLane(boundsEntry(nodes_[current.first], maskLeft));
+            float tRight = minLane(boundsEntry(nodes_[current.first + 1], maskRight));
+            if (stackSize + 2 > STACK_SIZE) continue;
+            // O mais próximo fica no topo da pilha
+            if (tLeft <= tRight)
+            {
+                if (maskRight) stack[stackSize++] = current.first + 1;
+                if (maskLeft) stack[stackSize++] = current.first;
+            }
+            else
+            {
+                if (maskLeft) stack[stackSize++] = current.first;
+                if (maskRight) stack[stackSize++] = current.first + 1;
+            }
+            continue;
+        }
+
+        for (int i = current.first; i < current.first + current.count; ++i)
+        {
+            // Möller-Trumbore com um triângulo contra os 4 raios
+            const Triangle& tri = triangles_[i];
+            __m128 e1x = _mm_set1_ps(tri.edge1.x), e1y = _mm_set1_ps(tri.edge1.y), e1z = _mm_set1_ps(tri.edge1.z);
+            __m128 e2x = _mm_set1_ps(tri.edge2.x), e2y = _mm_set1_ps(tri.edge2.y), e2z = _mm_set1_ps(tri.edge2.z);
+
+            __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+            __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+            __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+            __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+            __m128 valid = _mm_cmpgt_ps(_mm_and_ps(det, absMask), minDet);
+            if (!_mm_movemask_ps(valid)) continue;
+            __m128 invDet = _mm_div_ps(one, det);
+
+            __m128 sx = _mm_sub_ps(ox, _mm_set1_ps(tri.v0.x));
+            __m128 sy = _mm_sub_ps(oy, _mm_set1_ps(tri.v0.y));
+            __m128 sz = _mm_sub_ps(oz, _mm_set1_ps(tri.v0.z));
+            __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+            __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+            __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+            __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+            __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+            __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+            valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+            valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+            valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+            valid = _mm_and_ps(valid, _mm_cmpgt_ps(t, epsilon));
+            valid = _mm_and_ps(valid, _mm_cmplt_ps(t, tBest));
+            if (!_mm_movemask_ps(valid)) continue;
+
+            tBest = _mm_or_ps(_mm_and_ps(valid, t), _mm_andnot_ps(valid, tBest));
+            uBest = _mm_or_ps(_mm_and_ps(valid, u), _mm_andnot_ps(valid, uBest));
+            vBest = _mm_or_ps(_mm_and_ps(valid, v), _mm_andnot_ps(valid, vBest));
+            __m128i validInt = _mm_castps_si128(valid);
+            triBest = _mm_or_si128(_mm_and_si128(validInt, _mm_set1_epi32(i)), _mm_andnot_si128(validInt, triBest));
+        }
+    }
+
+    alignas(16) float tOut[4], uOut[4], vOut[4];
+    alignas(16) int triOut[4];
+    _mm_store_ps(tOut, tBest);
+    _mm_store_ps(uOut, uBest);
+    _mm_store_ps(vOut, vBest);
+    _mm_store_si128((__m128i*)triOut, triBest);
+    for (int i = 0; i < 4; ++i)
+    {
+        if (triOut[i] < 0) continue;
+        hit[i].t = tOut[i];
+        hit[i].u = uOut[i];
+        hit[i].v = vOut[i];
+        hit[i].triangle = order_[triOut[i]];
+    }
+}
+
+int Bvh::occluded4(const glm::vec3& origin, const glm::vec3 direction[4], float tMax) const
+{
+    if (nodes_.empty()) return 0;
+
+    __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+    __m128 dx = _mm_setr_ps(direction[0].x, direction[1].x, direction[2].x, direction[3].x);
+    __m128 dy = _mm_setr_ps(direction[0].y, direction[1].y, direction[2].y, direction[3].y);
+    __m128 dz = _mm_setr_ps(direction[0].z, direction[1].z, direction[2].z, direction[3].z);
+    glm::vec3 inv[4] = { safeInverse(direction[0]), safeInverse(direction[1]), safeInverse(direction[2]), safeInverse(direction[3]) };
+    __m128 ix = _mm_setr_ps(inv[0].x, inv[1].x, inv[2].x, inv[3].x);
+    __m128 iy = _mm_setr_ps(inv[0].y, inv[1].y, inv[2].y, inv[3].y);
+    __m128 iz = _mm_setr_ps(inv[0].z, inv[1].z, inv[2].z, inv[3].z);
+    const __m128 tFarLimit = _mm_set1_ps(tMax);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 epsilon = _mm_set1_ps(RAY_EPSILON);
+    const __m128 minDet = _mm_set1_ps(1e-12f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    // Lanes já bloqueadas deixam de contar; a travessia para quando as 4 estão bloqueadas
+    int blocked = 0;
+    int stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0 && blocked != 0xF)
+    {
+        const Node& current = nodes_[stack[--stackSize]];
+        __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(current.boundsMin.x), ox), ix);
+        __m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(current.boundsMax.x), ox), ix);
+        __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(current.boundsMin.y), oy), iy);
+        __m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(current.boundsMax.y), oy), iy);
+        __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(current.boundsMin.z), oz), iz);
+        __m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(current.boundsMax.z), oz), iz);
+        __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_max_ps(_mm_min_ps(t1z, t2z), zero));
+        __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_min_ps(_mm_max_ps(t1z, t2z), tFarLimit));
+        if (!(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)) & ~blocked)) continue;
+
+        if (current.count == 0)
+        {
+            if (stackSize + 2 <= STACK_SIZE)
+            {
+                stack[stackSize++] = current.first + 1;
+                stack[stackSize++] = current.first;
+            }
+            continue;
+        }
+
+        for (int i = current.first; i < current.first + current.count && blocked != 0xF; ++i)
+        {
+            const Triangle& tri = triangles_[i];
+            __m128 e1x = _mm_set1_ps(tri.edge1.x), e1y = _mm_set1_ps(tri.edge1.y), e1z = _mm_set1_ps(tri.edge1.z);
+            __m128 e2x = _mm_set1_ps(tri.edge2.x), e2y = _mm_set1_ps(tri.edge2.y), e2z = _mm_set1_ps(tri.edge2.z);
+
+            __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+            __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+            __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+            __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+            __m128 valid = _mm_cmpgt_ps(_mm_and_ps(det, absMask), minDet);
+            if (!(_mm_movemask_ps(valid) & ~blocked)) continue;
+            __m128 invDet = _mm_div_ps(one, det);
+
+            // Origem comum: s e q são os mesmos nas 4 lanes
+            glm::vec3 s = origin - tri.v0;
+            glm::vec3 q = glm::cross(s, tri.edge1);
+            __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.x), px), _mm_mul_ps(_mm_set1_ps(s.y), py)),
+                                             _mm_mul_ps(_mm_set1_ps(s.z), pz)), invDet);
+            __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(q.x)), _mm_mul_ps(dy, _mm_set1_ps(q.y))),
+                                             _mm_mul_ps(dz, _mm_set1_ps(q.z))), invDet);
+            __m128 t = _mm_mul_ps(_mm_set1_ps(glm::dot(tri.edge2, q)), invDet);
+
+            valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+            valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+            valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+            valid = _mm_and_ps(valid, _mm_cmpgt_ps(t, epsilon));
+            valid = _mm_and_ps(valid, _mm_cmplt_ps(t, tFarLimit));
+            blocked |= _mm_movemask_ps(valid);
+        }
+    }
+    return blocked;
+}
+
+#else
+
+void Bvh::intersect4(const glm::vec3 origin[4], const glm::vec3 direction[4], Hit hit[4]) const
+{
+    for (int i = 0; i < 4; ++i)
+        intersect(origin[i], direction[i], hit[i]);
+}
+
+int Bvh::occluded4(const glm::vec3& origin, const glm::vec3 direction[4], float tMax) const
+{
+    int blocked = 0;
+    for (int i = 0; i < 4; ++i)
+        if (occluded(origin, direction[i], tMax)) blocked |= 1 << i;
+    return blocked;
+}
+
+#endif
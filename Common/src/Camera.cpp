@@ -26,14 +26,20 @@ void Camera::initialize(Shader* shader, int width, int height)
 }
 
 void Camera::update()
+{
+    apply(shader);
+}
+
+// Envia view, projection e viewPos para um shader qualquer (ex.: passe de G-buffer)
+void Camera::apply(Shader* target) const
 {
     glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-    shader->setMat4("view", view);
+    target->setMat4("view", view);
 
-    shader->setVec3("viewPos", cameraPos);
+    target->setVec3("viewPos", cameraPos);
 
     glm::mat4 projection = glm::perspective(glm::radians(fov_), aspect_, near_, far_);
-    shader->setMat4("projection", projection);
+    target->setMat4("projection", projection);
 }
 
 void Camera::setCameraPos(int key)
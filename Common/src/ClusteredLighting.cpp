@@ -0,0 +1,326 @@
+#include "ClusteredLighting.h"
+#include "GpuResources.h"
+#include "JobSystem.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CLUSTER_USE_SSE 1
+#endif
+
+namespace {
+    const int CLUSTER_COUNT = ClusteredLighting::CLUSTERS_X * ClusteredLighting::CLUSTERS_Y * ClusteredLighting::CLUSTERS_Z;
+}
+
+ClusteredLighting::ClusteredLighting() :
+    screenWidth_(0), screenHeight_(0),
+    builtFov_(0.0f), builtAspect_(0.0f), builtNear_(0.0f), builtFar_(0.0f),
+    lightsDirty_(true), ring_(nullptr),
+    lightsUBO_(0), gridBuffer_(0), gridTexture_(0), indexBuffer_(0), indexTexture_(0), resource_(-1)
+{
+    for (glm::vec3& coefficient : environment_)
+        coefficient = glm::vec3(0.0f);
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+    release();
+}
+
+void ClusteredLighting::release()
+{
+    if (lightsUBO_) glDeleteBuffers(1, &lightsUBO_);
+    if (gridBuffer_) glDeleteBuffers(1, &gridBuffer_);
+    if (indexBuffer_) glDeleteBuffers(1, &indexBuffer_);
+    if (gridTexture_) glDeleteTextures(1, &gridTexture_);
+    if (indexTexture_) glDeleteTextures(1, &indexTexture_);
+    lightsUBO_ = gridBuffer_ = indexBuffer_ = gridTexture_ = indexTexture_ = 0;
+    GpuResources::instance().remove(resource_);
+    resource_ = -1;
+}
+
+void ClusteredLighting::initialize(int screenWidth, int screenHeight)
+{
+    screenWidth_ = screenWidth;
+    screenHeight_ = screenHeight;
+    builtFov_ = 0.0f; // força reconstruir os AABBs
+
+    clusterScratch_.resize((size_t)CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER);
+    clusterCounts_.resize(CLUSTER_COUNT);
+    gridData_.resize((size_t)CLUSTER_COUNT * 2);
+
+    if (lightsUBO_ == 0)
+    {
+        glGenBuffers(1, &lightsUBO_);
+        glBindBuffer(GL_UNIFORM_BUFFER, lightsUBO_);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightsBlock), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glGenBuffers(1, &gridBuffer_);
+        glGenBuffers(1, &indexBuffer_);
+        glGenTextures(1, &gridTexture_);
+        glGenTextures(1, &indexTexture_);
+        resource_ = GpuResources::instance().add(GpuCategory::Buffer, sizeof(LightsBlock));
+    }
+}
+
+void ClusteredLighting::setLights(const std::vector<LightSourceConfig>& lights)
+{
+    lights_ = lights;
+    if (lights_.size() > (size_t)MAX_LIGHTS)
+    {
+        std::cerr << "ClusteredLighting: " << lights_.size() << " luzes, usando apenas " << MAX_LIGHTS << std::endl;
+        lights_.resize(MAX_LIGHTS);
+    }
+    lightsDirty_ = true;
+}
+
+void ClusteredLighting::setEnvironment(const EnvironmentLighting& environment)
+{
+    for (int i = 0; i < EnvironmentLighting::SH_COEFFICIENTS; ++i)
+        environment_[i] = environment.getCoefficients()[i];
+}
+
+void ClusteredLighting::buildClusterBounds(const Camera& camera)
+{
+    builtFov_ = camera.getFov();
+    builtAspect_ = camera.getAspect();
+    builtNear_ = camera.getNear();
+    builtFar_ = camera.getFar();
+
+    for (int z = 0; z <= CLUSTERS_Z; ++z)
+        sliceDepth_[z] = builtNear_ * std::pow(builtFar_ / builtNear_, (float)z / CLUSTERS_Z);
+
+    float tanY = std::tan(glm::radians(builtFov_) * 0.5f);
+    float tanX = tanY * builtAspect_;
+
+    clusterBounds_.resize(CLUSTER_COUNT);
+    for (int z = 0; z < CLUSTERS_Z; ++z)
+    {
+        float d0 = sliceDepth_[z];
+        float d1 = sliceDepth_[z + 1];
+        for (int y = 0; y < CLUSTERS_Y; ++y)
+        {
+            float ny0 = -1.0f + 2.0f * y / CLUSTERS_Y;
+            float ny1 = -1.0f + 2.0f * (y + 1) / CLUSTERS_Y;
+            for (int x = 0; x < CLUSTERS_X; ++x)
+            {
+                float nx0 = -1.0f + 2.0f * x / CLUSTERS_X;
+                float nx1 = -1.0f + 2.0f * (x + 1) / CLUSTERS_X;
+
+                AABB box;
+                box.min = glm::vec3(1e30f);
+                box.max = glm::vec3(-1e30f);
+                const float depths[2] = { d0, d1 };
+                const float nxs[2] = { nx0, nx1 };
+                const float nys[2] = { ny0, ny1 };
+                for (float d : depths)
+                    for (float nx : nxs)
+                        for (float ny : nys)
+                        {
+                            glm::vec3 p(nx * tanX * d, ny * tanY * d, -d);
+                            box.min = glm::min(box.min, p);
+                            box.max = glm::max(box.max, p);
+                        }
+                clusterBounds_[x + CLUSTERS_X * (y + CLUSTERS_Y * z)] = box;
+            }
+        }
+    }
+}
+
+void ClusteredLighting::binSlice(int z)
+{
+    // Pré-filtra as luzes que cruzam a faixa de profundidade da fatia
+    float d0 = sliceDepth_[z];
+    float d1 = sliceDepth_[z + 1];
+
+    int candidates[MAX_LIGHTS];
+    int nCandidates = 0;
+    for (size_t i = 0; i < lights_.size(); ++i)
+    {
+        float depth = -viewZ_[i];
+        if (depth + radius_[i] >= d0 && depth - radius_[i] <= d1)
+            candidates[nCandidates++] = (int)i;
+    }
+
+    // SoA compacta das candidatas, preenchida até múltiplo de 4
+    alignas(16) float cx[MAX_LIGHTS + 4], cy[MAX_LIGHTS + 4], cz[MAX_LIGHTS + 4], cr2[MAX_LIGHTS + 4];
+    int padded = (nCandidates + 3) & ~3;
+    for (int i = 0; i < padded; ++i)
+    {
+        if (i < nCandidates)
+        {
+            int l = candidates[i];
+            cx[i] = viewX_[l]; cy[i] = viewY_[l]; cz[i] = viewZ_[l]; cr2[i] = radius_[l] * radius_[l];
+        }
+        else
+        {
+            cx[i] = cy[i] = cz[i] = 1e30f; cr2[i] = -1.0f;
+        }
+    }
+
+    for (int y = 0; y < CLUSTERS_Y; ++y)
+    {
+        for (int x = 0; x < CLUSTERS_X; ++x)
+        {
+            int cluster = x + CLUSTERS_X * (y + CLUSTERS_Y * z);
+            const AABB& box = clusterBounds_[cluster];
+            uint16_t* out = &clusterScratch_[(size_t)cluster * MAX_LIGHTS_PER_CLUSTER];
+            int count = 0;
+
+#ifdef CLUSTER_USE_SSE
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 minX = _mm_set1_ps(box.min.x), maxX = _mm_set1_ps(box.max.x);
+            const __m128 minY = _mm_set1_ps(box.min.y), maxY = _mm_set1_ps(box.max.y);
+            const __m128 minZ = _mm_set1_ps(box.min.z), maxZ = _mm_set1_ps(box.max.z);
+            for (int i = 0; i < padded && count < MAX_LIGHTS_PER_CLUSTER; i += 4)
+            {
+                __m128 px = _mm_load_ps(cx + i);
+                __m128 py = _mm_load_ps(cy + i);
+                __m128 pz = _mm_load_ps(cz + i);
+                // Distância da esfera ao AABB: só um dos dois termos é positivo por eixo
+                __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minX, px), zero), _mm_max_ps(_mm_sub_ps(px, maxX), zero));
+                __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minY, py), zero), _mm_max_ps(_mm_sub_ps(py, maxY), zero));
+                __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minZ, pz), zero), _mm_max_ps(_mm_sub_ps(pz, maxZ), zero));
+                __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                int mask = _mm_movemask_ps(_mm_cmple_ps(dist2, _mm_load_ps(cr2 + i)));
+                while (mask && count < MAX_LIGHTS_PER_CLUSTER)
+                {
+                    int bit = 0;
+                    while (!(mask & (1 << bit))) ++bit;
+                    mask &= ~(1 << bit);
+                    out[count++] = (uint16_t)candidates[i + bit];
+                }
+            }
+#else
+            for (int i = 0; i < nCandidates && count < MAX_LIGHTS_PER_CLUSTER; ++i)
+            {
+                float dx = std::max(box.min.x - cx[i], 0.0f) + std::max(cx[i] - box.max.x, 0.0f);
+                float dy = std::max(box.min.y - cy[i], 0.0f) + std::max(cy[i] - box.max.y, 0.0f);
+                float dz = std::max(box.min.z - cz[i], 0.0f) + std::max(cz[i] - box.max.z, 0.0f);
+                if (dx * dx + dy * dy + dz * dz <= cr2[i])
+                    out[count++] = (uint16_t)candidates[i];
+            }
+#endif
+            clusterCounts_[cluster] = (uint16_t)count;
+        }
+    }
+}
+
+void ClusteredLighting::update(const Camera& camera)
+{
+    if (screenWidth_ == 0) return;
+
+    if (camera.getFov() != builtFov_ || camera.getAspect() != builtAspect_ ||
+        camera.getNear() != builtNear_ || camera.getFar() != builtFar_)
+        buildClusterBounds(camera);
+
+    glm::mat4 view = camera.getViewMatrix();
+    size_t n = lights_.size();
+    viewX_.resize(n); viewY_.resize(n); viewZ_.resize(n); radius_.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        glm::vec4 p = view * glm::vec4(lights_[i].position, 1.0f);
+        viewX_[i] = p.x; viewY_[i] = p.y; viewZ_[i] = p.z;
+        radius_[i] = lights_[i].range();
+    }
+
+    JobSystem::shared().parallelFor(CLUSTERS_Z, [this](int z) { binSlice(z); });
+
+    // Compacta as listas por cluster em (offset, count) + lista global de índices
+    indexList_.clear();
+    for (int c = 0; c < CLUSTER_COUNT; ++c)
+    {
+        gridData_[c * 2 + 0] = (GLuint)indexList_.size();
+        gridData_[c * 2 + 1] = clusterCounts_[c];
+        const uint16_t* list = &clusterScratch_[(size_t)c * MAX_LIGHTS_PER_CLUSTER];
+        indexList_.insert(indexList_.end(), list, list + clusterCounts_[c]);
+    }
+    if (indexList_.empty()) indexList_.push_back(0);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer_);
+    glBufferData(GL_TEXTURE_BUFFER, gridData_.size() * sizeof(GLuint), gridData_.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer_);
+    glBufferData(GL_TEXTURE_BUFFER, indexList_.size() * sizeof(uint16_t), indexList_.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    GpuResources::instance().resize(resource_, sizeof(LightsBlock) + gridData_.size() * sizeof(GLuint) + indexList_.size() * sizeof(uint16_t));
+
+    uploadLights();
+}
+
+void ClusteredLighting::uploadLights()
+{
+    LightsBlock& block = block_;
+
+    glm::vec3 ambient(0.0f);
+    for (size_t i = 0; i < lights_.size(); ++i)
+    {
+        const LightSourceConfig& light = lights_[i];
+        ambient += light.ambient;
+        block.lightPosRadius[i] = glm::vec4(light.position, light.range());
+        block.lightDiffuse[i] = glm::vec4(light.diffuse * light.intensity, 0.0f);
+        block.lightSpecular[i] = glm::vec4(light.specular * light.intensity, 0.0f);
+    }
+
+    float logRatio = std::log(builtFar_ / builtNear_);
+    block.ambient = glm::vec4(ambient, 0.0f);
+    // Cabe no cabeçalho enviado todo frame: 9 vec4
+    block.shAmbient[0] = glm::vec4(environment_[0] + ambient, 0.0f);
+    for (int i = 1; i < EnvironmentLighting::SH_COEFFICIENTS; ++i)
+        block.shAmbient[i] = glm::vec4(environment_[i], 0.0f);
+    block.clusterDims = glm::uvec4(CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z, (unsigned int)lights_.size());
+    block.clusterDepth = glm::vec4(builtNear_, builtFar_,
+                                   CLUSTERS_Z / logRatio,
+                                   CLUSTERS_Z * std::log(builtNear_) / logRatio);
+    block.clusterTile = glm::vec4(std::ceil((float)screenWidth_ / CLUSTERS_X),
+                                  std::ceil((float)screenHeight_ / CLUSTERS_Y), 0.0f, 0.0f);
+
+    lightsRange_ = ring_ ? ring_->allocate(sizeof(LightsBlock)) : FrameRing::Allocation();
+    if (lightsRange_.data)
+    {
+        memcpy(lightsRange_.data, &block, sizeof(LightsBlock));
+        // O UBO próprio ficou para trás: se o anel faltar num frame, ele recebe o bloco inteiro
+        lightsDirty_ = true;
+        return;
+    }
+
+    // Só envia os arrays de luz quando mudaram; o cabeçalho vai todo frame
+    size_t header = offsetof(LightsBlock, lightPosRadius);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightsUBO_);
+    if (lightsDirty_)
+    {
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightsBlock), &block);
+        lightsDirty_ = false;
+    }
+    else
+    {
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, header, &block);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void ClusteredLighting::bind(Shader* shader)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(shader->ID, "Lights");
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(shader->ID, blockIndex, LIGHTS_UBO_BINDING);
+    if (lightsRange_.data)
+        ring_->bindRange(GL_UNIFORM_BUFFER, LIGHTS_UBO_BINDING, lightsRange_);
+    else
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTS_UBO_BINDING, lightsUBO_);
+
+    shader->Use();
+    shader->setInt("clusterGrid", GRID_TEXTURE_UNIT);
+    shader->setInt("clusterLights", INDEX_TEXTURE_UNIT);
+
+    glActiveTexture(GL_TEXTURE0 + GRID_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, gridTexture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, gridBuffer_);
+    glActiveTexture(GL_TEXTURE0 + INDEX_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, indexBuffer_);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -1,7 +1,28 @@
 #include "Curve.h"
 #include <glad/glad.h>
 
-Curve::Curve() : VAO_Curve(0), VBO_Curve(0), shader(nullptr)
+namespace {
+    // Reaproveita o VAO e o VBO que já existirem; o VBO só troca (pelo pool) se os pontos não couberem
+    size_t uploadCurveGeometry(GpuGeometry& geometry, const vector<glm::vec3>& points)
+    {
+        if (!geometry.vao)
+            geometry.vao = GLVertexArray::create();
+        if (geometry.buffers.empty())
+            geometry.buffers.emplace_back();
+        geometry.buffers[0].upload(points.size() * sizeof(glm::vec3), points.data());
+
+        glBindVertexArray(geometry.vao.get());
+        glBindBuffer(GL_ARRAY_BUFFER, geometry.buffers[0].get());
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        return geometry.buffers[0].getCapacity();
+    }
+}
+
+Curve::Curve() : shader(nullptr), gpuUpload(true)
 {
 }
 
@@ -12,28 +33,27 @@ void Curve::setShader(Shader* shader_in)
 
 void Curve::setupCurveGeometry()
 {
-    if (curvePoints.empty()) return;
+    if (curvePoints.empty() || !gpuUpload) return;
 
-    if (VAO_Curve != 0) glDeleteVertexArrays(1, &VAO_Curve);
-    if (VBO_Curve != 0) glDeleteBuffers(1, &VBO_Curve);
+    // Regenerar reaproveita a geometria se nenhuma outra cópia da curva a divide; senão esta cópia
+    // passa a ter a sua e as outras continuam desenhando os pontos antigos
+    if (!geometry || geometry.use_count() > 1)
+        geometry = std::make_shared<GpuGeometry>();
+    GpuResources& resources = GpuResources::instance();
+    resources.remove(geometry->resource);
 
-    glGenVertexArrays(1, &VAO_Curve);
-    glGenBuffers(1, &VBO_Curve);
-
-    glBindVertexArray(VAO_Curve);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_Curve);
-    glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(glm::vec3), curvePoints.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // Os pontos ficam em CPU de qualquer forma: a curva pode ser despejada e recriada a partir deles
+    size_t bytes = uploadCurveGeometry(*geometry, curvePoints);
+    GpuGeometry* target = geometry.get();
+    vector<glm::vec3> points = curvePoints;
+    geometry->resource = resources.add(GpuCategory::Geometry, bytes,
+        [target]() { target->destroy(); },
+        [target, points]() { return uploadCurveGeometry(*target, points); });
 }
 
 void Curve::drawCurve(glm::vec4 color)
 {
-    if (curvePoints.empty() || VAO_Curve == 0) return;
+    if (curvePoints.empty() || !geometry) return;
 
     if (!shader) {
         std::cerr << "Curve shader not set!" << std::endl;
@@ -45,7 +65,8 @@ void Curve::drawCurve(glm::vec4 color)
     glm::mat4 identityModel = glm::mat4(1.0f);
     shader->setMat4("model", identityModel); 
 
-    glBindVertexArray(VAO_Curve);
+    GpuResources::instance().use(geometry->resource);
+    glBindVertexArray(geometry->vao.get());
     glDrawArrays(GL_LINE_STRIP, 0, curvePoints.size());
     glDrawArrays(GL_POINTS, 0, curvePoints.size()); 
     glBindVertexArray(0);
@@ -0,0 +1,191 @@
+#include "DeferredRenderer.h"
+#include "GpuResources.h"
+
+namespace {
+    // Unidades de textura do passe de iluminação (0..2 ficam com o mesh e os clusters)
+    const int GBUFFER_FIRST_UNIT = 3;
+    const char* TARGET_SAMPLERS[] = { "gAlbedo", "gNormal", "gSpecular", "gAmbient" };
+}
+
+DeferredRenderer::DeferredRenderer() :
+    width_(0), height_(0), fbo_(0), depthTexture_(0), emptyVAO_(0), outputFBO_(0), samplersBound_(false), resource_(-1)
+{
+    for (int i = 0; i < TARGET_COUNT; ++i) targets_[i] = 0;
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+    release();
+}
+
+void DeferredRenderer::release()
+{
+    releaseTargets();
+    if (emptyVAO_) glDeleteVertexArrays(1, &emptyVAO_);
+    emptyVAO_ = 0;
+    for (auto& shader : geometryShaders_)
+        shader.reset();
+    lightingShader_.reset();
+    geometryTimer_.release();
+    lightingTimer_.release();
+}
+
+void DeferredRenderer::releaseTargets()
+{
+    if (fbo_) glDeleteFramebuffers(1, &fbo_);
+    glDeleteTextures(TARGET_COUNT, targets_);
+    if (depthTexture_) glDeleteTextures(1, &depthTexture_);
+    GpuResources::instance().remove(resource_);
+    resource_ = -1;
+    fbo_ = 0;
+    depthTexture_ = 0;
+    for (int i = 0; i < TARGET_COUNT; ++i) targets_[i] = 0;
+}
+
+bool DeferredRenderer::initialize(int width, int height, const std::string& shaderDir)
+{
+    releaseTargets();
+    width_ = width;
+    height_ = height;
+
+    if (!lightingShader_)
+    {
+        shaderDir_ = shaderDir;
+        lightingShader_.reset(new Shader((shaderDir + "deferred_light.vs").c_str(), (shaderDir + "deferred_light.fs").c_str()));
+        samplersBound_ = false;
+
+        glGenVertexArrays(1, &emptyVAO_);
+    }
+
+    const GLenum internalFormats[TARGET_COUNT] = { GL_RGBA8, GL_RGBA16F, GL_RGBA8, GL_RGBA16F };
+    const GLenum types[TARGET_COUNT] = { GL_UNSIGNED_BYTE, GL_HALF_FLOAT, GL_UNSIGNED_BYTE, GL_HALF_FLOAT };
+
+    glGenFramebuffers(1, &fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+
+    glGenTextures(TARGET_COUNT, targets_);
+    GLenum drawBuffers[TARGET_COUNT];
+    for (int i = 0; i < TARGET_COUNT; ++i)
+    {
+        glBindTexture(GL_TEXTURE_2D, targets_[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormats[i], width, height, 0, GL_RGBA, types[i], nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, targets_[i], 0);
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    glDrawBuffers(TARGET_COUNT, drawBuffers);
+
+    // Mesmo formato do framebuffer padrão para permitir o blit de profundidade
+    glGenTextures(1, &depthTexture_);
+    glBindTexture(GL_TEXTURE_2D, depthTexture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture_, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "DeferredRenderer: G-buffer incompleto (0x" << std::hex << status << std::dec << ")" << std::endl;
+        releaseTargets();
+        return false;
+    }
+    // RGBA8 + RGBA16F + RGBA8 + RGBA16F e profundidade D24S8
+    resource_ = GpuResources::instance().add(GpuCategory::RenderTarget, (size_t)width * height * (4 + 8 + 4 + 8 + 4));
+    return true;
+}
+
+Shader* DeferredRenderer::getGeometryShader(bool textured, bool textureArray)
+{
+    int variant = !textured ? GEOMETRY_UNTEXTURED : textureArray ? GEOMETRY_ARRAY : GEOMETRY_TEXTURED;
+    std::unique_ptr<Shader>& shader = geometryShaders_[variant];
+    if (!shader)
+    {
+        ShaderDefines defines;
+        if (textured)
+            defines["TEXTURED"] = "";
+        if (textureArray)
+            defines["TEXTURE_ARRAY"] = "";
+        shader.reset(new Shader((shaderDir_ + "object.vs").c_str(), (shaderDir_ + "gbuffer.fs").c_str(), defines));
+    }
+    return shader.get();
+}
+
+void DeferredRenderer::beginGeometryPass(const Camera& camera)
+{
+    geometryTimer_.begin();
+
+    // O resultado vai para o framebuffer que estava vinculado (janela ou alvo offscreen)
+    GLint output = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &output);
+    outputFBO_ = (GLuint)output;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glViewport(0, 0, width_, height_);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    // Só as permutações que algum mesh pediu
+    for (auto& shader : geometryShaders_)
+    {
+        if (!shader)
+            continue;
+        shader->Use();
+        camera.apply(shader.get());
+    }
+}
+
+void DeferredRenderer::endGeometryPass()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFBO_);
+    geometryTimer_.end();
+}
+
+void DeferredRenderer::lightingPass(const Camera& camera, ClusteredLighting& lights)
+{
+    lightingTimer_.begin();
+
+    glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+
+    lights.bind(lightingShader_.get());
+    lightingShader_->Use();
+    // Só no primeiro uso, para não esperar a compilação do programa durante a inicialização
+    if (!samplersBound_)
+    {
+        for (int i = 0; i < TARGET_COUNT; ++i)
+            lightingShader_->setInt(TARGET_SAMPLERS[i], GBUFFER_FIRST_UNIT + i);
+        lightingShader_->setInt("gDepth", GBUFFER_FIRST_UNIT + TARGET_COUNT);
+        samplersBound_ = true;
+    }
+    lightingShader_->setMat4("invViewProjection", glm::inverse(viewProjection));
+    lightingShader_->setVec3("viewPos", camera.getCameraPos());
+
+    for (int i = 0; i < TARGET_COUNT; ++i)
+    {
+        glActiveTexture(GL_TEXTURE0 + GBUFFER_FIRST_UNIT + i);
+        glBindTexture(GL_TEXTURE_2D, targets_[i]);
+    }
+    glActiveTexture(GL_TEXTURE0 + GBUFFER_FIRST_UNIT + TARGET_COUNT);
+    glBindTexture(GL_TEXTURE_2D, depthTexture_);
+    glActiveTexture(GL_TEXTURE0);
+
+    // Tela cheia sem teste de profundidade; o fundo é descartado no shader
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(emptyVAO_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+
+    // Copia a profundidade do G-buffer para que curvas e overlays forward testem contra a cena
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFBO_);
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFBO_);
+
+    lightingTimer_.end();
+}
@@ -0,0 +1,179 @@
+#include "EnvironmentLighting.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <stb_image.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ENVIRONMENT_USE_SSE 1
+#endif
+
+namespace {
+    const float PI = 3.14159265358979f;
+    const int ROWS_PER_TASK = 8;
+
+    // Constante da base (k^2) vezes a convolução do cosseno por banda (A_l / π)
+    const float COEFFICIENT_SCALE[EnvironmentLighting::SH_COEFFICIENTS] = {
+        0.282095f * 0.282095f,
+        0.488603f * 0.488603f * (2.0f / 3.0f),
+        0.488603f * 0.488603f * (2.0f / 3.0f),
+        0.488603f * 0.488603f * (2.0f / 3.0f),
+        1.092548f * 1.092548f * 0.25f,
+        1.092548f * 1.092548f * 0.25f,
+        0.315392f * 0.315392f * 0.25f,
+        1.092548f * 1.092548f * 0.25f,
+        0.546274f * 0.546274f * 0.25f,
+    };
+
+    // Os mesmos polinômios do shader, sem as constantes
+    inline void basis(float x, float y, float z, float out[EnvironmentLighting::SH_COEFFICIENTS])
+    {
+        out[0] = 1.0f;
+        out[1] = y;
+        out[2] = z;
+        out[3] = x;
+        out[4] = x * y;
+        out[5] = y * z;
+        out[6] = 3.0f * z * z - 1.0f;
+        out[7] = x * z;
+        out[8] = x * x - y * y;
+    }
+
+#ifdef ENVIRONMENT_USE_SSE
+    inline float horizontalSum(__m128 v)
+    {
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    }
+#endif
+}
+
+EnvironmentLighting::EnvironmentLighting() : loaded_(false), jobs_(nullptr), projectMs_(0.0)
+{
+    clear();
+}
+
+void EnvironmentLighting::clear()
+{
+    for (int i = 0; i < SH_COEFFICIENTS; ++i)
+        coefficients_[i] = glm::vec3(0.0f);
+    loaded_ = false;
+}
+
+bool EnvironmentLighting::loadEquirectangular(const std::string& path, float intensity)
+{
+    // stbi_loadf lineariza imagens LDR (gama 2.2) e lê .hdr direto
+    int width, height, channels;
+    float* pixels = stbi_loadf(path.c_str(), &width, &height, &channels, 3);
+    if (!pixels)
+    {
+        std::cerr << "Falha ao carregar mapa de ambiente: " << path << std::endl;
+        return false;
+    }
+    project(pixels, width, height, intensity);
+    stbi_image_free(pixels);
+    return true;
+}
+
+void EnvironmentLighting::project(const float* rgb, int width, int height, float intensity)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // φ por coluna é o mesmo em todas as linhas: tabelas de seno e cosseno calculadas uma vez
+    std::vector<float> sinPhi(width), cosPhi(width);
+    for (int x = 0; x < width; ++x)
+    {
+        float phi = 2.0f * PI * (x + 0.5f) / width - PI;
+        sinPhi[x] = std::sin(phi);
+        cosPhi[x] = std::cos(phi);
+    }
+    float texelArea = (2.0f * PI / width) * (PI / height);
+
+    // Cada tarefa soma uma faixa de linhas; as parciais são somadas em ordem fixa no fim
+    int tasks = (height + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    std::vector<double> partial((size_t)tasks * SH_COEFFICIENTS * 3, 0.0);
+
+    JobSystem& jobs = jobs_ ? *jobs_ : JobSystem::shared();
+    jobs.parallelFor(tasks, [&](int task) {
+        double* sums = &partial[(size_t)task * SH_COEFFICIENTS * 3];
+        int rowEnd = std::min(height, (task + 1) * ROWS_PER_TASK);
+        for (int y = task * ROWS_PER_TASK; y < rowEnd; ++y)
+        {
+            // Ângulo sólido do texel: proporcional a sen(θ)
+            float theta = PI * (y + 0.5f) / height;
+            float sinTheta = std::sin(theta), cosTheta = std::cos(theta);
+            float weight = texelArea * sinTheta;
+            const float* row = rgb + (size_t)y * width * 3;
+            float rowSums[SH_COEFFICIENTS * 3] = {};
+            int x = 0;
+
+#ifdef ENVIRONMENT_USE_SSE
+            __m128 accum[SH_COEFFICIENTS * 3];
+            for (int i = 0; i < SH_COEFFICIENTS * 3; ++i)
+                accum[i] = _mm_setzero_ps();
+            const __m128 sinThetaV = _mm_set1_ps(sinTheta);
+            const __m128 dy = _mm_set1_ps(cosTheta);
+            for (; x + 4 <= width; x += 4)
+            {
+                __m128 dx = _mm_mul_ps(sinThetaV, _mm_loadu_ps(&sinPhi[x]));
+                __m128 dz = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sinThetaV, _mm_loadu_ps(&cosPhi[x])));
+                __m128 b[SH_COEFFICIENTS] = {
+                    _mm_set1_ps(1.0f), dy, dz, dx,
+                    _mm_mul_ps(dx, dy), _mm_mul_ps(dy, dz),
+                    _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(dz, dz)), _mm_set1_ps(1.0f)),
+                    _mm_mul_ps(dx, dz),
+                    _mm_sub_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                };
+                const float* p = row + x * 3;
+                __m128 color[3] = {
+                    _mm_setr_ps(p[0], p[3], p[6], p[9]),
+                    _mm_setr_ps(p[1], p[4], p[7], p[10]),
+                    _mm_setr_ps(p[2], p[5], p[8], p[11]),
+                };
+                for (int i = 0; i < SH_COEFFICIENTS; ++i)
+                    for (int c = 0; c < 3; ++c)
+                        accum[i * 3 + c] = _mm_add_ps(accum[i * 3 + c], _mm_mul_ps(b[i], color[c]));
+            }
+            for (int i = 0; i < SH_COEFFICIENTS * 3; ++i)
+                rowSums[i] = horizontalSum(accum[i]);
+#endif
+            for (; x < width; ++x)
+            {
+                float b[SH_COEFFICIENTS];
+                basis(sinTheta * sinPhi[x], cosTheta, -sinTheta * cosPhi[x], b);
+                const float* p = row + x * 3;
+                for (int i = 0; i < SH_COEFFICIENTS; ++i)
+                    for (int c = 0; c < 3; ++c)
+                        rowSums[i * 3 + c] += b[i] * p[c];
+            }
+
+            for (int i = 0; i < SH_COEFFICIENTS * 3; ++i)
+                sums[i] += (double)rowSums[i] * weight;
+        }
+    });
+
+    for (int i = 0; i < SH_COEFFICIENTS; ++i)
+    {
+        double total[3] = { 0.0, 0.0, 0.0 };
+        for (int task = 0; task < tasks; ++task)
+            for (int c = 0; c < 3; ++c)
+                total[c] += partial[((size_t)task * SH_COEFFICIENTS + i) * 3 + c];
+        coefficients_[i] = glm::vec3((float)total[0], (float)total[1], (float)total[2]) * (COEFFICIENT_SCALE[i] * intensity);
+    }
+    loaded_ = true;
+    projectMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+glm::vec3 EnvironmentLighting::evaluate(const glm::vec3& normal) const
+{
+    float b[SH_COEFFICIENTS];
+    basis(normal.x, normal.y, normal.z, b);
+    glm::vec3 result(0.0f);
+    for (int i = 0; i < SH_COEFFICIENTS; ++i)
+        result += coefficients_[i] * b[i];
+    return glm::max(result, glm::vec3(0.0f));
+}
@@ -0,0 +1,256 @@
+#include "FrameCapture.h"
+#include "GpuResources.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+FrameCapture::FrameCapture() :
+    width_(0), height_(0), head_(0), resource_(-1), maxQueued_(0), busyEncoders_(0), stopping_(false),
+    written_(0), captureMs_(0.0), captureSamples_(0)
+{
+}
+
+// Não espera leituras pendentes (o contexto pode já ter sido destruído); chame flush() antes
+FrameCapture::~FrameCapture()
+{
+    release();
+}
+
+void FrameCapture::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& encoder : encoders_)
+        encoder.join();
+    encoders_.clear();
+
+    for (auto& slot : slots_)
+    {
+        if (slot.fence) glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.pbo);
+    }
+    slots_.clear();
+    GpuResources::instance().remove(resource_);
+    resource_ = -1;
+}
+
+bool FrameCapture::initialize(int width, int height, int ringSize, unsigned int encoderThreads)
+{
+    if (!encoders_.empty())
+        flush();
+    release();
+
+    width_ = width;
+    height_ = height;
+    head_ = 0;
+    stopping_ = false;
+
+    // ringSize = 0: sem PBOs, só os encoders (imagens vindas da CPU por write())
+    slots_.resize(ringSize <= 0 ? 0 : (ringSize < 2 ? 2 : ringSize));
+    for (auto& slot : slots_)
+    {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, nullptr, GL_STREAM_READ);
+        slot.fence = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!slots_.empty())
+        resource_ = GpuResources::instance().add(GpuCategory::Buffer, slots_.size() * width * height * 4);
+
+    if (encoderThreads == 0)
+    {
+        encoderThreads = std::thread::hardware_concurrency() / 2;
+        if (encoderThreads == 0) encoderThreads = 1;
+    }
+    // Limita a memória quando o encoder não acompanha o render: capture() passa a esperar
+    maxQueued_ = encoderThreads * 2;
+    for (unsigned int i = 0; i < encoderThreads; ++i)
+        encoders_.emplace_back(&FrameCapture::encoderLoop, this);
+
+    return true;
+}
+
+void FrameCapture::capture(GLuint framebuffer, const std::string& path)
+{
+    if (slots_.empty())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    poll();
+
+    // Anel cheio: a leitura mais antiga precisa sair antes de reaproveitar o PBO
+    Slot& slot = slots_[head_];
+    if (slot.fence)
+    {
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+        readback(slot);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    if (framebuffer == 0)
+        glReadBuffer(GL_BACK);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.path = path;
+    head_ = (head_ + 1) % (int)slots_.size();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ++captureSamples_;
+    captureMs_ += (ms - captureMs_) / captureSamples_;
+}
+
+void FrameCapture::poll()
+{
+    // Percorre do mais antigo para o mais novo e para no primeiro que a GPU ainda não terminou
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+        Slot& slot = slots_[(head_ + i) % slots_.size()];
+        if (!slot.fence) continue;
+
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        readback(slot);
+    }
+}
+
+void FrameCapture::flush()
+{
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+        Slot& slot = slots_[(head_ + i) % slots_.size()];
+        if (!slot.fence) continue;
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+        readback(slot);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && busyEncoders_ == 0; });
+}
+
+void FrameCapture::readback(Slot& slot)
+{
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+
+    size_t bytes = (size_t)width_ * height_ * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const unsigned char* mapped = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    EncodeJob job;
+    if (mapped)
+    {
+        job = makeJob(slot.path, mapped);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (mapped)
+        submit(std::move(job));
+    else
+        std::cerr << "FrameCapture: falha ao mapear o PBO de " << slot.path << std::endl;
+}
+
+void FrameCapture::write(const std::string& path, const unsigned char* bottomUpPixels)
+{
+    submit(makeJob(path, bottomUpPixels));
+}
+
+FrameCapture::EncodeJob FrameCapture::makeJob(const std::string& path, const unsigned char* bottomUpPixels) const
+{
+    EncodeJob job;
+    job.path = path;
+    job.pixels.resize((size_t)width_ * height_ * 4);
+
+    // A OpenGL entrega as linhas de baixo para cima; as imagens são gravadas de cima para baixo
+    size_t rowBytes = (size_t)width_ * 4;
+    for (int y = 0; y < height_; ++y)
+        memcpy(&job.pixels[(size_t)(height_ - 1 - y) * rowBytes], bottomUpPixels + (size_t)y * rowBytes, rowBytes);
+    return job;
+}
+
+void FrameCapture::submit(EncodeJob&& job)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.size() < maxQueued_; });
+    queue_.push_back(std::move(job));
+    lock.unlock();
+    wake_.notify_one();
+}
+
+void FrameCapture::encoderLoop()
+{
+    for (;;)
+    {
+        EncodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty())
+                return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            ++busyEncoders_;
+        }
+        idle_.notify_all();
+
+        if (writeImage(job))
+            ++written_;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busyEncoders_;
+        }
+        idle_.notify_all();
+    }
+}
+
+bool FrameCapture::writeImage(const EncodeJob& job) const
+{
+    bool ok;
+    size_t dot = job.path.find_last_of('.');
+    std::string extension = (dot == std::string::npos) ? "" : job.path.substr(dot);
+    if (extension == ".ppm")
+    {
+        // PPM binário: sem compressão, bem mais rápido de gravar que PNG
+        FILE* file = fopen(job.path.c_str(), "wb");
+        ok = file != nullptr;
+        if (file)
+        {
+            fprintf(file, "P6\n%d %d\n255\n", width_, height_);
+            std::vector<unsigned char> row((size_t)width_ * 3);
+            for (int y = 0; y < height_ && ok; ++y)
+            {
+                const unsigned char* src = &job.pixels[(size_t)y * width_ * 4];
+                for (int x = 0; x < width_; ++x)
+                {
+                    row[x * 3 + 0] = src[x * 4 + 0];
+                    row[x * 3 + 1] = src[x * 4 + 1];
+                    row[x * 3 + 2] = src[x * 4 + 2];
+                }
+                ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+            }
+            fclose(file);
+        }
+    }
+    else
+    {
+        ok = stbi_write_png(job.path.c_str(), width_, height_, 4, job.pixels.data(), width_ * 4) != 0;
+    }
+
+    if (!ok)
+        std::cerr << "FrameCapture: falha ao gravar " << job.path << std::endl;
+    return ok;
+}
@@ -0,0 +1,179 @@
+#include "FrameRing.h"
+#include "GLExtensions.h"
+#include "GpuResources.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+    size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+FrameRing::FrameRing() :
+    buffer_(0), mapped_(nullptr), frameBytes_(0), alignment_(256), segment_(0), head_(0), flushed_(0),
+    orphaned_(false), overflowed_(false), resource_(-1), peakBytes_(0), waits_(0), waitMs_(0.0), overflows_(0)
+{
+    std::fill(fences_, fences_ + FRAMES, (GLsync)0);
+}
+
+FrameRing::~FrameRing()
+{
+    release();
+}
+
+bool FrameRing::initialize(size_t frameBytes)
+{
+    release();
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment_ = std::max<size_t>(alignment, 16);
+    return create(frameBytes);
+}
+
+void FrameRing::release()
+{
+    for (int i = 0; i < FRAMES; ++i)
+        wait(i);
+    destroy();
+}
+
+bool FrameRing::create(size_t frameBytes)
+{
+    frameBytes_ = alignUp(std::max<size_t>(frameBytes, alignment_), alignment_);
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    if (GLExtensions::hasBufferStorage())
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLExtensions::BufferStorage(GL_UNIFORM_BUFFER, (GLsizeiptr)(frameBytes_ * FRAMES), nullptr, flags);
+        mapped_ = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)(frameBytes_ * FRAMES), flags));
+        if (!mapped_)
+        {
+            // O storage imutável não aceita glBufferData: o fallback precisa de outro buffer
+            std::cerr << "FrameRing: mapeamento persistente indisponível, usando orphaning" << std::endl;
+            glDeleteBuffers(1, &buffer_);
+            glGenBuffers(1, &buffer_);
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+        }
+    }
+    if (!mapped_)
+    {
+        glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)frameBytes_, nullptr, GL_STREAM_DRAW);
+        shadow_.resize(frameBytes_);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    resource_ = GpuResources::instance().add(GpuCategory::Buffer, mapped_ ? frameBytes_ * FRAMES : frameBytes_);
+    segment_ = 0;
+    head_ = flushed_ = 0;
+    orphaned_ = false;
+    overflowed_ = false;
+    return buffer_ != 0;
+}
+
+void FrameRing::destroy()
+{
+    if (buffer_)
+    {
+        if (mapped_)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &buffer_);
+    }
+    GpuResources::instance().remove(resource_);
+    buffer_ = 0;
+    mapped_ = nullptr;
+    shadow_.clear();
+    shadow_.shrink_to_fit();
+    resource_ = -1;
+}
+
+void FrameRing::wait(int segment)
+{
+    GLsync& fence = fences_[segment];
+    if (!fence)
+        return;
+    // Consulta sem espera primeiro: só conta como espera se a GPU estiver FRAMES frames atrás
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+        auto start = std::chrono::steady_clock::now();
+        do
+        {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        ++waits_;
+        waitMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+void FrameRing::beginFrame()
+{
+    if (!buffer_)
+        return;
+    // O frame anterior não coube: espera a GPU soltar todos os segmentos e recria com o dobro
+    if (overflowed_)
+    {
+        size_t frameBytes = frameBytes_ * 2;
+        release();
+        create(frameBytes);
+    }
+    segment_ = (segment_ + 1) % FRAMES;
+    if (mapped_)
+        wait(segment_);
+    head_ = flushed_ = 0;
+    orphaned_ = false;
+}
+
+FrameRing::Allocation FrameRing::allocate(size_t bytes, size_t alignment)
+{
+    Allocation allocation;
+    size_t offset = alignUp(head_, alignment > 0 ? alignment : alignment_);
+    if (!buffer_ || offset + bytes > frameBytes_)
+    {
+        overflowed_ = true;
+        ++overflows_;
+        return allocation;
+    }
+    head_ = offset + bytes;
+    peakBytes_ = std::max(peakBytes_, head_);
+
+    // Com orphaning cada frame tem o buffer inteiro, sempre a partir do início
+    size_t base = mapped_ ? (size_t)segment_ * frameBytes_ : 0;
+    allocation.data = (mapped_ ? mapped_ + base : shadow_.data()) + offset;
+    allocation.offset = (GLintptr)(base + offset);
+    allocation.size = (GLsizeiptr)bytes;
+    return allocation;
+}
+
+void FrameRing::flush()
+{
+    if (mapped_ || head_ == flushed_)
+        return;
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    if (!orphaned_)
+    {
+        glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)frameBytes_, nullptr, GL_STREAM_DRAW);
+        orphaned_ = true;
+    }
+    glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)flushed_, (GLsizeiptr)(head_ - flushed_), shadow_.data() + flushed_);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    flushed_ = head_;
+}
+
+void FrameRing::endFrame()
+{
+    if (!buffer_)
+        return;
+    flush();
+    if (mapped_)
+        fences_[segment_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,99 @@
+#include "GLExtensions.h"
+#include <unordered_set>
+
+namespace GLExtensions
+{
+    PFNGLEXTGETPROGRAMBINARYPROC GetProgramBinary = nullptr;
+    PFNGLEXTPROGRAMBINARYPROC ProgramBinary = nullptr;
+    PFNGLEXTPROGRAMPARAMETERIPROC ProgramParameteri = nullptr;
+    PFNGLEXTMAXSHADERCOMPILERTHREADSPROC MaxShaderCompilerThreads = nullptr;
+    PFNGLEXTBUFFERSTORAGEPROC BufferStorage = nullptr;
+
+    namespace {
+        bool initialized = false;
+        int versionMajor = 0;
+        int versionMinor = 0;
+        std::unordered_set<std::string> extensions;
+        bool programBinary = false;
+        bool parallelShaderCompile = false;
+        bool bufferStorage = false;
+        bool textureCompressionS3TC = false;
+    }
+
+    bool initialize(GLADloadproc loader)
+    {
+        if (!loader) return false;
+
+        glGetIntegerv(GL_MAJOR_VERSION, &versionMajor);
+        glGetIntegerv(GL_MINOR_VERSION, &versionMinor);
+
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        extensions.clear();
+        for (GLint i = 0; i < count; ++i)
+            extensions.insert(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)));
+
+        if (hasVersion(4, 1) || isSupported("GL_ARB_get_program_binary"))
+        {
+            GetProgramBinary = (PFNGLEXTGETPROGRAMBINARYPROC)loader("glGetProgramBinary");
+            ProgramBinary = (PFNGLEXTPROGRAMBINARYPROC)loader("glProgramBinary");
+            ProgramParameteri = (PFNGLEXTPROGRAMPARAMETERIPROC)loader("glProgramParameteri");
+
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            programBinary = GetProgramBinary && ProgramBinary && ProgramParameteri && formats > 0;
+        }
+
+        if (isSupported("GL_KHR_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (PFNGLEXTMAXSHADERCOMPILERTHREADSPROC)loader("glMaxShaderCompilerThreadsKHR");
+        else if (isSupported("GL_ARB_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (PFNGLEXTMAXSHADERCOMPILERTHREADSPROC)loader("glMaxShaderCompilerThreadsARB");
+        parallelShaderCompile = MaxShaderCompilerThreads != nullptr;
+        if (parallelShaderCompile)
+            MaxShaderCompilerThreads(0xFFFFFFFF); // o driver escolhe quantas threads usar
+
+        if (hasVersion(4, 4) || isSupported("GL_ARB_buffer_storage"))
+            BufferStorage = (PFNGLEXTBUFFERSTORAGEPROC)loader("glBufferStorage");
+        bufferStorage = BufferStorage != nullptr;
+
+        textureCompressionS3TC = isSupported("GL_EXT_texture_compression_s3tc");
+
+        initialized = true;
+        return true;
+    }
+
+    bool isInitialized()
+    {
+        return initialized;
+    }
+
+    bool isSupported(const std::string& extension)
+    {
+        return extensions.count(extension) != 0;
+    }
+
+    bool hasVersion(int major, int minor)
+    {
+        return versionMajor > major || (versionMajor == major && versionMinor >= minor);
+    }
+
+    bool hasProgramBinary()
+    {
+        return programBinary;
+    }
+
+    bool hasParallelShaderCompile()
+    {
+        return parallelShaderCompile;
+    }
+
+    bool hasBufferStorage()
+    {
+        return bufferStorage;
+    }
+
+    bool hasTextureCompressionS3TC()
+    {
+        return textureCompressionS3TC;
+    }
+}
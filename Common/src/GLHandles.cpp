@@ -0,0 +1,180 @@
+#include "GLHandles.h"
+#include "GpuResources.h"
+
+GLuint GLVertexArrayTraits::create()
+{
+    GLuint id = 0;
+    glGenVertexArrays(1, &id);
+    return id;
+}
+
+void GLVertexArrayTraits::destroy(GLuint id)
+{
+    glDeleteVertexArrays(1, &id);
+}
+
+GLuint GLTextureTraits::create()
+{
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    return id;
+}
+
+void GLTextureTraits::destroy(GLuint id)
+{
+    glDeleteTextures(1, &id);
+}
+
+GLuint GLProgramTraits::create()
+{
+    return glCreateProgram();
+}
+
+void GLProgramTraits::destroy(GLuint id)
+{
+    glDeleteProgram(id);
+}
+
+GLBuffer::GLBuffer(GLBuffer&& other) noexcept : id_(other.id_), capacity_(other.capacity_)
+{
+    other.id_ = 0;
+    other.capacity_ = 0;
+}
+
+GLBuffer& GLBuffer::operator=(GLBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        id_ = other.id_;
+        capacity_ = other.capacity_;
+        other.id_ = 0;
+        other.capacity_ = 0;
+    }
+    return *this;
+}
+
+GLBuffer GLBuffer::create(size_t bytes, const void* data)
+{
+    GLBuffer buffer;
+    buffer.capacity_ = GLBufferPool::bucketSize(bytes);
+    buffer.id_ = GLBufferPool::instance().acquire(buffer.capacity_);
+    if (data && bytes > 0)
+        buffer.upload(bytes, data);
+    return buffer;
+}
+
+void GLBuffer::upload(size_t bytes, const void* data)
+{
+    if (bytes > capacity_ || id_ == 0)
+    {
+        *this = create(bytes, data);
+        return;
+    }
+    // GL_COPY_WRITE_BUFFER não mexe nos vínculos de GL_ARRAY_BUFFER nem no do VAO atual
+    glBindBuffer(GL_COPY_WRITE_BUFFER, id_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)bytes, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GLBuffer::reset()
+{
+    if (id_ != 0)
+        GLBufferPool::instance().recycle(id_, capacity_);
+    id_ = 0;
+    capacity_ = 0;
+}
+
+void GLBuffer::destroy()
+{
+    if (id_ != 0)
+        glDeleteBuffers(1, &id_);
+    id_ = 0;
+    capacity_ = 0;
+}
+
+GLBufferPool::GLBufferPool() :
+    pooledBytes_(0), maxPooledBytes_((size_t)64 << 20), hits_(0), misses_(0), resource_(-1)
+{
+}
+
+GLBufferPool& GLBufferPool::instance()
+{
+    static GLBufferPool pool;
+    return pool;
+}
+
+size_t GLBufferPool::bucketSize(size_t bytes)
+{
+    size_t power = 256;
+    while (power < bytes)
+        power <<= 1;
+    if (power == 256)
+        return power;
+    // Entre power / 2 e power, em passos de power / 8
+    size_t bucket = power / 2;
+    while (bucket < bytes)
+        bucket += power / 8;
+    return bucket;
+}
+
+GLuint GLBufferPool::acquire(size_t capacity)
+{
+    auto it = free_.find(capacity);
+    if (it != free_.end() && !it->second.empty())
+    {
+        GLuint id = it->second.back();
+        it->second.pop_back();
+        pooledBytes_ -= capacity;
+        ++hits_;
+        track();
+        return id;
+    }
+
+    GLuint id = 0;
+    glGenBuffers(1, &id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    ++misses_;
+    return id;
+}
+
+void GLBufferPool::recycle(GLuint id, size_t capacity)
+{
+    if (pooledBytes_ + capacity > maxPooledBytes_)
+    {
+        glDeleteBuffers(1, &id);
+        return;
+    }
+    free_[capacity].push_back(id);
+    pooledBytes_ += capacity;
+    track();
+}
+
+void GLBufferPool::clear()
+{
+    for (auto& bucket : free_)
+    {
+        if (!bucket.second.empty())
+            glDeleteBuffers((GLsizei)bucket.second.size(), bucket.second.data());
+    }
+    free_.clear();
+    pooledBytes_ = 0;
+    GpuResources::instance().resize(resource_, 0);
+}
+
+// Os livres contam como um recurso despejável: despejar apaga todos, "recarregar" só volta a contar
+void GLBufferPool::track()
+{
+    GpuResources& resources = GpuResources::instance();
+    if (resource_ < 0)
+    {
+        resource_ = resources.add(GpuCategory::Buffer, pooledBytes_,
+            [this]() { clear(); },
+            [this]() { return pooledBytes_; });
+        return;
+    }
+    resources.use(resource_);
+    resources.resize(resource_, pooledBytes_);
+}
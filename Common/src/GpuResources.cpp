@@ -0,0 +1,170 @@
+#include "GpuResources.h"
+#include <algorithm>
+#include <cstdio>
+
+GpuGeometry::~GpuGeometry()
+{
+    GpuResources::instance().remove(resource);
+}
+
+void GpuGeometry::destroy()
+{
+    vao.reset();
+    for (GLBuffer& buffer : buffers)
+        buffer.destroy();
+    buffers.clear();
+}
+
+GpuResources::GpuResources() :
+    budget_(0), peakBytes_(0), frame_(0), count_(0), evictions_(0), reloads_(0)
+{
+    std::fill(bytes_, bytes_ + (int)GpuCategory::Count, (size_t)0);
+}
+
+GpuResources& GpuResources::instance()
+{
+    static GpuResources resources;
+    return resources;
+}
+
+const char* GpuResources::categoryName(GpuCategory category)
+{
+    switch (category)
+    {
+    case GpuCategory::Geometry: return "geometria";
+    case GpuCategory::Texture: return "texturas";
+    case GpuCategory::Lightmap: return "lightmaps";
+    case GpuCategory::RenderTarget: return "render targets";
+    case GpuCategory::Buffer: return "buffers";
+    default: return "?";
+    }
+}
+
+void GpuResources::addBytes(GpuCategory category, size_t bytes)
+{
+    bytes_[(int)category] += bytes;
+    peakBytes_ = std::max(peakBytes_, getTotalBytes());
+}
+
+size_t GpuResources::getTotalBytes() const
+{
+    size_t total = 0;
+    for (int i = 0; i < (int)GpuCategory::Count; ++i)
+        total += bytes_[i];
+    return total;
+}
+
+int GpuResources::add(GpuCategory category, size_t bytes, Evict evict, Reload reload)
+{
+    Entry entry = { category, bytes, std::move(evict), std::move(reload), true, true, frame_ };
+    int id;
+    if (!free_.empty())
+    {
+        id = free_.back();
+        free_.pop_back();
+        entries_[id] = std::move(entry);
+    }
+    else
+    {
+        id = (int)entries_.size();
+        entries_.push_back(std::move(entry));
+    }
+    ++count_;
+    addBytes(category, bytes);
+    return id;
+}
+
+void GpuResources::resize(int id, size_t bytes)
+{
+    if (id < 0) return;
+    Entry& entry = entries_[id];
+    if (entry.resident)
+    {
+        bytes_[(int)entry.category] -= entry.bytes;
+        addBytes(entry.category, bytes);
+    }
+    entry.bytes = bytes;
+}
+
+void GpuResources::remove(int id)
+{
+    if (id < 0 || !entries_[id].active) return;
+    Entry& entry = entries_[id];
+    if (entry.resident)
+        bytes_[(int)entry.category] -= entry.bytes;
+    entry = Entry();
+    entry.active = false;
+    free_.push_back(id);
+    --count_;
+}
+
+void GpuResources::use(int id)
+{
+    if (id < 0) return;
+    Entry& entry = entries_[id];
+    entry.lastUse = frame_;
+    if (!entry.resident)
+    {
+        entry.bytes = entry.reload();
+        entry.resident = true;
+        addBytes(entry.category, entry.bytes);
+        ++reloads_;
+    }
+}
+
+void GpuResources::endFrame()
+{
+    if (budget_ > 0 && getTotalBytes() > budget_)
+    {
+        // Só o que não foi usado neste frame: o que acabou de ser desenhado volta já no próximo
+        std::vector<int> candidates;
+        for (int id = 0; id < (int)entries_.size(); ++id)
+        {
+            const Entry& entry = entries_[id];
+            if (entry.active && entry.resident && entry.reload && entry.lastUse < frame_)
+                candidates.push_back(id);
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](int a, int b) { return entries_[a].lastUse < entries_[b].lastUse; });
+        for (int id : candidates)
+        {
+            if (getTotalBytes() <= budget_) break;
+            Entry& entry = entries_[id];
+            entry.evict();
+            entry.resident = false;
+            bytes_[(int)entry.category] -= entry.bytes;
+            ++evictions_;
+        }
+    }
+    ++frame_;
+}
+
+std::string GpuResources::describe() const
+{
+    const double MB = 1024.0 * 1024.0;
+    char line[96];
+    std::string text;
+    if (budget_ > 0)
+        snprintf(line, sizeof(line), "%.1f MB de %.0f MB (", getTotalBytes() / MB, budget_ / MB);
+    else
+        snprintf(line, sizeof(line), "%.1f MB, sem orçamento (", getTotalBytes() / MB);
+    text = line;
+    for (int i = 0; i < (int)GpuCategory::Count; ++i)
+    {
+        snprintf(line, sizeof(line), "%s%s %.1f", i > 0 ? ", " : "", categoryName((GpuCategory)i), bytes_[i] / MB);
+        text += line;
+    }
+    snprintf(line, sizeof(line), "), %d recursos, pico %.1f MB, %d despejos, %d recargas",
+             count_, peakBytes_ / MB, evictions_, reloads_);
+    return text + line;
+}
+
+void GpuResources::clearTexture(GLuint texture)
+{
+    GLint maxLevel = 0;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+    // MAX_LEVEL começa em 1000: só até o último nível que existe
+    for (int level = 0; level <= std::min(maxLevel, 16); ++level)
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,69 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer() : current_(0), active_(false), averageMs_(0.0)
+{
+    for (int i = 0; i < QUERY_COUNT; ++i)
+    {
+        queries_[i] = 0;
+        pending_[i] = false;
+    }
+}
+
+GpuTimer::~GpuTimer()
+{
+    release();
+}
+
+void GpuTimer::release()
+{
+    if (queries_[0] != 0)
+        glDeleteQueries(QUERY_COUNT, queries_);
+    for (int i = 0; i < QUERY_COUNT; ++i)
+    {
+        queries_[i] = 0;
+        pending_[i] = false;
+    }
+    current_ = 0;
+    active_ = false;
+}
+
+void GpuTimer::begin()
+{
+    if (queries_[0] == 0)
+        glGenQueries(QUERY_COUNT, queries_);
+
+    collect();
+
+    // Se a query do slot ainda não voltou, descarta a medição deste frame
+    if (pending_[current_]) return;
+    glBeginQuery(GL_TIME_ELAPSED, queries_[current_]);
+    pending_[current_] = true;
+    active_ = true;
+}
+
+void GpuTimer::end()
+{
+    if (!active_) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    active_ = false;
+    current_ = (current_ + 1) % QUERY_COUNT;
+}
+
+void GpuTimer::collect()
+{
+    for (int i = 0; i < QUERY_COUNT; ++i)
+    {
+        if (!pending_[i]) continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries_[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(queries_[i], GL_QUERY_RESULT, &elapsedNs);
+        pending_[i] = false;
+
+        double ms = elapsedNs / 1.0e6;
+        averageMs_ = (averageMs_ == 0.0) ? ms : averageMs_ * 0.9 + ms * 0.1;
+    }
+}
@@ -0,0 +1,314 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+struct alignas(64) JobSystem::Job
+{
+    Function function;
+    const void* data;
+    int begin;
+    int end;
+    Job* parent;
+    // O próprio job mais os filhos ainda não terminados
+    std::atomic<int> unfinished;
+};
+
+// Deque de Chase-Lev com capacidade fixa (Lê, Pop, Cohen e Nardelli, "Correct and Efficient
+// Work-Stealing for Weak Memory Models", 2013). push e pop só no thread dono, steal em qualquer um
+class JobSystem::WorkQueue
+{
+public:
+    WorkQueue() : top_(0), bottom_(0)
+    {
+        for (auto& entry : buffer_)
+            entry.store(nullptr, std::memory_order_relaxed);
+    }
+
+    bool push(Job* job)
+    {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= JOBS_PER_THREAD)
+            return false;
+        buffer_[bottom & MASK].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* pop()
+    {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+        if (top > bottom)
+        {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Job* job = buffer_[bottom & MASK].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // Último elemento: disputa com os ladrões pelo topo
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* steal()
+    {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom)
+            return nullptr;
+        Job* job = buffer_[top & MASK].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+private:
+    static const int64_t MASK = JOBS_PER_THREAD - 1;
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    std::atomic<Job*> buffer_[JOBS_PER_THREAD];
+};
+
+namespace {
+    std::atomic<uint64_t> nextSerial(1);
+
+    void forRange(const void* data, int begin, int end)
+    {
+        const std::function<void(int)>& fn = *static_cast<const std::function<void(int)>*>(data);
+        for (int i = begin; i < end; ++i)
+            fn(i);
+    }
+}
+
+JobSystem::JobSystem(unsigned int threadCount) :
+    slotCount_(0), serial_(nextSerial++), queued_(0), sleeping_(0), stopping_(false), steals_(0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 4;
+    }
+    threadCount = std::min<unsigned int>(threadCount, MAX_THREADS);
+
+    for (unsigned int i = 1; i < threadCount; ++i)
+        workers_.emplace_back(&JobSystem::workerLoop, this);
+}
+
+JobSystem::~JobSystem()
+{
+    stopping_ = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+JobSystem& JobSystem::shared()
+{
+    static JobSystem jobs;
+    return jobs;
+}
+
+// Deque do thread atual neste sistema; -1 se já há MAX_THREADS threads (o thread trabalha sozinho)
+int JobSystem::currentSlot()
+{
+    thread_local uint64_t cachedSerial = 0;
+    thread_local int cachedSlot = -1;
+    if (cachedSerial == serial_)
+        return cachedSlot;
+
+    std::lock_guard<std::mutex> lock(slotMutex_);
+    auto it = threadSlots_.find(std::this_thread::get_id());
+    int slot = it != threadSlots_.end() ? it->second : claimSlot();
+    cachedSerial = serial_;
+    cachedSlot = slot;
+    return slot;
+}
+
+int JobSystem::claimSlot()
+{
+    int slot = slotCount_.load(std::memory_order_relaxed);
+    if (slot >= MAX_THREADS)
+        slot = -1;
+    else
+    {
+        slots_[slot].reset(new WorkQueue());
+        // Os ladrões só olham até slotCount_: a deque já existe quando o novo valor aparece
+        slotCount_.store(slot + 1, std::memory_order_release);
+    }
+    threadSlots_[std::this_thread::get_id()] = slot;
+    return slot;
+}
+
+JobSystem::Job* JobSystem::create(Function function, const void* data, int begin, int end, Job* parent)
+{
+    // Anel por thread, não por sistema: um thread pode publicar em mais de um JobSystem
+    thread_local std::unique_ptr<Job[]> ring;
+    thread_local unsigned int next = 0;
+    if (!ring)
+    {
+        ring.reset(new Job[JOBS_PER_THREAD]);
+        for (int i = 0; i < JOBS_PER_THREAD; ++i)
+            ring[i].unfinished.store(0, std::memory_order_relaxed);
+    }
+
+    // Pula os que ainda estão pendentes (raízes de parallelFor aninhados, por exemplo); com o anel
+    // inteiro pendente, trabalha até o próximo sair
+    Job* job = &ring[next++ & (JOBS_PER_THREAD - 1)];
+    for (int skipped = 1; job->unfinished.load(std::memory_order_acquire) > 0; ++skipped)
+    {
+        if (skipped == JOBS_PER_THREAD)
+        {
+            wait(job);
+            break;
+        }
+        job = &ring[next++ & (JOBS_PER_THREAD - 1)];
+    }
+    job->function = function;
+    job->data = data;
+    job->begin = begin;
+    job->end = end;
+    job->parent = parent;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    if (parent)
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::run(Job* job)
+{
+    int slot = currentSlot();
+    if (slot < 0 || !slots_[slot]->push(job))
+    {
+        execute(job);
+        return;
+    }
+    queued_.fetch_add(1);
+    if (sleeping_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+void JobSystem::wait(Job* job)
+{
+    int slot = currentSlot();
+    while (job->unfinished.load(std::memory_order_acquire) > 0)
+    {
+        Job* next = getJob(slot);
+        if (next)
+            execute(next);
+        else
+            std::this_thread::yield();
+    }
+}
+
+JobSystem::Job* JobSystem::getJob(int slot)
+{
+    if (slot >= 0)
+    {
+        Job* job = slots_[slot]->pop();
+        if (job)
+        {
+            queued_.fetch_sub(1);
+            return job;
+        }
+    }
+
+    // Vítimas a partir de uma posição pseudoaleatória, para os ladrões não disputarem a mesma deque
+    thread_local uint32_t random = 2463534242u;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    int count = slotCount_.load(std::memory_order_acquire);
+    for (int k = 0; k < count; ++k)
+    {
+        int victim = (int)((random + k) % (uint32_t)count);
+        if (victim == slot)
+            continue;
+        Job* job = slots_[victim]->steal();
+        if (job)
+        {
+            queued_.fetch_sub(1);
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job)
+{
+    if (job->function)
+        job->function(job->data, job->begin, job->end);
+    finish(job);
+}
+
+void JobSystem::finish(Job* job)
+{
+    // parent lido antes: com a contagem em zero quem espera já pode reaproveitar o job
+    Job* parent = job->parent;
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1 && parent)
+        finish(parent);
+}
+
+void JobSystem::workerLoop()
+{
+    int slot = currentSlot();
+    int idle = 0;
+    while (!stopping_.load())
+    {
+        Job* job = getJob(slot);
+        if (job)
+        {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+        // Algumas voltas antes de dormir: entre os parallelFor de um frame a espera é curta
+        if (++idle < 64)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.fetch_add(1);
+        wake_.wait(lock, [this] { return stopping_.load() || queued_.load() > 0; });
+        sleeping_.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+void JobSystem::parallelFor(int count, const std::function<void(int)>& fn, int grain)
+{
+    if (count <= 0) return;
+
+    int chunk = grain > 0 ? grain : std::max(1, count / (int)(getThreadCount() * 4));
+    // No máximo um quarto do anel por chamada, para sobrar para os parallelFor aninhados
+    chunk = std::max(chunk, (count + JOBS_PER_THREAD / 4 - 1) / (JOBS_PER_THREAD / 4));
+    if (workers_.empty() || count <= chunk || currentSlot() < 0)
+    {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    // A raiz não faz nada: só junta os blocos. finish tira a contagem dela mesma, e wait executa
+    // blocos (deste thread ou roubados) até os filhos terminarem
+    Job* root = create(nullptr, nullptr);
+    for (int begin = 0; begin < count; begin += chunk)
+        run(create(&forRange, &fn, begin, std::min(begin + chunk, count), root));
+    finish(root);
+    wait(root);
+}
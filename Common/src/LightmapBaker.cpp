@@ -0,0 +1,462 @@
+#include "LightmapBaker.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x4D4C4356; // "VCLM"
+    const uint32_t CACHE_VERSION = 1;
+    const int ROWS_PER_TASK = 16;
+    // Triângulos vizinhos entram no mesmo chart se a normal estiver a menos de 45° da do chart
+    const float CHART_NORMAL_COS = 0.7071f;
+    // Fração do atlas que a primeira tentativa de escala tenta ocupar
+    const float TARGET_FILL = 0.7f;
+    const int MAX_PACK_ATTEMPTS = 40;
+    const float SURFACE_OFFSET = 1e-3f;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    void fnv1a(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    struct PositionHash {
+        size_t operator()(const glm::vec3& p) const
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            fnv1a(hash, &p, sizeof(p));
+            return (size_t)hash;
+        }
+    };
+
+    struct PositionEqual {
+        bool operator()(const glm::vec3& a, const glm::vec3& b) const { return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0; }
+    };
+
+    void orthonormalBasis(const glm::vec3& n, glm::vec3& tangent, glm::vec3& bitangent)
+    {
+        float sign = std::copysign(1.0f, n.z);
+        float a = -1.0f / (sign + n.z);
+        float b = n.x * n.y * a;
+        tangent = glm::vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+        bitangent = glm::vec3(b, sign + n.y * n.y * a, -n.y);
+    }
+
+    // Texel vazio recebe a média dos vizinhos cobertos; repetido, espalha a borda dos charts pela margem
+    void dilate(std::vector<float>& texels, std::vector<unsigned char>& covered, int width, int height, int iterations)
+    {
+        std::vector<unsigned char> next;
+        for (int pass = 0; pass < iterations; ++pass)
+        {
+            next = covered;
+            for (int y = 0; y < height; ++y)
+                for (int x = 0; x < width; ++x)
+                {
+                    size_t index = (size_t)y * width + x;
+                    if (covered[index]) continue;
+                    glm::vec3 sum(0.0f);
+                    int count = 0;
+                    for (int dy = -1; dy <= 1; ++dy)
+                        for (int dx = -1; dx <= 1; ++dx)
+                        {
+                            int nx = x + dx, ny = y + dy;
+                            if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+                            size_t neighbor = (size_t)ny * width + nx;
+                            if (!covered[neighbor]) continue;
+                            sum += glm::vec3(texels[neighbor * 3], texels[neighbor * 3 + 1], texels[neighbor * 3 + 2]);
+                            ++count;
+                        }
+                    if (count == 0) continue;
+                    sum /= (float)count;
+                    texels[index * 3] = sum.x;
+                    texels[index * 3 + 1] = sum.y;
+                    texels[index * 3 + 2] = sum.z;
+                    next[index] = 1;
+                }
+            covered.swap(next);
+        }
+    }
+}
+
+LightmapBaker::LightmapBaker() :
+    occluderHash_(14695981039346656037ULL), lightHash_(14695981039346656037ULL), resolution_(512), jobs_(nullptr),
+    directory_("../cache/lightmaps/"), cacheEnabled_(true),
+    cacheHits_(0), bakedMeshes_(0), lastCharts_(0), bakeMs_(0.0)
+{
+}
+
+void LightmapBaker::setOccluders(const std::vector<glm::vec3>& positions)
+{
+    occluderHash_ = 14695981039346656037ULL;
+    if (!positions.empty())
+        fnv1a(occluderHash_, positions.data(), positions.size() * sizeof(glm::vec3));
+    bvh_.build(positions);
+}
+
+void LightmapBaker::setLights(const std::vector<LightSourceConfig>& lights)
+{
+    lights_ = lights;
+    lightHash_ = 14695981039346656037ULL;
+    // Campo a campo: o struct tem bytes de preenchimento depois do bool
+    for (const auto& light : lights_)
+    {
+        fnv1a(lightHash_, &light.position, sizeof(light.position));
+        fnv1a(lightHash_, &light.diffuse, sizeof(light.diffuse));
+        fnv1a(lightHash_, &light.intensity, sizeof(light.intensity));
+        fnv1a(lightHash_, &light.radius, sizeof(light.radius));
+        unsigned char castsShadows = light.castsShadows ? 1 : 0;
+        fnv1a(lightHash_, &castsShadows, sizeof(castsShadows));
+    }
+}
+
+void LightmapBaker::buildCharts(const std::vector<float>& vertices, const std::vector<glm::vec3>& faceNormals, std::vector<Chart>& charts) const
+{
+    int triangleCount = (int)faceNormals.size();
+
+    // Vizinhança por aresta: vértices iguais no triangle soup são os que têm a mesma posição
+    std::unordered_map<glm::vec3, int, PositionHash, PositionEqual> positionIndex;
+    std::vector<int> corner(triangleCount * 3);
+    for (int i = 0; i < triangleCount * 3; ++i)
+    {
+        glm::vec3 p(vertices[i * 8], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+        corner[i] = positionIndex.emplace(p, (int)positionIndex.size()).first->second;
+    }
+
+    std::unordered_map<uint64_t, std::vector<int>> edgeTriangles;
+    edgeTriangles.reserve(triangleCount * 3);
+    auto edgeKey = [&](int t, int e) {
+        uint64_t a = (uint64_t)corner[t * 3 + e], b = (uint64_t)corner[t * 3 + (e + 1) % 3];
+        return a < b ? (a << 32) | b : (b << 32) | a;
+    };
+    for (int t = 0; t < triangleCount; ++t)
+        for (int e = 0; e < 3; ++e)
+            edgeTriangles[edgeKey(t, e)].push_back(t);
+
+    std::vector<int> chartOf(triangleCount, -1);
+    std::vector<int> stack;
+    for (int seed = 0; seed < triangleCount; ++seed)
+    {
+        if (chartOf[seed] >= 0) continue;
+
+        Chart chart;
+        glm::vec3 normal = faceNormals[seed];
+        int chartIndex = (int)charts.size();
+        chartOf[seed] = chartIndex;
+        stack.assign(1, seed);
+        while (!stack.empty())
+        {
+            int t = stack.back();
+            stack.pop_back();
+            chart.triangles.push_back(t);
+            for (int e = 0; e < 3; ++e)
+                for (int neighbor : edgeTriangles[edgeKey(t, e)])
+                {
+                    if (chartOf[neighbor] >= 0 || glm::dot(faceNormals[neighbor], normal) < CHART_NORMAL_COS) continue;
+                    chartOf[neighbor] = chartIndex;
+                    stack.push_back(neighbor);
+                }
+        }
+
+        orthonormalBasis(normal, chart.tangent, chart.bitangent);
+        charts.push_back(std::move(chart));
+    }
+}
+
+bool LightmapBaker::packCharts(std::vector<Chart>& charts, float scale) const
+{
+    std::vector<int> order(charts.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        Chart& chart = charts[i];
+        glm::vec2 extent = (chart.boundsMax - chart.boundsMin) * scale;
+        chart.width = (int)std::ceil(extent.x) + 1 + 2 * PADDING;
+        chart.height = (int)std::ceil(extent.y) + 1 + 2 * PADDING;
+        order[i] = (int)i;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return charts[a].height > charts[b].height; });
+
+    // Prateleiras: charts em ordem de altura lado a lado, nova prateleira quando a linha enche
+    int x = 0, y = 0, shelfHeight = 0;
+    for (int index : order)
+    {
+        Chart& chart = charts[index];
+        if (chart.width > resolution_) return false;
+        if (x + chart.width > resolution_)
+        {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        if (y + chart.height > resolution_) return false;
+        chart.x = x;
+        chart.y = y;
+        x += chart.width;
+        shelfHeight = std::max(shelfHeight, chart.height);
+    }
+    return true;
+}
+
+void LightmapBaker::computeLighting(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                                    const std::vector<glm::vec3>& offsets, const std::vector<unsigned char>& covered,
+                                    std::vector<float>& texels) const
+{
+    int tasks = (resolution_ + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    JobSystem& jobs = jobs_ ? *jobs_ : JobSystem::shared();
+    jobs.parallelFor(tasks, [&](int task) {
+        int rowEnd = std::min(resolution_, (task + 1) * ROWS_PER_TASK);
+        for (int y = task * ROWS_PER_TASK; y < rowEnd; ++y)
+            for (int x = 0; x < resolution_; ++x)
+            {
+                size_t index = (size_t)y * resolution_ + x;
+                if (!covered[index]) continue;
+
+                const glm::vec3& position = positions[index];
+                const glm::vec3& normal = normals[index];
+                glm::vec3 origin = position + offsets[index];
+                glm::vec3 color(0.0f);
+                for (const auto& light : lights_)
+                {
+                    // Mesmo termo difuso e atenuação do object.fs, sem o Kd (multiplicado no shader)
+                    glm::vec3 toLight = light.position - position;
+                    float distance = glm::length(toLight);
+                    if (distance <= 0.0f || distance >= light.range()) continue;
+                    glm::vec3 direction = toLight / distance;
+                    float diffuse = glm::dot(normal, direction);
+                    if (diffuse <= 0.0f) continue;
+                    if (light.castsShadows && bvh_.occluded(origin, direction, distance)) continue;
+                    float attenuation = 1.0f - distance / light.range();
+                    color += light.diffuse * light.intensity * (diffuse * attenuation * attenuation);
+                }
+                texels[index * 3] = color.x;
+                texels[index * 3 + 1] = color.y;
+                texels[index * 3 + 2] = color.z;
+            }
+    });
+}
+
+std::string LightmapBaker::pathFor(uint64_t key, const char* extension) const
+{
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)key);
+    return directory_ + hex + extension;
+}
+
+bool LightmapBaker::loadCache(uint64_t key, size_t vertexCount, Lightmap& lightmap) const
+{
+    std::ifstream file(pathFor(key, ".uv2"), std::ios::binary);
+    if (!file.is_open()) return false;
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.vertexCount != vertexCount)
+        return false;
+
+    std::vector<float> uvs(vertexCount * 2);
+    if (!file.read(reinterpret_cast<char*>(uvs.data()), uvs.size() * sizeof(float)))
+        return false;
+
+    int width, height, channels;
+    float* pixels = stbi_loadf(pathFor(key, ".hdr").c_str(), &width, &height, &channels, 3);
+    if (!pixels) return false;
+    if (width != (int)header.width || height != (int)header.height)
+    {
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    lightmap.width = width;
+    lightmap.height = height;
+    lightmap.texels.assign(pixels, pixels + (size_t)width * height * 3);
+    lightmap.uvs = std::move(uvs);
+    stbi_image_free(pixels);
+    return true;
+}
+
+void LightmapBaker::storeCache(uint64_t key, const Lightmap& lightmap) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+
+    // .hdr (RGBE) dá para abrir em qualquer visualizador; a UV fica num binário ao lado
+    if (!stbi_write_hdr(pathFor(key, ".hdr").c_str(), lightmap.width, lightmap.height, 3, lightmap.texels.data()))
+    {
+        std::cerr << "LightmapBaker: não foi possível gravar " << pathFor(key, ".hdr") << std::endl;
+        return;
+    }
+
+    std::ofstream file(pathFor(key, ".uv2"), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "LightmapBaker: não foi possível gravar " << pathFor(key, ".uv2") << std::endl;
+        return;
+    }
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, (uint32_t)(lightmap.uvs.size() / 2),
+                           (uint32_t)lightmap.width, (uint32_t)lightmap.height };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(lightmap.uvs.data()), lightmap.uvs.size() * sizeof(float));
+}
+
+bool LightmapBaker::bake(const std::vector<float>& vertices, const glm::mat4& model, Lightmap& lightmap)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t vertexCount = vertices.size() / 8;
+    int triangleCount = (int)(vertexCount / 3);
+    if (triangleCount == 0) return false;
+
+    uint64_t key = occluderHash_;
+    fnv1a(key, &lightHash_, sizeof(lightHash_));
+    fnv1a(key, vertices.data(), vertices.size() * sizeof(float));
+    fnv1a(key, &model[0][0], sizeof(glm::mat4));
+    fnv1a(key, &resolution_, sizeof(resolution_));
+    if (cacheEnabled_ && loadCache(key, vertexCount, lightmap))
+    {
+        ++cacheHits_;
+        bakeMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    // Geometria em mundo: a densidade de texels fica em texels por unidade de mundo
+    glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+    std::vector<glm::vec3> worldPositions(vertexCount), worldNormals(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* v = &vertices[i * 8];
+        worldPositions[i] = glm::vec3(model * glm::vec4(v[0], v[1], v[2], 1.0f));
+        glm::vec3 normal = normalMatrix * glm::vec3(v[3], v[4], v[5]);
+        float length = glm::length(normal);
+        worldNormals[i] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+    }
+
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    for (int t = 0; t < triangleCount; ++t)
+    {
+        glm::vec3 normal = glm::cross(worldPositions[t * 3 + 1] - worldPositions[t * 3], worldPositions[t * 3 + 2] - worldPositions[t * 3]);
+        float length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        // Ordem dos vértices nem sempre bate com as normais do OBJ: vale o lado das normais de vértice
+        if (glm::dot(normal, worldNormals[t * 3] + worldNormals[t * 3 + 1] + worldNormals[t * 3 + 2]) < 0.0f)
+            normal = -normal;
+        faceNormals[t] = normal;
+    }
+
+    std::vector<Chart> charts;
+    buildCharts(vertices, faceNormals, charts);
+
+    // Projeção de cada chart no plano da sua normal
+    std::vector<glm::vec2> planar(vertexCount);
+    float area = 0.0f;
+    for (auto& chart : charts)
+    {
+        chart.boundsMin = glm::vec2(1e30f);
+        chart.boundsMax = glm::vec2(-1e30f);
+        for (int t : chart.triangles)
+            for (int c = 0; c < 3; ++c)
+            {
+                const glm::vec3& p = worldPositions[t * 3 + c];
+                glm::vec2 uv(glm::dot(p, chart.tangent), glm::dot(p, chart.bitangent));
+                planar[t * 3 + c] = uv;
+                chart.boundsMin = glm::min(chart.boundsMin, uv);
+                chart.boundsMax = glm::max(chart.boundsMax, uv);
+            }
+        glm::vec2 extent = chart.boundsMax - chart.boundsMin;
+        area += extent.x * extent.y;
+    }
+
+    // Escala que ocuparia ~70% do atlas; reduz até todos os charts (com margem) caberem
+    float scale = area > 0.0f ? std::sqrt(TARGET_FILL * resolution_ * resolution_ / area) : 1.0f;
+    int attempt = 0;
+    while (!packCharts(charts, scale))
+    {
+        if (++attempt >= MAX_PACK_ATTEMPTS)
+        {
+            std::cerr << "LightmapBaker: " << charts.size() << " charts não cabem em " << resolution_ << "x" << resolution_ << std::endl;
+            return false;
+        }
+        scale *= 0.9f;
+    }
+
+    // UV2 em texels (centro do texel i em i + 0.5) e normalizada pelo lado do atlas
+    std::vector<glm::vec2> texelCoords(vertexCount);
+    lightmap.width = resolution_;
+    lightmap.height = resolution_;
+    lightmap.uvs.resize(vertexCount * 2);
+    for (const auto& chart : charts)
+    {
+        glm::vec2 origin((float)(chart.x + PADDING), (float)(chart.y + PADDING));
+        for (int t : chart.triangles)
+            for (int c = 0; c < 3; ++c)
+            {
+                size_t vertex = (size_t)t * 3 + c;
+                texelCoords[vertex] = origin + 0.5f + (planar[vertex] - chart.boundsMin) * scale;
+                lightmap.uvs[vertex * 2] = texelCoords[vertex].x / resolution_;
+                lightmap.uvs[vertex * 2 + 1] = texelCoords[vertex].y / resolution_;
+            }
+    }
+
+    // Rasteriza cada triângulo no atlas: posição e normal em mundo por centro de texel coberto
+    size_t texelCount = (size_t)resolution_ * resolution_;
+    std::vector<glm::vec3> texelPositions(texelCount), texelNormals(texelCount), texelOffsets(texelCount);
+    std::vector<unsigned char> covered(texelCount, 0);
+    for (int t = 0; t < triangleCount; ++t)
+    {
+        const glm::vec2& a = texelCoords[t * 3];
+        const glm::vec2& b = texelCoords[t * 3 + 1];
+        const glm::vec2& c = texelCoords[t * 3 + 2];
+        float denominator = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+        if (std::fabs(denominator) < 1e-12f) continue;
+
+        int x0 = std::max(0, (int)std::floor(std::min({ a.x, b.x, c.x })));
+        int y0 = std::max(0, (int)std::floor(std::min({ a.y, b.y, c.y })));
+        int x1 = std::min(resolution_ - 1, (int)std::ceil(std::max({ a.x, b.x, c.x })));
+        int y1 = std::min(resolution_ - 1, (int)std::ceil(std::max({ a.y, b.y, c.y })));
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+            {
+                glm::vec2 p(x + 0.5f, y + 0.5f);
+                float w0 = ((b.y - c.y) * (p.x - c.x) + (c.x - b.x) * (p.y - c.y)) / denominator;
+                float w1 = ((c.y - a.y) * (p.x - c.x) + (a.x - c.x) * (p.y - c.y)) / denominator;
+                float w2 = 1.0f - w0 - w1;
+                if (w0 < -1e-4f || w1 < -1e-4f || w2 < -1e-4f) continue;
+
+                size_t index = (size_t)y * resolution_ + x;
+                texelPositions[index] = worldPositions[t * 3] * w0 + worldPositions[t * 3 + 1] * w1 + worldPositions[t * 3 + 2] * w2;
+                glm::vec3 normal = worldNormals[t * 3] * w0 + worldNormals[t * 3 + 1] * w1 + worldNormals[t * 3 + 2] * w2;
+                float length = glm::length(normal);
+                texelNormals[index] = length > 0.0f ? normal / length : faceNormals[t];
+                // A origem dos raios de sombra sai da face (não da normal suavizada) para não acertar o próprio triângulo
+                texelOffsets[index] = faceNormals[t] * SURFACE_OFFSET;
+                covered[index] = 1;
+            }
+    }
+
+    lightmap.texels.assign(texelCount * 3, 0.0f);
+    computeLighting(texelPositions, texelNormals, texelOffsets, covered, lightmap.texels);
+    dilate(lightmap.texels, covered, resolution_, resolution_, 2 * PADDING);
+
+    lastCharts_ = (int)charts.size();
+    ++bakedMeshes_;
+    if (cacheEnabled_)
+        storeCache(key, lightmap);
+    bakeMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
@@ -0,0 +1,107 @@
+#include "LinearArena.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+    std::atomic<uint64_t> totalAllocations(0);
+    std::atomic<uint64_t> totalBlockAllocations(0);
+    std::atomic<uint64_t> totalBytes(0);
+
+    // Deslocamento alinhado dentro do bloco (o alinhamento vale para o endereço, não para o deslocamento)
+    size_t alignedOffset(const unsigned char* base, size_t offset, size_t alignment)
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(base) + offset;
+        return offset + ((alignment - address % alignment) % alignment);
+    }
+}
+
+LinearArena::LinearArena(size_t blockBytes) :
+    blockBytes_(std::max<size_t>(blockBytes, 64)), current_(0), offset_(0), reserved_(0),
+    allocations_(0), blockAllocations_(0)
+{
+}
+
+LinearArena::~LinearArena() = default;
+
+void LinearArena::release()
+{
+    blocks_.clear();
+    current_ = 0;
+    offset_ = 0;
+    reserved_ = 0;
+}
+
+LinearArena& LinearArena::forThread()
+{
+    thread_local LinearArena arena;
+    return arena;
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment)
+{
+    ++allocations_;
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (current_ < blocks_.size())
+    {
+        Block& block = blocks_[current_];
+        size_t start = alignedOffset(block.data.get(), offset_, alignment);
+        if (start + bytes <= block.size)
+        {
+            offset_ = start + bytes;
+            return block.data.get() + start;
+        }
+    }
+    return allocateSlow(bytes, alignment);
+}
+
+// Próximo bloco em que caiba; senão um novo logo depois do atual (os seguintes ficam para depois)
+void* LinearArena::allocateSlow(size_t bytes, size_t alignment)
+{
+    size_t next = blocks_.empty() ? 0 : current_ + 1;
+    for (; next < blocks_.size(); ++next)
+    {
+        size_t start = alignedOffset(blocks_[next].data.get(), 0, alignment);
+        if (start + bytes <= blocks_[next].size)
+            break;
+    }
+    if (next == blocks_.size())
+    {
+        Block block;
+        block.size = std::max(bytes + alignment, blocks_.empty() ? blockBytes_ : blocks_.back().size * 2);
+        block.data.reset(new unsigned char[block.size]);
+        reserved_ += block.size;
+        ++blockAllocations_;
+        totalBlockAllocations.fetch_add(1, std::memory_order_relaxed);
+        next = blocks_.empty() ? 0 : current_ + 1;
+        blocks_.insert(blocks_.begin() + next, std::move(block));
+    }
+
+    current_ = next;
+    size_t start = alignedOffset(blocks_[current_].data.get(), 0, alignment);
+    offset_ = start + bytes;
+    return blocks_[current_].data.get() + start;
+}
+
+size_t LinearArena::getUsedBytes() const
+{
+    size_t used = 0;
+    for (size_t i = 0; i < current_ && i < blocks_.size(); ++i)
+        used += blocks_[i].size;
+    return used + offset_;
+}
+
+uint64_t LinearArena::getTotalAllocations()
+{
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t LinearArena::getTotalBlockAllocations()
+{
+    return totalBlockAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t LinearArena::getTotalBytes()
+{
+    return totalBytes.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile() : data_(nullptr), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+{
+}
+#else
+MappedFile::MappedFile() : data_(nullptr), size_(0)
+{
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& path)
+{
+    close();
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_)
+    {
+        close();
+        return false;
+    }
+    data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_)
+    {
+        close();
+        return false;
+    }
+    size_ = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::open(const std::string& path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    // O mapeamento continua válido depois de fechar o descritor
+    void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) return false;
+
+    data_ = static_cast<const unsigned char*>(address);
+    size_ = (size_t)info.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+#endif
@@ -1,9 +1,9 @@
 #include "Mesh.h"
 #include <GLFW/glfw3.h>
 
-void Mesh::initialize(GLuint VAO_in, int nVertices_in, Shader* shader_in)
+void Mesh::initialize(std::shared_ptr<GpuGeometry> geometry_in, int nVertices_in, Shader* shader_in)
 {
-    this->VAO = VAO_in;
+    this->geometry_ = std::move(geometry_in);
     this->nVertices = nVertices_in;
     this->shader = shader_in;
 }
@@ -38,19 +38,70 @@ void Mesh::update(bool rotateX, bool rotateY, bool rotateZ)
     
     model = glm::scale(model, glm::vec3(scale_, scale_, scale_));
 
-    shader->setMat4("model", model);
+    model_ = model;
 }
 
-void Mesh::draw()
+bool Mesh::useResources() const
 {
-    shader->setVec3("material.Ka", Ka);
-    shader->setVec3("material.Kd", Kd);
-    shader->setVec3("material.Ks", Ks);
-    shader->setFloat("material.Ns", Ns);
+    GpuResources& resources = GpuResources::instance();
+    int reloads = resources.getReloads();
+    resources.use(geometry_->resource);
+    resources.use(textureResource_);
+    resources.use(lightmapResource_);
+    return resources.getReloads() != reloads;
+}
+
+void Mesh::draw(bool bindTexture)
+{
+    // Uma recarga mexe nos vínculos de textura: a do objeto é vinculada de novo
+    if (useResources())
+    {
+        bindTexture = true;
+    }
+    if (lightmapID_ != 0)
+    {
+        shader->setInt("lightmap", LIGHTMAP_TEXTURE_UNIT);
+        shader->setInt("bakedLights", bakedLights_);
+        glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, lightmapID_);
+    }
 
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glBindVertexArray(VAO);
+    if (textureLayer_ >= 0)
+    {
+        shader->setInt("textureLayer", textureLayer_);
+    }
+    if (bindTexture)
+    {
+        glBindTexture(textureLayer_ >= 0 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, textureID);
+    }
+    glBindVertexArray(geometry_->vao.get());
+    glDrawArrays(GL_TRIANGLES, 0, nVertices);
+    glBindVertexArray(0);
+}
+
+void Mesh::writeObjectBlock(ObjectBlock& block) const
+{
+    block.model = model_;
+    block.normalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model_))));
+    block.Ka = glm::vec4(Ka, 0.0f);
+    block.Kd = glm::vec4(Kd, 0.0f);
+    block.Ks = glm::vec4(Ks, Ns);
+}
+
+void Mesh::bindObjectBlock(Shader* shader)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(shader->ID, "Object");
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(shader->ID, blockIndex, OBJECT_UBO_BINDING);
+}
+
+// Desenha só a geometria, para passes de profundidade (shadow maps)
+void Mesh::drawDepth(Shader* depthShader) const
+{
+    GpuResources::instance().use(geometry_->resource);
+    depthShader->setMat4("model", model_);
+    glBindVertexArray(geometry_->vao.get());
     glDrawArrays(GL_TRIANGLES, 0, nVertices);
     glBindVertexArray(0);
 }
\ No newline at end of file
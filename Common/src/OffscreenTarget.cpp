@@ -0,0 +1,69 @@
+#include "OffscreenTarget.h"
+#include "GpuResources.h"
+#include <iostream>
+
+OffscreenTarget::OffscreenTarget() : width_(0), height_(0), fbo_(0), colorBuffer_(0), depthBuffer_(0), resource_(-1)
+{
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+    release();
+}
+
+void OffscreenTarget::release()
+{
+    if (fbo_) glDeleteFramebuffers(1, &fbo_);
+    if (colorBuffer_) glDeleteRenderbuffers(1, &colorBuffer_);
+    if (depthBuffer_) glDeleteRenderbuffers(1, &depthBuffer_);
+    fbo_ = colorBuffer_ = depthBuffer_ = 0;
+    GpuResources::instance().remove(resource_);
+    resource_ = -1;
+}
+
+bool OffscreenTarget::initialize(int width, int height)
+{
+    release();
+    width_ = width;
+    height_ = height;
+
+    glGenRenderbuffers(1, &colorBuffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthBuffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer_);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "OffscreenTarget: framebuffer incompleto (0x" << std::hex << status << std::dec << ")" << std::endl;
+        release();
+        return false;
+    }
+    resource_ = GpuResources::instance().add(GpuCategory::RenderTarget, (size_t)width * height * 8);
+    return true;
+}
+
+void OffscreenTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+    glViewport(0, 0, width_, height_);
+}
+
+void OffscreenTarget::readPixels(std::vector<unsigned char>& pixels) const
+{
+    pixels.resize((size_t)width_ * height_ * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
@@ -0,0 +1,355 @@
+#include "PathTracer.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+    const float PI = 3.14159265358979f;
+    const float SURFACE_OFFSET = 1e-3f;
+
+    inline unsigned int pcgHash(unsigned int value)
+    {
+        unsigned int state = value * 747796405u + 2891336453u;
+        unsigned int word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    // xorshift32: estado por pixel, semeado por pixel e passe
+    inline float random01(unsigned int& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    inline float luminance(const glm::vec3& c)
+    {
+        return 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+    }
+
+    // Base ortonormal sem ramificação (Duff et al. 2017)
+    inline void orthonormalBasis(const glm::vec3& n, glm::vec3& tangent, glm::vec3& bitangent)
+    {
+        float sign = std::copysign(1.0f, n.z);
+        float a = -1.0f / (sign + n.z);
+        float b = n.x * n.y * a;
+        tangent = glm::vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+        bitangent = glm::vec3(b, sign + n.y * n.y * a, -n.y);
+    }
+
+    inline glm::vec3 aroundAxis(const glm::vec3& axis, float cosTheta, float phi)
+    {
+        glm::vec3 tangent, bitangent;
+        orthonormalBasis(axis, tangent, bitangent);
+        float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+        return tangent * (std::cos(phi) * sinTheta) + bitangent * (std::sin(phi) * sinTheta) + axis * cosTheta;
+    }
+
+    // GL_REPEAT + GL_LINEAR no nível 0; o acúmulo de passes já filtra o serrilhado
+    glm::vec3 sampleBilinear(int width, int height, const unsigned char* texels, glm::vec2 uv)
+    {
+        float x = (uv.x - std::floor(uv.x)) * width - 0.5f;
+        float y = (uv.y - std::floor(uv.y)) * height - 0.5f;
+        float fx = std::floor(x), fy = std::floor(y);
+        float tx = x - fx, ty = y - fy;
+        int x0 = (int)fx, y0 = (int)fy;
+        int x1 = (x0 + 1 < width) ? x0 + 1 : 0;
+        int y1 = (y0 + 1 < height) ? y0 + 1 : 0;
+        if (x0 < 0) x0 = width - 1;
+        if (y0 < 0) y0 = height - 1;
+
+        const unsigned char* t00 = texels + ((size_t)y0 * width + x0) * 4;
+        const unsigned char* t10 = texels + ((size_t)y0 * width + x1) * 4;
+        const unsigned char* t01 = texels + ((size_t)y1 * width + x0) * 4;
+        const unsigned char* t11 = texels + ((size_t)y1 * width + x1) * 4;
+
+        glm::vec3 result;
+        for (int c = 0; c < 3; ++c)
+        {
+            float top = t00[c] + (t10[c] - t00[c]) * tx;
+            float bottom = t01[c] + (t11[c] - t01[c]) * tx;
+            result[c] = (top + (bottom - top) * ty) * (1.0f / 255.0f);
+        }
+        return result;
+    }
+}
+
+PathTracer::PathTracer() :
+    environment_(0.0f), inverseViewProjection_(1.0f),
+    width_(0), height_(0), tilesX_(0), tilesY_(0), maxDepth_(5), jobs_(nullptr),
+    passes_(0), rays_(0), buildMs_(0.0)
+{
+}
+
+void PathTracer::setScene(const std::vector<Mesh>& meshes, const std::vector<LightSourceConfig>& lights)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<glm::vec3> positions;
+    triangleData_.clear();
+    materials_.clear();
+    textures_.clear();
+    std::unordered_map<const MeshCpuData*, int> textureIndex;
+
+    for (const Mesh& mesh : meshes)
+    {
+        const MeshCpuData* data = mesh.getCpuData();
+        if (!data) continue;
+
+        Material material = { mesh.getKd(), mesh.getKs(), mesh.getNs(), -1 };
+        if (!data->texture.empty())
+        {
+            auto found = textureIndex.find(data);
+            if (found == textureIndex.end())
+            {
+                found = textureIndex.emplace(data, (int)textures_.size()).first;
+                textures_.push_back({ data->textureWidth, data->textureHeight, data->texture.data() });
+            }
+            material.texture = found->second;
+        }
+        int materialIndex = (int)materials_.size();
+        materials_.push_back(material);
+
+        const glm::mat4& model = mesh.getModelMatrix();
+        glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+        size_t triangleCount = data->vertices.size() / 24;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            const float* v = &data->vertices[t * 24];
+            TriangleData tri;
+            glm::vec3 world[3];
+            for (int k = 0; k < 3; ++k, v += 8)
+            {
+                world[k] = glm::vec3(model * glm::vec4(v[0], v[1], v[2], 1.0f));
+                tri.normal[k] = glm::normalize(normalMatrix * glm::vec3(v[3], v[4], v[5]));
+                tri.uv[k] = glm::vec2(v[6], v[7]);
+                positions.push_back(world[k]);
+            }
+            glm::vec3 cross = glm::cross(world[1] - world[0], world[2] - world[0]);
+            float length = glm::length(cross);
+            tri.geometricNormal = length > 0.0f ? cross / length : tri.normal[0];
+            tri.material = materialIndex;
+            triangleData_.push_back(tri);
+        }
+    }
+
+    lights_.clear();
+    environment_ = glm::vec3(0.0f);
+    for (const auto& light : lights)
+    {
+        environment_ += light.ambient;
+        lights_.push_back({ light.position, light.range(), light.diffuse * light.intensity, light.specular * light.intensity });
+    }
+
+    bvh_.build(positions);
+    buildMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    reset();
+}
+
+void PathTracer::setCamera(const Camera& camera)
+{
+    inverseViewProjection_ = glm::inverse(camera.getProjectionMatrix() * camera.getViewMatrix());
+    reset();
+}
+
+void PathTracer::resize(int width, int height)
+{
+    width_ = width;
+    height_ = height;
+    tilesX_ = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY_ = (height + TILE_SIZE - 1) / TILE_SIZE;
+    accumulator_.assign((size_t)width * height, glm::vec3(0.0f));
+    reset();
+}
+
+void PathTracer::reset()
+{
+    std::fill(accumulator_.begin(), accumulator_.end(), glm::vec3(0.0f));
+    passes_ = 0;
+    rays_ = 0;
+}
+
+void PathTracer::renderPass()
+{
+    JobSystem& jobs = jobs_ ? *jobs_ : JobSystem::shared();
+    unsigned int pass = (unsigned int)passes_;
+    jobs.parallelFor(tilesX_ * tilesY_, [this, pass](int tile) { renderTile(tile, pass); });
+    ++passes_;
+}
+
+// Mesma convenção da OpenGL: (x, y) em pixels a partir do canto inferior esquerdo
+glm::vec3 PathTracer::primaryDirection(float x, float y, glm::vec3& origin) const
+{
+    float ndcX = x / width_ * 2.0f - 1.0f;
+    float ndcY = y / height_ * 2.0f - 1.0f;
+    glm::vec4 nearPoint = inverseViewProjection_ * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection_ * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    origin = glm::vec3(nearPoint) / nearPoint.w;
+    return glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
+
+void PathTracer::renderTile(int tile, unsigned int pass)
+{
+    int tileX0 = (tile % tilesX_) * TILE_SIZE;
+    int tileY0 = (tile / tilesX_) * TILE_SIZE;
+    int tileX1 = std::min(tileX0 + TILE_SIZE, width_);
+    int tileY1 = std::min(tileY0 + TILE_SIZE, height_);
+    unsigned int passSeed = pcgHash(pass + 1);
+    unsigned long long rays = 0;
+
+    for (int y = tileY0; y < tileY1; y += 2)
+    {
+        for (int x = tileX0; x < tileX1; x += 2)
+        {
+            // Quad 2x2 como pacote; lanes fora da imagem repetem um pixel válido e são descartadas
+            glm::vec3 origin[4], direction[4];
+            Bvh::Hit hit[4];
+            unsigned int rng[4];
+            bool inside[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                int px = x + (lane & 1), py = y + (lane >> 1);
+                inside[lane] = px < tileX1 && py < tileY1;
+                px = std::min(px, tileX1 - 1);
+                py = std::min(py, tileY1 - 1);
+
+                rng[lane] = pcgHash((unsigned int)(py * width_ + px) ^ passSeed);
+                if (rng[lane] == 0) rng[lane] = 1;
+                float jitterX = random01(rng[lane]);
+                float jitterY = random01(rng[lane]);
+                direction[lane] = primaryDirection(px + jitterX, py + jitterY, origin[lane]);
+                hit[lane].t = FLT_MAX;
+            }
+            bvh_.intersect4(origin, direction, hit);
+            rays += 4;
+
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (!inside[lane]) continue;
+                int px = x + (lane & 1), py = y + (lane >> 1);
+                accumulator_[(size_t)py * width_ + px] += shade(origin[lane], direction[lane], hit[lane], rng[lane], rays);
+            }
+        }
+    }
+
+    rays_ += rays;
+}
+
+glm::vec3 PathTracer::shade(glm::vec3 origin, glm::vec3 direction, const Bvh::Hit& primary, unsigned int& rng, unsigned long long& rays) const
+{
+    glm::vec3 radiance(0.0f);
+    glm::vec3 throughput(1.0f);
+    Bvh::Hit hit = primary;
+
+    for (int depth = 0; ; ++depth)
+    {
+        if (hit.triangle < 0)
+        {
+            radiance += throughput * environment_;
+            break;
+        }
+
+        const TriangleData& tri = triangleData_[hit.triangle];
+        const Material& material = materials_[tri.material];
+        float w = 1.0f - hit.u - hit.v;
+        glm::vec3 position = origin + direction * hit.t;
+
+        // Sem culling na cena: as normais são viradas para o lado de onde o raio veio
+        glm::vec3 geometric = tri.geometricNormal;
+        if (glm::dot(geometric, direction) > 0.0f) geometric = -geometric;
+        glm::vec3 normal = glm::normalize(tri.normal[0] * w + tri.normal[1] * hit.u + tri.normal[2] * hit.v);
+        if (glm::dot(normal, geometric) < 0.0f) normal = -normal;
+
+        glm::vec3 albedo = material.Kd;
+        if (material.texture >= 0)
+        {
+            const TextureData& texture = textures_[material.texture];
+            glm::vec2 uv = tri.uv[0] * w + tri.uv[1] * hit.u + tri.uv[2] * hit.v;
+            albedo = albedo * sampleBilinear(texture.width, texture.height, texture.texels, uv);
+        }
+
+        glm::vec3 view = -direction;
+        glm::vec3 surface = position + geometric * SURFACE_OFFSET;
+        float specularNorm = (material.Ns + 2.0f) * 0.5f;
+
+        // Iluminação direta: um raio de sombra por luz dentro do raio de alcance
+        for (const Light& light : lights_)
+        {
+            glm::vec3 toLight = light.position - surface;
+            float dist = glm::length(toLight);
+            if (dist >= light.radius || dist <= 0.0f) continue;
+            glm::vec3 lightDir = toLight / dist;
+            float cosTheta = glm::dot(normal, lightDir);
+            if (cosTheta <= 0.0f) continue;
+
+            ++rays;
+            if (bvh_.occluded(surface, lightDir, dist)) continue;
+
+            float attenuation = 1.0f - dist / light.radius;
+            attenuation *= attenuation;
+            glm::vec3 reflectDir = glm::reflect(-lightDir, normal);
+            float spec = std::pow(std::max(glm::dot(view, reflectDir), 0.0f), material.Ns) * specularNorm;
+            radiance += throughput * (albedo * light.diffuse + material.Ks * light.specular * spec) * (cosTheta * attenuation);
+        }
+
+        if (depth + 1 >= maxDepth_) break;
+
+        // Próximo rebote: lobo difuso ou especular, escolhido pela refletância de cada um
+        float diffuseWeight = luminance(albedo);
+        float specularWeight = luminance(material.Ks);
+        if (diffuseWeight + specularWeight <= 0.0f) break;
+        float pickDiffuse = diffuseWeight / (diffuseWeight + specularWeight);
+
+        glm::vec3 next;
+        if (random01(rng) < pickDiffuse)
+        {
+            // Amostragem por cosseno: peso = albedo
+            float r = random01(rng);
+            next = aroundAxis(normal, std::sqrt(1.0f - r), 2.0f * PI * random01(rng));
+            throughput = throughput * albedo / pickDiffuse;
+        }
+        else
+        {
+            // Amostragem do lobo de Phong em torno da reflexão
+            glm::vec3 mirror = glm::reflect(direction, normal);
+            float cosAlpha = std::pow(random01(rng), 1.0f / (material.Ns + 1.0f));
+            next = aroundAxis(mirror, cosAlpha, 2.0f * PI * random01(rng));
+            float cosTheta = glm::dot(next, normal);
+            if (cosTheta <= 0.0f) break;
+            throughput = throughput * material.Ks * ((material.Ns + 2.0f) / (material.Ns + 1.0f) * cosTheta / (1.0f - pickDiffuse));
+        }
+
+        // Roleta russa depois de alguns rebotes
+        if (depth >= 2)
+        {
+            float survive = std::min(std::max(throughput.r, std::max(throughput.g, throughput.b)), 0.95f);
+            if (random01(rng) >= survive) break;
+            throughput = throughput / survive;
+        }
+
+        origin = surface;
+        direction = next;
+        hit.t = FLT_MAX;
+        ++rays;
+        bvh_.intersect(origin, direction, hit);
+    }
+
+    return radiance;
+}
+
+void PathTracer::resolve(std::vector<unsigned char>& pixels) const
+{
+    pixels.resize((size_t)width_ * height_ * 4);
+    float scale = passes_ > 0 ? 1.0f / passes_ : 0.0f;
+    for (size_t i = 0; i < accumulator_.size(); ++i)
+    {
+        glm::vec3 color = glm::clamp(accumulator_[i] * scale, 0.0f, 1.0f);
+        pixels[i * 4 + 0] = (unsigned char)(color.r * 255.0f + 0.5f);
+        pixels[i * 4 + 1] = (unsigned char)(color.g * 255.0f + 0.5f);
+        pixels[i * 4 + 2] = (unsigned char)(color.b * 255.0f + 0.5f);
+        pixels[i * 4 + 3] = 255;
+    }
+}
@@ -1,13 +1,94 @@
 #include "Scene.h"
+#include "AmbientOcclusionBaker.h"
+#include "LightmapBaker.h"
+#include "TextureCache.h"
+#include "AsyncTextureLoader.h"
+#include "GpuResources.h"
+#include "JobSystem.h"
+#include "LinearArena.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #define TINYOBJLOADER_IMPLEMENTATION 
 #include <tiny_obj_loader.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-Scene::Scene() : basePath("../assets/") {}
+namespace {
+    // Maior lado da caixa das UVs (vértices no layout do VBO): quanto da imagem o objeto cobre
+    float uvExtent(const std::vector<GLfloat>& vertices) {
+        if (vertices.empty()) return 1.0f;
+        glm::vec2 minUV(vertices[6], vertices[7]);
+        glm::vec2 maxUV = minUV;
+        for (size_t i = 0; i + 8 <= vertices.size(); i += 8) {
+            glm::vec2 uv(vertices[i + 6], vertices[i + 7]);
+            minUV = glm::min(minUV, uv);
+            maxUV = glm::max(maxUV, uv);
+        }
+        glm::vec2 size = maxUV - minUV;
+        return std::max(std::max(size.x, size.y), 1.0f / 4096.0f);
+    }
+
+    // VAO com os atributos 0-2 intercalados, 3 (oclusão por vértice) e 4 (UV do lightmap, se houver),
+    // cada um no seu VBO (do GLBufferPool); devolve os bytes alocados
+    size_t createGeometry(GpuGeometry& geometry, const std::vector<GLfloat>& vertices, const std::vector<GLfloat>& occlusion,
+                          const std::vector<GLfloat>& lightmapUVs) {
+        geometry.vao = GLVertexArray::create();
+        geometry.buffers.clear();
+        geometry.buffers.push_back(GLBuffer::create(vertices.size() * sizeof(GLfloat), vertices.data()));
+        geometry.buffers.push_back(GLBuffer::create(occlusion.size() * sizeof(GLfloat), occlusion.data()));
+        if (!lightmapUVs.empty()) {
+            geometry.buffers.push_back(GLBuffer::create(lightmapUVs.size() * sizeof(GLfloat), lightmapUVs.data()));
+        }
+        glBindVertexArray(geometry.vao.get());
+
+        glBindBuffer(GL_ARRAY_BUFFER, geometry.buffers[0].get());
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(6 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(2);
+
+        glBindBuffer(GL_ARRAY_BUFFER, geometry.buffers[1].get());
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (void*)0);
+        glEnableVertexAttribArray(3);
+
+        if (!lightmapUVs.empty()) {
+            glBindBuffer(GL_ARRAY_BUFFER, geometry.buffers[2].get());
+            glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (void*)0);
+            glEnableVertexAttribArray(4);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        size_t bytes = 0;
+        for (const GLBuffer& buffer : geometry.buffers) {
+            bytes += buffer.getCapacity();
+        }
+        return bytes;
+    }
+
+    // Textura RGB16F do lightmap; devolve os bytes
+    size_t uploadLightmap(GLuint texture, const Lightmap& lightmap) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, lightmap.width, lightmap.height, 0, GL_RGB, GL_FLOAT, lightmap.texels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return (size_t)lightmap.width * lightmap.height * 6;
+    }
+}
+
+Scene::Scene() : environmentIntensity(1.0f), uploadToGpu(true), keepCpuData(false),
+                 bakeAmbientOcclusion(true), ambientOcclusionSamples(64), ambientOcclusionDistance(0.5f),
+                 bakeLightmaps(true), lightmapResolution(512), textureLoader(nullptr), atlasTextures(false), arrayTextures(false),
+                 streamTextures(false), texturePreviewSize(64), textureMemoryBudgetMB(256), gpuMemoryBudgetMB(0), basePath("../assets/") {}
 
 bool Scene::loadConfig(const std::string& configFilePath) {
     std::ifstream file(configFilePath);
@@ -37,16 +118,68 @@ bool Scene::loadConfig(const std::string& configFilePath) {
 
     if (jsonConfig.contains("light_sources")) {
         for (const auto& light : jsonConfig["light_sources"]) {
+            bool castsShadows = false;
+            int shadowResolution = 1024;
+            if (light.contains("shadow")) {
+                castsShadows = light["shadow"].value("enabled", true);
+                shadowResolution = light["shadow"].value("resolution", 1024);
+            }
             lightSources.push_back({
                 glm::vec3(light["position"][0], light["position"][1], light["position"][2]),
                 glm::vec3(light["ambient"][0], light["ambient"][1], light["ambient"][2]),
                 glm::vec3(light["diffuse"][0], light["diffuse"][1], light["diffuse"][2]),
                 glm::vec3(light["specular"][0], light["specular"][1], light["specular"][2]),
-                light["intensity"]
+                light["intensity"],
+                light.value("radius", 0.0f),
+                castsShadows,
+                shadowResolution
             });
         }
     }
 
+    if (jsonConfig.contains("environment")) {
+        const auto& env = jsonConfig["environment"];
+        environmentPath = basePath + env["path"].get<std::string>();
+        environmentIntensity = env.value("intensity", 1.0f);
+    }
+
+    if (jsonConfig.contains("ambient_occlusion")) {
+        const auto& ao = jsonConfig["ambient_occlusion"];
+        bakeAmbientOcclusion = ao.value("enabled", true);
+        ambientOcclusionSamples = ao.value("samples", 64);
+        ambientOcclusionDistance = ao.value("distance", 0.5f);
+    }
+
+    if (jsonConfig.contains("lightmaps")) {
+        const auto& lightmaps = jsonConfig["lightmaps"];
+        bakeLightmaps = lightmaps.value("enabled", true);
+        lightmapResolution = lightmaps.value("resolution", 512);
+    }
+
+    if (jsonConfig.contains("texture_atlas")) {
+        const auto& atlasConfig = jsonConfig["texture_atlas"];
+        atlasTextures = atlasConfig.value("enabled", true);
+        atlas.setPageSize(atlasConfig.value("page_size", 4096));
+        atlas.setPadding(atlasConfig.value("padding", 8));
+    }
+
+    if (jsonConfig.contains("texture_arrays")) {
+        const auto& arraysConfig = jsonConfig["texture_arrays"];
+        arrayTextures = arraysConfig.value("enabled", true);
+        textureArrays.setSizeRange(arraysConfig.value("min_size", 256), arraysConfig.value("max_size", 2048));
+    }
+
+    if (jsonConfig.contains("texture_streaming")) {
+        const auto& streamingConfig = jsonConfig["texture_streaming"];
+        streamTextures = streamingConfig.value("enabled", true);
+        texturePreviewSize = streamingConfig.value("preview_size", 64);
+        textureMemoryBudgetMB = streamingConfig.value("memory_budget_mb", 256);
+    }
+
+    if (jsonConfig.contains("gpu_memory")) {
+        gpuMemoryBudgetMB = jsonConfig["gpu_memory"].value("budget_mb", 0);
+    }
+
     if (jsonConfig.contains("objects")) {
         for (const auto& obj : jsonConfig["objects"]) {
             ObjectConfig objectConfig;
@@ -84,69 +217,85 @@ bool Scene::loadConfig(const std::string& configFilePath) {
 }
 
 void Scene::loadMaterials(const std::string& mtlFilePath, glm::vec3& Ka, glm::vec3& Kd, glm::vec3& Ks, float& Ns) {
+    // Valores padrão para campos ausentes no MTL (ex.: Cube.mtl vazio, Suzanne.mtl sem Kd)
+    Ka = glm::vec3(0.1f, 0.1f, 0.1f);
+    Kd = glm::vec3(0.7f, 0.7f, 0.7f);
+    Ks = glm::vec3(1.0f, 1.0f, 1.0f);
+    Ns = 32.0f;
+
     std::ifstream mtlFile(mtlFilePath);
     if (!mtlFile.is_open()) {
         std::cerr << "Erro ao abrir arquivo MTL: " << mtlFilePath << std::endl;
-        Ka = glm::vec3(0.1f, 0.1f, 0.1f);
-        Kd = glm::vec3(0.7f, 0.7f, 0.7f);
-        Ks = glm::vec3(1.0f, 1.0f, 1.0f);
-        Ns = 32.0f;
         return;
     }
 
+    // Sem um istringstream (e a cópia da linha) por linha: prefixo e números saem do buffer de line,
+    // que getline reaproveita
     std::string line;
     while (std::getline(mtlFile, line)) {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
-
-        if (prefix == "Ka") {
-            iss >> Ka.x >> Ka.y >> Ka.z;
-        } else if (prefix == "Kd") {
-            iss >> Kd.x >> Kd.y >> Kd.z;
-        } else if (prefix == "Ks") {
-            iss >> Ks.x >> Ks.y >> Ks.z;
-        } else if (prefix == "Ns") {
-            iss >> Ns;
+        char prefix[8];
+        int consumed = 0;
+        if (sscanf(line.c_str(), " %7s%n", prefix, &consumed) != 1) {
+            continue;
+        }
+        const char* values = line.c_str() + consumed;
+
+        if (strcmp(prefix, "Ka") == 0) {
+            sscanf(values, "%f %f %f", &Ka.x, &Ka.y, &Ka.z);
+        } else if (strcmp(prefix, "Kd") == 0) {
+            sscanf(values, "%f %f %f", &Kd.x, &Kd.y, &Kd.z);
+        } else if (strcmp(prefix, "Ks") == 0) {
+            sscanf(values, "%f %f %f", &Ks.x, &Ks.y, &Ks.z);
+        } else if (strcmp(prefix, "Ns") == 0) {
+            sscanf(values, "%f", &Ns);
         }
     }
     mtlFile.close();
 }
 
-GLuint Scene::loadTexture(const std::string& filePath) {
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data) {
-        GLenum format;
-        if (nrChannels == 1) format = GL_RED;
-        else if (nrChannels == 3) format = GL_RGB;
-        else if (nrChannels == 4) format = GL_RGBA;
-        else {
-            std::cerr << "Unsupported number of channels for texture: " << filePath << std::endl;
-            stbi_image_free(data);
-            return 0;
-        }
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+// Mips cozidos em ../cache/textures/ (TextureCache); sem textura o mesh usa a permutação sem TEXTURED
+// Com o loader assíncrono a memória é contada (e o streaming devolvido) por ele; as síncronas podem ser
+// despejadas e voltam do container mapeado do cache, sem cópia em CPU
+const Scene::OwnedTexture& Scene::loadTexture(const std::string& filePath, int maxLevel) {
+    auto it = textures_.find(filePath);
+    if (it != textures_.end()) {
+        return it->second;
+    }
+    OwnedTexture& owned = textures_[filePath];
+    if (textureLoader) {
+        owned.texture.reset(textureLoader->request(filePath, maxLevel));
     } else {
-        std::cerr << "Failed to load texture: " << filePath << std::endl;
+        GLTexture texture = GLTexture::create();
+        GLuint id = texture.get();
+        size_t bytes = TextureCache::instance().upload(filePath, id);
+        if (bytes > 0) {
+            owned.texture = std::move(texture);
+            owned.resource = GpuResources::instance().add(GpuCategory::Texture, bytes,
+                [id]() { GpuResources::clearTexture(id); },
+                [id, filePath]() { return TextureCache::instance().upload(filePath, id); });
+        }
     }
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return texID;
+    return owned;
+}
+
+void Scene::release() {
+    GpuResources& resources = GpuResources::instance();
+    for (auto& entry : textures_) {
+        resources.remove(entry.second.resource);
+    }
+    for (auto& lightmap : lightmaps_) {
+        resources.remove(lightmap.resource);
+    }
+    textures_.clear();
+    lightmaps_.clear();
+    textureArrays.release();
+}
+
+bool Scene::loadTextureCpu(const std::string& filePath, MeshCpuData& data) {
+    return TextureCache::instance().loadPixels(filePath, data.texture, data.textureWidth, data.textureHeight);
 }
 
-int Scene::loadOBJ(const std::string& filePath, std::vector<GLfloat>& out_vertices, std::vector<GLfloat>& out_textures, std::vector<GLfloat>& out_normals) {
+int Scene::loadOBJ(const std::string& filePath, std::pmr::vector<GLfloat>& out_vertices, std::pmr::vector<GLfloat>& out_textures, std::pmr::vector<GLfloat>& out_normals) {
     tinyobj::ObjReaderConfig reader_config;
     size_t last_slash_idx = filePath.rfind('/');
     if (std::string::npos == last_slash_idx) {
@@ -178,6 +327,14 @@ int Scene::loadOBJ(const std::string& filePath, std::vector<GLfloat>& out_vertic
     out_vertices.clear();
     out_textures.clear();
     out_normals.clear();
+    // Tamanho exato de uma vez: num arena os buffers abandonados pelo crescimento não voltam
+    size_t faceVertices = 0;
+    for (const auto& shape : shapes) {
+        faceVertices += shape.mesh.indices.size();
+    }
+    out_vertices.reserve(faceVertices * 3);
+    out_normals.reserve(faceVertices * 3);
+    out_textures.reserve(faceVertices * 2);
 
     for (size_t s = 0; s < shapes.size(); s++) {
         size_t index_offset = 0;
@@ -219,39 +376,91 @@ void Scene::setupScene(GLFWwindow* window, Shader* shader, Camera* camera, std::
     camera->setCameraUpInitial(cameraInitialUp);
     camera->setProjection(cameraFov, cameraAspectRatio, cameraNearPlane, cameraFarPlane);
 
-    if (!lightSources.empty()) {
-        shader->Use();
-        shader->setVec3("light.position", lightSources[0].position);
-        shader->setVec3("light.ambient", lightSources[0].ambient);
-        shader->setVec3("light.diffuse", lightSources[0].diffuse);
-        shader->setVec3("light.specular", lightSources[0].specular);
+    if (!environmentPath.empty() && environment.loadEquirectangular(environmentPath, environmentIntensity)) {
+        std::cout << "Mapa de ambiente " << environmentPath << " projetado em SH em " << environment.getProjectMs() << " ms" << std::endl;
     }
 
+    std::vector<std::string> texturePaths;
     for (const auto& objConfig : objects) {
-        std::vector<GLfloat> obj_vertices;
-        std::vector<GLfloat> obj_texcoords;
-        std::vector<GLfloat> obj_normals;
+        texturePaths.push_back(objConfig.texture_path);
+    }
+
+    if (arrayTextures) {
+        if (textureArrays.build(texturePaths, uploadToGpu)) {
+            std::cout << "Texture arrays: " << textureArrays.getArrays().size() << " arrays, "
+                      << textureArrays.getTotalBytes() / 1048576.0 << " MB, " << textureArrays.getBuildMs() << " ms" << std::endl;
+            for (const auto& info : textureArrays.getArrays()) {
+                std::cout << "  " << info.size << "x" << info.size << " " << TextureArrays::formatName(info.internalFormat) << ": "
+                          << info.layers << " camadas, " << info.levels << " níveis, " << info.bytes / 1048576.0 << " MB" << std::endl;
+            }
+        }
+    } else if (atlasTextures) {
+        if (uploadToGpu) {
+            GLint maxTextureSize = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+            if (maxTextureSize > 0) {
+                atlas.setPageSize(std::min(atlas.getPageSize(), (int)maxTextureSize));
+            }
+        }
+        if (atlas.build(texturePaths)) {
+            std::cout << "Atlas de texturas: " << atlas.getEntryCount() << " imagens em " << atlas.getPageCount() << " páginas";
+            for (int page = 0; page < atlas.getPageCount(); ++page) {
+                std::cout << (page == 0 ? " (" : ", ") << atlas.getPageWidth(page) << "x" << atlas.getPageHeight(page);
+            }
+            std::cout << "), " << (atlas.wasCached() ? "do cache" : "montado") << " em " << atlas.getBuildMs() << " ms" << std::endl;
+        }
+    }
+
+    // Primeiro carrega tudo em CPU; o upload espera a oclusão, que depende de todos os estáticos
+    size_t firstMesh = meshes.size();
+    loadedObjects.clear();
+    std::vector<const ObjectConfig*> loaded;
+    std::vector<std::string> loadedTextures;
+    std::vector<std::vector<GLfloat>> vertexData;
+
+    // OBJ, MTL, limites e intercalação de cada objeto em paralelo (só CPU); o resto, que toca o
+    // atlas, o GL e as listas da cena, segue em ordem. Os vetores de rascunho vêm do arena do thread
+    struct ObjectLoad {
+        int nVertices = -1;
+        glm::vec3 boundsCenter;
+        float boundsRadius = 0.0f;
+        glm::vec3 Ka, Kd, Ks;
+        float Ns = 0.0f;
+        std::vector<GLfloat> interleaved;
+    };
+    std::vector<ObjectLoad> objectLoads(objects.size());
+    uint64_t arenaAllocations = LinearArena::getTotalAllocations();
+    uint64_t arenaBlocks = LinearArena::getTotalBlockAllocations();
+    JobSystem::shared().parallelFor((int)objects.size(), [this, &objectLoads](int index) {
+        const ObjectConfig& objConfig = objects[index];
+        ObjectLoad& load = objectLoads[index];
+        ArenaScope scratch(LinearArena::forThread());
+        std::pmr::vector<GLfloat> obj_vertices(&scratch.arena());
+        std::pmr::vector<GLfloat> obj_texcoords(&scratch.arena());
+        std::pmr::vector<GLfloat> obj_normals(&scratch.arena());
         int nVertices;
 
         nVertices = loadOBJ(objConfig.obj_path, obj_vertices, obj_texcoords, obj_normals);
         if (nVertices == -1) {
-            std::cerr << "Error loading OBJ: " << objConfig.obj_path << std::endl;
-            continue;
+            return;
         }
 
-        glm::vec3 Ka, Kd, Ks;
-        float Ns;
-        loadMaterials(objConfig.mtl_path, Ka, Kd, Ks, Ns);
-
-        GLuint objTexID = loadTexture(objConfig.texture_path);
+        glm::vec3 boundsMin(1e30f), boundsMax(-1e30f);
+        for (int i = 0; i < nVertices; ++i) {
+            glm::vec3 p(obj_vertices[i * 3 + 0], obj_vertices[i * 3 + 1], obj_vertices[i * 3 + 2]);
+            boundsMin = glm::min(boundsMin, p);
+            boundsMax = glm::max(boundsMax, p);
+        }
+        glm::vec3 boundsCenter = (boundsMin + boundsMax) * 0.5f;
+        float boundsRadius = 0.0f;
+        for (int i = 0; i < nVertices; ++i) {
+            glm::vec3 p(obj_vertices[i * 3 + 0], obj_vertices[i * 3 + 1], obj_vertices[i * 3 + 2]);
+            boundsRadius = glm::max(boundsRadius, glm::length(p - boundsCenter));
+        }
 
-        GLuint VAO, VBO;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        loadMaterials(objConfig.mtl_path, load.Ka, load.Kd, load.Ks, load.Ns);
 
-        std::vector<GLfloat> interleaved_data;
+        std::vector<GLfloat>& interleaved_data = load.interleaved;
         interleaved_data.reserve(nVertices * 8); 
 
         for (int i = 0; i < nVertices; ++i) {
@@ -264,40 +473,179 @@ void Scene::setupScene(GLFWwindow* window, Shader* shader, Camera* camera, std::
             interleaved_data.push_back(obj_texcoords[i * 2 + 0]);
             interleaved_data.push_back(obj_texcoords[i * 2 + 1]);
         }
-        
-        glBufferData(GL_ARRAY_BUFFER, interleaved_data.size() * sizeof(GLfloat), interleaved_data.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(6 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(2);
+        load.nVertices = nVertices;
+        load.boundsCenter = boundsCenter;
+        load.boundsRadius = boundsRadius;
+    }, 1);
+    std::cout << "Rascunho da carga: " << LinearArena::getTotalAllocations() - arenaAllocations << " alocações no arena, "
+              << LinearArena::getTotalBlockAllocations() - arenaBlocks << " blocos pedidos ao heap" << std::endl;
+
+    for (size_t index = 0; index < objects.size(); ++index) {
+        const ObjectConfig& objConfig = objects[index];
+        ObjectLoad& load = objectLoads[index];
+        if (load.nVertices == -1) {
+            std::cerr << "Error loading OBJ: " << objConfig.obj_path << std::endl;
+            continue;
+        }
+        int nVertices = load.nVertices;
+        std::vector<GLfloat>& interleaved_data = load.interleaved;
+
+        // UVs fora de [0, 1] dependem do GL_REPEAT: esses objetos continuam com a textura própria
+        std::string texturePath = objConfig.texture_path;
+        const TextureAtlasEntry* atlasEntry = atlasTextures && !arrayTextures ? atlas.find(texturePath) : nullptr;
+        if (atlasEntry && TextureAtlas::uvsInUnitSquare(interleaved_data)) {
+            atlas.remapUVs(*atlasEntry, interleaved_data);
+            texturePath = atlas.getPagePath(atlasEntry->page);
+        } else {
+            atlasEntry = nullptr;
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        TextureArraySlot arraySlot = arrayTextures ? textureArrays.find(texturePath) : TextureArraySlot();
+        GLuint objTexID = 0;
+        int textureResource = -1;
+        if (arraySlot.layer >= 0) {
+            objTexID = arraySlot.texture;
+        } else if (uploadToGpu) {
+            const OwnedTexture& owned = loadTexture(texturePath, atlasEntry ? (int)atlas.getMaxLod() : -1);
+            objTexID = owned.texture.get();
+            textureResource = owned.resource;
+        }
+        if (objTexID != 0 && atlasEntry) {
+            // Sem os mips em que as imagens vizinhas se misturam. O MAX_LOD é relativo ao BASE_LEVEL, então
+            // só vale para as síncronas (BASE_LEVEL 0); o loader corta a cadeia no nível absoluto
+            glBindTexture(GL_TEXTURE_2D, objTexID);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_LOD, atlas.getMaxLod());
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
 
         Mesh mesh;
-        mesh.initialize(VAO, nVertices, shader);
+        mesh.initialize(nullptr, nVertices, shader);
         mesh.setPosition(objConfig.initial_transform.position);
         mesh.setRotation(objConfig.initial_transform.rotation_angle, objConfig.initial_transform.rotation_axis);
         mesh.setScale(objConfig.initial_transform.scale);
-        mesh.setTextureID(objTexID);
-        mesh.setMaterialProperties(Ka, Kd, Ks, Ns);
+        mesh.setTextureID(objTexID, textureResource);
+        mesh.setTextureLayer(objTexID != 0 ? arraySlot.layer : -1);
+        mesh.setTextureExtent(uvExtent(interleaved_data));
+        mesh.setMaterialProperties(load.Ka, load.Kd, load.Ks, load.Ns);
+        mesh.setBounds(load.boundsCenter, load.boundsRadius);
+        mesh.update(false, false, false);
         meshes.push_back(mesh);
+        loaded.push_back(&objConfig);
+        loadedTextures.push_back(texturePath);
+        vertexData.push_back(std::move(interleaved_data));
 
+        // Só objetos animados têm curva
+        LoadedObject loadedObject = { index, -1 };
         if (objConfig.animation.type == "bezier" && objConfig.animation.control_points.size() >= 4) {
             Bezier bezier;
             bezier.setShader(shader);
+            bezier.setGpuUpload(uploadToGpu);
             bezier.setControlPoints(objConfig.animation.control_points);
             bezier.generateCurve(100);
             bezier.setSpeed(objConfig.animation.speed);
             bezier.setFollowTrajectory(objConfig.animation.follow_trajectory);
+            loadedObject.curve = (int)bezierCurves.size();
             bezierCurves.push_back(bezier);
-        } else {
-            Bezier bezier;
-            bezier.setFollowTrajectory(false);
-            bezierCurves.push_back(bezier);
+        }
+        loadedObjects.push_back(loadedObject);
+    }
+
+    // Oclusão e lightmaps dos estáticos na pose inicial; objetos animados não entram como oclusores
+    std::vector<glm::vec3> occluders;
+    if (bakeAmbientOcclusion || bakeLightmaps) {
+        for (size_t i = 0; i < loaded.size(); ++i) {
+            if (loaded[i]->animation.type != "none") continue;
+            const glm::mat4& model = meshes[firstMesh + i].getModelMatrix();
+            for (size_t v = 0; v + 8 <= vertexData[i].size(); v += 8) {
+                occluders.push_back(glm::vec3(model * glm::vec4(vertexData[i][v], vertexData[i][v + 1], vertexData[i][v + 2], 1.0f)));
+            }
+        }
+    }
+
+    std::vector<std::vector<GLfloat>> occlusion(loaded.size());
+    if (bakeAmbientOcclusion) {
+        if (!occluders.empty()) {
+            AmbientOcclusionBaker baker;
+            baker.setSampleCount(ambientOcclusionSamples);
+            baker.setMaxDistance(ambientOcclusionDistance);
+            baker.setOccluders(occluders);
+            for (size_t i = 0; i < loaded.size(); ++i) {
+                if (loaded[i]->animation.type != "none") continue;
+                occlusion[i] = baker.bake(vertexData[i], meshes[firstMesh + i].getModelMatrix());
+            }
+            std::cout << "Oclusão ambiente: " << baker.getBakedMeshes() << " objetos assados (" << baker.getRayCount() << " raios), "
+                      << baker.getCacheHits() << " do cache, " << baker.getBakeMs() << " ms" << std::endl;
+        }
+    }
+
+    std::vector<Lightmap> lightmaps(loaded.size());
+    if (bakeLightmaps && !occluders.empty() && !lightSources.empty()) {
+        LightmapBaker baker;
+        baker.setResolution(lightmapResolution);
+        baker.setOccluders(occluders);
+        baker.setLights(lightSources);
+        for (size_t i = 0; i < loaded.size(); ++i) {
+            if (loaded[i]->animation.type != "none") continue;
+            baker.bake(vertexData[i], meshes[firstMesh + i].getModelMatrix(), lightmaps[i]);
+        }
+        std::cout << "Lightmaps " << lightmapResolution << "x" << lightmapResolution << ": " << baker.getBakedMeshes() << " objetos assados, "
+                  << baker.getCacheHits() << " do cache, " << baker.getBakeMs() << " ms" << std::endl;
+    }
+
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        Mesh& mesh = meshes[firstMesh + i];
+        std::vector<GLfloat>& interleaved_data = vertexData[i];
+        int nVertices = (int)(interleaved_data.size() / 8);
+
+        if (uploadToGpu) {
+            // Atributo 3: oclusão por vértice (1 nos objetos sem bake); atributo 4 e textura RGB16F só
+            // nos objetos com lightmap (permutação LIGHTMAP)
+            std::vector<GLfloat> ones;
+            const std::vector<GLfloat>* vertexOcclusion = &occlusion[i];
+            if (vertexOcclusion->empty()) {
+                ones.assign(nVertices, 1.0f);
+                vertexOcclusion = &ones;
+            }
+            GpuResources& resources = GpuResources::instance();
+            auto geometry = std::make_shared<GpuGeometry>();
+            size_t bytes = createGeometry(*geometry, interleaved_data, *vertexOcclusion, lightmaps[i].uvs);
+            if (resources.hasBudget()) {
+                // Despejável: uma cópia em CPU recria os buffers (o ponteiro cru vale enquanto o registro existir)
+                auto source = std::make_shared<std::vector<std::vector<GLfloat>>>(
+                    std::vector<std::vector<GLfloat>>{ interleaved_data, *vertexOcclusion, lightmaps[i].uvs });
+                GpuGeometry* target = geometry.get();
+                geometry->resource = resources.add(GpuCategory::Geometry, bytes,
+                    [target]() { target->destroy(); },
+                    [target, source]() { return createGeometry(*target, (*source)[0], (*source)[1], (*source)[2]); });
+            } else {
+                geometry->resource = resources.add(GpuCategory::Geometry, bytes);
+            }
+            mesh.initialize(geometry, nVertices, shader);
+
+            if (!lightmaps[i].texels.empty()) {
+                OwnedTexture lightmap;
+                lightmap.texture = GLTexture::create();
+                GLuint texture = lightmap.texture.get();
+                bytes = uploadLightmap(texture, lightmaps[i]);
+                if (resources.hasBudget()) {
+                    auto source = std::make_shared<Lightmap>(lightmaps[i]);
+                    lightmap.resource = resources.add(GpuCategory::Lightmap, bytes,
+                        [texture]() { GpuResources::clearTexture(texture); },
+                        [texture, source]() { return uploadLightmap(texture, *source); });
+                } else {
+                    lightmap.resource = resources.add(GpuCategory::Lightmap, bytes);
+                }
+                mesh.setLightmap(texture, (int)lightSources.size(), lightmap.resource);
+                lightmaps_.push_back(std::move(lightmap));
+            }
+        }
+
+        if (keepCpuData) {
+            auto cpuData = std::make_shared<MeshCpuData>();
+            cpuData->vertices = std::move(interleaved_data);
+            cpuData->occlusion = std::move(occlusion[i]);
+            loadTextureCpu(loadedTextures[i], *cpuData);
+            mesh.setCpuData(cpuData);
         }
     }
 }
\ No newline at end of file
@@ -1 +1,164 @@
-#include "Shader.h"
\ No newline at end of file
+#include "Shader.h"
+#include "ShaderCache.h"
+#include "GLExtensions.h"
+
+#ifdef EMBED_SHADERS
+#include "EmbeddedShaders.h"
+#endif
+
+Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath) : ID(0), vertex_(0), fragment_(0), pending_(false)
+{
+    build(readSource(vertexPath), readSource(fragmentPath));
+}
+
+Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const ShaderDefines& defines)
+    : ID(0), vertex_(0), fragment_(0), pending_(false)
+{
+    build(injectDefines(readSource(vertexPath), defines), injectDefines(readSource(fragmentPath), defines));
+}
+
+Shader::~Shader()
+{
+    if (vertex_) glDeleteShader(vertex_);
+    if (fragment_) glDeleteShader(fragment_);
+}
+
+std::string Shader::readSource(const std::string& path)
+{
+#ifdef EMBED_SHADERS
+    // A tabela é indexada pelo nome do arquivo, sem diretório
+    size_t slash = path.find_last_of("/\\");
+    std::string fileName = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    for (const EmbeddedShader& shader : EMBEDDED_SHADERS)
+    {
+        if (fileName == shader.name)
+            return shader.source;
+    }
+#endif
+
+    std::string code;
+    std::ifstream shaderFile;
+    shaderFile.exceptions(std::ifstream::badbit);
+    try
+    {
+        shaderFile.open(path);
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        shaderFile.close();
+        code = shaderStream.str();
+    }
+    catch (std::ifstream::failure& e)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+    }
+    return code;
+}
+
+std::string Shader::injectDefines(const std::string& source, const ShaderDefines& defines)
+{
+    if (defines.empty())
+        return source;
+
+    std::string block;
+    for (const auto& define : defines)
+    {
+        block += "#define " + define.first;
+        if (!define.second.empty())
+            block += " " + define.second;
+        block += "\n";
+    }
+
+    // #version precisa ser a primeira diretiva; sem ela os defines vão para o início
+    size_t version = source.find("#version");
+    if (version == std::string::npos)
+        return block + "#line 1\n" + source;
+
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos)
+        return source + "\n" + block;
+
+    size_t nextLine = 2;
+    for (size_t i = 0; i < version; ++i)
+        if (source[i] == '\n') ++nextLine;
+
+    return source.substr(0, lineEnd + 1) + block + "#line " + std::to_string(nextLine) + "\n" + source.substr(lineEnd + 1);
+}
+
+// Só envia o trabalho ao driver: nenhuma consulta de status aqui, para que vários programas
+// compilem em paralelo (GL_KHR_parallel_shader_compile) enquanto a CPU carrega a cena
+void Shader::build(const std::string& vertexCode, const std::string& fragmentCode)
+{
+    ShaderCache& cache = ShaderCache::instance();
+    if (cache.isActive())
+    {
+        cacheKey_ = cache.makeKey(vertexCode, fragmentCode);
+        program_.reset(cache.load(cacheKey_));
+        this->ID = program_.get();
+        if (this->ID != 0)
+            return;
+    }
+
+    const GLchar* vShaderCode = vertexCode.c_str();
+    const GLchar * fShaderCode = fragmentCode.c_str();
+    vertex_ = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex_, 1, &vShaderCode, NULL);
+    glCompileShader(vertex_);
+    fragment_ = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment_, 1, &fShaderCode, NULL);
+    glCompileShader(fragment_);
+    program_ = GLProgram::create();
+    this->ID = program_.get();
+    glAttachShader(this->ID, vertex_);
+    glAttachShader(this->ID, fragment_);
+    if (!cacheKey_.empty())
+        GLExtensions::ProgramParameteri(this->ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(this->ID);
+    pending_ = true;
+}
+
+bool Shader::isReady() const
+{
+    if (!pending_ || !GLExtensions::hasParallelShaderCompile())
+        return true;
+
+    GLint done = GL_FALSE;
+    glGetProgramiv(this->ID, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+void Shader::finish()
+{
+    if (!pending_)
+        return;
+    pending_ = false;
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(vertex_, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(vertex_, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+    glGetShaderiv(fragment_, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(fragment_, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+    glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+    else if (!cacheKey_.empty())
+    {
+        ShaderCache::instance().store(this->ID, cacheKey_);
+    }
+    glDetachShader(this->ID, vertex_);
+    glDetachShader(this->ID, fragment_);
+    glDeleteShader(vertex_);
+    glDeleteShader(fragment_);
+    vertex_ = fragment_ = 0;
+}
@@ -0,0 +1,143 @@
+#include "ShaderCache.h"
+#include "GLExtensions.h"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x43425053; // "SPBC"
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t binaryFormat;
+        uint32_t length;
+    };
+
+    void fnv1a(uint64_t& hash, const std::string& text)
+    {
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        // separador para que "ab"+"c" e "a"+"bc" gerem chaves diferentes
+        hash ^= 0xFF;
+        hash *= 1099511628211ULL;
+    }
+}
+
+ShaderCache::ShaderCache() : directory_("../cache/shaders/"), enabled_(true), hits_(0), misses_(0)
+{
+}
+
+ShaderCache& ShaderCache::instance()
+{
+    static ShaderCache cache;
+    return cache;
+}
+
+bool ShaderCache::isActive() const
+{
+    return enabled_ && GLExtensions::hasProgramBinary();
+}
+
+std::string ShaderCache::makeKey(const std::string& vertexCode, const std::string& fragmentCode) const
+{
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+    uint64_t hash = 14695981039346656037ULL;
+    fnv1a(hash, vertexCode);
+    fnv1a(hash, fragmentCode);
+    fnv1a(hash, renderer ? renderer : "");
+    fnv1a(hash, version ? version : "");
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return hex;
+}
+
+std::string ShaderCache::pathFor(const std::string& key) const
+{
+    return directory_ + key + ".bin";
+}
+
+GLuint ShaderCache::load(const std::string& key)
+{
+    if (!isActive()) return 0;
+
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file.is_open())
+    {
+        ++misses_;
+        return 0;
+    }
+
+    CacheHeader header;
+    std::vector<char> binary;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        header.magic == CACHE_MAGIC && header.version == CACHE_VERSION && header.length > 0)
+    {
+        binary.resize(header.length);
+        if (!file.read(binary.data(), header.length)) binary.clear();
+    }
+    file.close();
+
+    if (binary.empty())
+    {
+        std::remove(pathFor(key).c_str());
+        ++misses_;
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    GLExtensions::ProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // Driver atualizado ou binário corrompido: descarta e deixa o chamador compilar
+        glDeleteProgram(program);
+        std::remove(pathFor(key).c_str());
+        ++misses_;
+        return 0;
+    }
+
+    ++hits_;
+    return program;
+}
+
+void ShaderCache::store(GLuint program, const std::string& key)
+{
+    if (!isActive()) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    GLExtensions::GetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+
+    std::ofstream file(pathFor(key), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "ShaderCache: não foi possível gravar " << pathFor(key) << std::endl;
+        return;
+    }
+
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, (uint32_t)format, (uint32_t)written };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), written);
+}
@@ -0,0 +1,42 @@
+#include "ShaderLibrary.h"
+
+ShaderLibrary::ShaderLibrary(const std::string& shaderDir) : shaderDir_(shaderDir)
+{
+}
+
+Shader* ShaderLibrary::get(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines)
+{
+    std::string key = makeKey(vertexFile, fragmentFile, defines);
+    auto found = variants_.find(key);
+    if (found != variants_.end())
+        return found->second.get();
+
+    std::string vertexPath = shaderDir_ + vertexFile;
+    std::string fragmentPath = shaderDir_ + fragmentFile;
+    Shader* shader = new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines);
+    variants_[key].reset(shader);
+    return shader;
+}
+
+int ShaderLibrary::getPendingCount() const
+{
+    int pending = 0;
+    for (const auto& variant : variants_)
+        if (!variant.second->isReady()) ++pending;
+    return pending;
+}
+
+void ShaderLibrary::finishAll()
+{
+    for (auto& variant : variants_)
+        variant.second->finish();
+}
+
+// O std::map já mantém os defines ordenados, então a mesma combinação sempre gera a mesma chave
+std::string ShaderLibrary::makeKey(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines)
+{
+    std::string key = vertexFile + "|" + fragmentFile;
+    for (const auto& define : defines)
+        key += "|" + define.first + "=" + define.second;
+    return key;
+}
@@ -0,0 +1,309 @@
+#include "ShadowMaps.h"
+#include "GpuResources.h"
+#include "LinearArena.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    void hashBytes(unsigned long long& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    GLuint createDepthAtlas(int size)
+    {
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return tex;
+    }
+
+    GLuint createDepthFBO(GLuint depthTexture)
+    {
+        GLuint fbo;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "ShadowMaps: framebuffer de profundidade incompleto" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return fbo;
+    }
+}
+
+ShadowMaps::ShadowMaps() :
+    atlasSize_(0), staticAtlas_(0), frameAtlas_(0), staticFBO_(0), frameFBO_(0), resource_(-1),
+    staticHash_(0), staticValid_(false), staticRebuilds_(0)
+{
+}
+
+ShadowMaps::~ShadowMaps()
+{
+    release();
+}
+
+void ShadowMaps::release()
+{
+    allocateAtlas(0);
+    depthShader_.reset();
+    shadowed_.clear();
+    staticValid_ = false;
+}
+
+bool ShadowMaps::initialize(const std::string& shaderDir)
+{
+    depthShader_.reset(new Shader((shaderDir + "shadow_depth.vs").c_str(), (shaderDir + "shadow_depth.fs").c_str()));
+    // Atlas mínimo para que o sampler sempre tenha uma textura de profundidade válida
+    allocateAtlas(16);
+    return depthShader_->ID != 0;
+}
+
+void ShadowMaps::allocateAtlas(int size)
+{
+    if (staticFBO_) glDeleteFramebuffers(1, &staticFBO_);
+    if (frameFBO_) glDeleteFramebuffers(1, &frameFBO_);
+    if (staticAtlas_) glDeleteTextures(1, &staticAtlas_);
+    if (frameAtlas_) glDeleteTextures(1, &frameAtlas_);
+    staticFBO_ = frameFBO_ = staticAtlas_ = frameAtlas_ = 0;
+    GpuResources::instance().remove(resource_);
+    resource_ = -1;
+    atlasSize_ = size;
+    if (size == 0) return;
+
+    // Dois atlas DEPTH_COMPONENT24 (4 bytes por texel no driver)
+    resource_ = GpuResources::instance().add(GpuCategory::RenderTarget, (size_t)size * size * 4 * 2);
+
+    staticAtlas_ = createDepthAtlas(size);
+    frameAtlas_ = createDepthAtlas(size);
+    staticFBO_ = createDepthFBO(staticAtlas_);
+    frameFBO_ = createDepthFBO(frameAtlas_);
+}
+
+// Chamado todo frame: as listas de comparação saem do arena do thread
+void ShadowMaps::layoutAtlas(const std::vector<LightSourceConfig>& lights)
+{
+    ArenaScope scope(LinearArena::forThread());
+    std::pmr::vector<ShadowedLight> wanted(&scope.arena());
+    for (size_t i = 0; i < lights.size() && (int)wanted.size() < MAX_SHADOWED_LIGHTS; ++i)
+    {
+        if (!lights[i].castsShadows) continue;
+        ShadowedLight s;
+        s.lightIndex = (int)i;
+        s.resolution = glm::clamp(lights[i].shadowResolution, 64, MAX_ATLAS_SIZE / 2);
+        wanted.push_back(s);
+    }
+
+    bool same = wanted.size() == shadowed_.size();
+    for (size_t i = 0; same && i < wanted.size(); ++i)
+        same = wanted[i].lightIndex == shadowed_[i].lightIndex && wanted[i].resolution == shadowed_[i].resolution;
+    if (same) return;
+
+    // Prateleiras: maiores primeiro, atlas quadrado dobrando até caber
+    std::pmr::vector<ShadowedLight*> order(&scope.arena());
+    for (auto& s : wanted) order.push_back(&s);
+    std::sort(order.begin(), order.end(), [](const ShadowedLight* a, const ShadowedLight* b) {
+        return a->resolution > b->resolution;
+    });
+
+    int size = order.empty() ? 16 : order[0]->resolution;
+    while (true)
+    {
+        int x = 0, y = 0, shelfHeight = 0;
+        bool fits = true;
+        for (ShadowedLight* s : order)
+        {
+            if (x + s->resolution > size)
+            {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (y + s->resolution > size) { fits = false; break; }
+            s->rect = glm::ivec4(x, y, s->resolution, s->resolution);
+            x += s->resolution;
+            shelfHeight = std::max(shelfHeight, s->resolution);
+        }
+        if (fits || size >= MAX_ATLAS_SIZE) break;
+        size *= 2;
+    }
+
+    shadowed_.assign(wanted.begin(), wanted.end());
+    if (size != atlasSize_) allocateAtlas(size);
+    staticValid_ = false;
+}
+
+void ShadowMaps::fitFrustums(const std::vector<LightSourceConfig>& lights, const std::vector<Mesh>& meshes)
+{
+    // Esfera que envolve a cena, folgada para objetos animados que saem da posição inicial
+    glm::vec3 center(0.0f);
+    for (const auto& mesh : meshes) center += mesh.getWorldBoundsCenter();
+    if (!meshes.empty()) center /= (float)meshes.size();
+    float radius = 1.0f;
+    for (const auto& mesh : meshes)
+        radius = std::max(radius, glm::length(mesh.getWorldBoundsCenter() - center) + mesh.getWorldBoundsRadius());
+    radius *= 1.5f;
+
+    for (auto& s : shadowed_)
+    {
+        glm::vec3 lightPos = lights[s.lightIndex].position;
+        glm::vec3 toCenter = center - lightPos;
+        float dist = glm::length(toCenter);
+
+        float fov, nearPlane;
+        if (dist > radius * 1.01f)
+        {
+            fov = 2.0f * std::asin(radius / dist);
+            nearPlane = std::max(dist - radius, 0.05f);
+        }
+        else
+        {
+            fov = glm::radians(120.0f);
+            nearPlane = 0.05f;
+        }
+        float farPlane = dist + radius;
+
+        glm::vec3 dir = dist > 0.0f ? toCenter / dist : glm::vec3(0.0f, -1.0f, 0.0f);
+        glm::vec3 up = std::abs(dir.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 view = glm::lookAt(lightPos, lightPos + dir, up);
+        glm::mat4 projection = glm::perspective(fov, 1.0f, nearPlane, farPlane);
+        s.viewProjection = projection * view;
+
+        // NDC -> região da luz no atlas
+        float sx = 0.5f * s.rect.z / atlasSize_;
+        float sy = 0.5f * s.rect.w / atlasSize_;
+        float ox = (float)s.rect.x / atlasSize_;
+        float oy = (float)s.rect.y / atlasSize_;
+        glm::mat4 bias(sx,      0.0f,    0.0f, 0.0f,
+                       0.0f,    sy,      0.0f, 0.0f,
+                       0.0f,    0.0f,    0.5f, 0.0f,
+                       ox + sx, oy + sy, 0.5f, 1.0f);
+        s.atlasMatrix = bias * s.viewProjection;
+    }
+}
+
+unsigned long long ShadowMaps::staticStateHash(const std::vector<LightSourceConfig>& lights, const std::vector<Mesh>& meshes,
+                                               const std::vector<bool>& isStatic) const
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (const auto& s : shadowed_)
+        hashBytes(hash, &lights[s.lightIndex].position, sizeof(glm::vec3));
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        if (i < isStatic.size() && isStatic[i])
+            hashBytes(hash, &meshes[i].getModelMatrix(), sizeof(glm::mat4));
+    }
+    return hash;
+}
+
+void ShadowMaps::renderCasters(const std::vector<Mesh>& meshes, const std::vector<bool>& isStatic, bool staticPass)
+{
+    for (const auto& s : shadowed_)
+    {
+        glViewport(s.rect.x, s.rect.y, s.rect.z, s.rect.w);
+        glScissor(s.rect.x, s.rect.y, s.rect.z, s.rect.w);
+        depthShader_->setMat4("lightViewProjection", s.viewProjection);
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            bool meshIsStatic = i < isStatic.size() && isStatic[i];
+            if (meshIsStatic == staticPass)
+                meshes[i].drawDepth(depthShader_.get());
+        }
+    }
+}
+
+void ShadowMaps::update(const std::vector<LightSourceConfig>& lights, const std::vector<Mesh>& meshes,
+                        const std::vector<bool>& isStatic)
+{
+    if (!depthShader_) return;
+
+    layoutAtlas(lights);
+    if (shadowed_.empty()) return;
+
+    unsigned long long hash = staticStateHash(lights, meshes, isStatic);
+    bool rebuildStatic = !staticValid_ || hash != staticHash_;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint outputFBO = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &outputFBO);
+
+    depthShader_->Use();
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    if (rebuildStatic)
+    {
+        fitFrustums(lights, meshes);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, staticFBO_);
+        glViewport(0, 0, atlasSize_, atlasSize_);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_SCISSOR_TEST);
+        renderCasters(meshes, isStatic, true);
+        glDisable(GL_SCISSOR_TEST);
+
+        staticHash_ = hash;
+        staticValid_ = true;
+        ++staticRebuilds_;
+    }
+
+    // Camada do frame: parte da cópia do cache estático e recebe só os objetos animados
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFBO_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frameFBO_);
+    glBlitFramebuffer(0, 0, atlasSize_, atlasSize_, 0, 0, atlasSize_, atlasSize_, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, frameFBO_);
+    glEnable(GL_SCISSOR_TEST);
+    renderCasters(meshes, isStatic, false);
+    glDisable(GL_SCISSOR_TEST);
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void ShadowMaps::bind(Shader* shader) const
+{
+    shader->Use();
+    shader->setInt("shadowAtlas", ATLAS_TEXTURE_UNIT);
+    shader->setInt("staticShadowAtlas", STATIC_ATLAS_TEXTURE_UNIT);
+    shader->setInt("shadowCount", (int)shadowed_.size());
+    shader->setFloat("shadowTexel", atlasSize_ > 0 ? 1.0f / atlasSize_ : 0.0f);
+
+    for (size_t i = 0; i < shadowed_.size(); ++i)
+    {
+        const ShadowedLight& s = shadowed_[i];
+        std::string index = "[" + std::to_string(i) + "]";
+        float halfTexel = 0.5f / atlasSize_;
+        shader->setMat4("shadowMatrix" + index, s.atlasMatrix);
+        shader->setInt("shadowLight" + index, s.lightIndex);
+        shader->setVec4("shadowRect" + index,
+                        (float)s.rect.x / atlasSize_ + halfTexel,
+                        (float)s.rect.y / atlasSize_ + halfTexel,
+                        (float)(s.rect.x + s.rect.z) / atlasSize_ - halfTexel,
+                        (float)(s.rect.y + s.rect.w) / atlasSize_ - halfTexel);
+    }
+
+    glActiveTexture(GL_TEXTURE0 + ATLAS_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, frameAtlas_);
+    glActiveTexture(GL_TEXTURE0 + STATIC_ATLAS_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, staticAtlas_);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,576 @@
+#include "SoftwareRasterizer.h"
+#include "TextureCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RASTER_USE_SSE 1
+#endif
+
+namespace {
+    // Quatro lanes = um quad 2x2 de pixels: (x, y), (x+1, y), (x, y+1), (x+1, y+1).
+    // As derivadas de tela (escolha do mip) saem da diferença entre lanes, como na GPU.
+    struct Float4 {
+#ifdef RASTER_USE_SSE
+        __m128 v;
+        Float4() {}
+        Float4(__m128 m) : v(m) {}
+        explicit Float4(float s) : v(_mm_set1_ps(s)) {}
+        Float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+        void store(float* out) const { _mm_storeu_ps(out, v); }
+#else
+        float v[4];
+        Float4() {}
+        explicit Float4(float s) { v[0] = v[1] = v[2] = v[3] = s; }
+        Float4(float a, float b, float c, float d) { v[0] = a; v[1] = b; v[2] = c; v[3] = d; }
+        void store(float* out) const { for (int i = 0; i < 4; ++i) out[i] = v[i]; }
+#endif
+    };
+
+#ifdef RASTER_USE_SSE
+    inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+    inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+    inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+    inline Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+    inline Float4 max4(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+    inline Float4 sqrt4(Float4 a) { return _mm_sqrt_ps(a.v); }
+    inline int cmpGreater(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a.v, b.v)); }
+    inline int cmpGreaterEqual(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmpge_ps(a.v, b.v)); }
+    inline int cmpLess(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+#else
+    template <typename Op>
+    inline Float4 lanes(Float4 a, Float4 b, Op op) { Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = op(a.v[i], b.v[i]); return r; }
+    template <typename Op>
+    inline int laneMask(Float4 a, Float4 b, Op op) { int m = 0; for (int i = 0; i < 4; ++i) if (op(a.v[i], b.v[i])) m |= 1 << i; return m; }
+
+    inline Float4 operator+(Float4 a, Float4 b) { return lanes(a, b, [](float x, float y) { return x + y; }); }
+    inline Float4 operator-(Float4 a, Float4 b) { return lanes(a, b, [](float x, float y) { return x - y; }); }
+    inline Float4 operator*(Float4 a, Float4 b) { return lanes(a, b, [](float x, float y) { return x * y; }); }
+    inline Float4 operator/(Float4 a, Float4 b) { return lanes(a, b, [](float x, float y) { return x / y; }); }
+    inline Float4 max4(Float4 a, Float4 b) { return lanes(a, b, [](float x, float y) { return x > y ? x : y; }); }
+    inline Float4 sqrt4(Float4 a) { return lanes(a, a, [](float x, float) { return std::sqrt(x); }); }
+    inline int cmpGreater(Float4 a, Float4 b) { return laneMask(a, b, [](float x, float y) { return x > y; }); }
+    inline int cmpGreaterEqual(Float4 a, Float4 b) { return laneMask(a, b, [](float x, float y) { return x >= y; }); }
+    inline int cmpLess(Float4 a, Float4 b) { return laneMask(a, b, [](float x, float y) { return x < y; }); }
+#endif
+
+    struct Vec3x4 {
+        Float4 x, y, z;
+    };
+
+    inline Float4 dot(const Vec3x4& a, const Vec3x4& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    inline Vec3x4 normalize(const Vec3x4& a)
+    {
+        Float4 inv = Float4(1.0f) / sqrt4(dot(a, a));
+        return { a.x * inv, a.y * inv, a.z * inv };
+    }
+
+    inline Vec3x4 fromPoint(glm::vec3 p, const Vec3x4& a)
+    {
+        return { Float4(p.x) - a.x, Float4(p.y) - a.y, Float4(p.z) - a.z };
+    }
+
+    inline Float4 interpolate(Float4 p0, Float4 p1, Float4 p2, float a0, float a1, float a2)
+    {
+        return p0 * Float4(a0) + p1 * Float4(a1) + p2 * Float4(a2);
+    }
+
+    struct ClipVertex {
+        glm::vec4 clip;
+        glm::vec3 world;
+        glm::vec3 normal;
+        glm::vec2 uv;
+        float occlusion;
+    };
+
+    ClipVertex lerpVertex(const ClipVertex& a, const ClipVertex& b, float t)
+    {
+        return { glm::mix(a.clip, b.clip, t), glm::mix(a.world, b.world, t), glm::mix(a.normal, b.normal, t), glm::mix(a.uv, b.uv, t),
+                 a.occlusion + (b.occlusion - a.occlusion) * t };
+    }
+
+    // GL_REPEAT + GL_LINEAR, mesmo centro de texel da OpenGL
+    glm::vec3 sampleBilinear(int width, int height, const unsigned char* texels, float u, float v)
+    {
+        // Repetição feita em ponto flutuante: o texel inicial fica em [-1, tamanho - 1], sem divisão inteira
+        float x = (u - std::floor(u)) * width - 0.5f;
+        float y = (v - std::floor(v)) * height - 0.5f;
+        float fx = std::floor(x), fy = std::floor(y);
+        float tx = x - fx, ty = y - fy;
+        int x0 = (int)fx, y0 = (int)fy;
+        int x1 = (x0 + 1 < width) ? x0 + 1 : 0;
+        int y1 = (y0 + 1 < height) ? y0 + 1 : 0;
+        if (x0 < 0) x0 = width - 1;
+        if (y0 < 0) y0 = height - 1;
+
+        const unsigned char* t00 = texels + ((size_t)y0 * width + x0) * 4;
+        const unsigned char* t10 = texels + ((size_t)y0 * width + x1) * 4;
+        const unsigned char* t01 = texels + ((size_t)y1 * width + x0) * 4;
+        const unsigned char* t11 = texels + ((size_t)y1 * width + x1) * 4;
+
+        glm::vec3 result;
+        for (int c = 0; c < 3; ++c)
+        {
+            float top = t00[c] + (t10[c] - t00[c]) * tx;
+            float bottom = t01[c] + (t11[c] - t01[c]) * tx;
+            result[c] = (top + (bottom - top) * ty) * (1.0f / 255.0f);
+        }
+        return result;
+    }
+
+    inline unsigned char toByte(float value)
+    {
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return (unsigned char)(value * 255.0f + 0.5f);
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer() :
+    width_(0), height_(0), tilesX_(0), tilesY_(0), clearColor_(0.2f, 0.3f, 0.3f), jobs_(nullptr), environment_(nullptr),
+    meshes_(nullptr), viewPos_(0.0f), lastMs_(0.0), lastTriangles_(0)
+{
+}
+
+void SoftwareRasterizer::resize(int width, int height)
+{
+    width_ = width;
+    height_ = height;
+    tilesX_ = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY_ = (height + TILE_SIZE - 1) / TILE_SIZE;
+    color_.assign((size_t)width * height * 4, 0);
+}
+
+const SoftwareRasterizer::Texture* SoftwareRasterizer::getTexture(const MeshCpuData* data)
+{
+    auto found = textures_.find(data);
+    if (found != textures_.end())
+        return &found->second;
+
+    // Cadeia de mips com o mesmo filtro de caixa 2x2 dos arquivos cozidos (e do glGenerateMipmap)
+    Texture& texture = textures_[data];
+    texture.levels.push_back({ data->textureWidth, data->textureHeight, data->texture });
+    while (texture.levels.back().width > 1 || texture.levels.back().height > 1)
+    {
+        const MipLevel& src = texture.levels.back();
+        MipLevel dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.texels.resize((size_t)dst.width * dst.height * 4);
+        TextureCache::downsample(src.texels.data(), src.width, src.height, dst.texels.data());
+        texture.levels.push_back(std::move(dst));
+    }
+    return &texture;
+}
+
+void SoftwareRasterizer::render(const Camera& camera, const std::vector<Mesh>& meshes, const std::vector<LightSourceConfig>& lights)
+{
+    auto start = std::chrono::steady_clock::now();
+    JobSystem& jobs = jobs_ ? *jobs_ : JobSystem::shared();
+
+    // Estado do frame: materiais, texturas e luzes, já no formato usado pelo object.fs
+    meshes_ = &meshes;
+    meshStates_.resize(meshes.size());
+    meshFirstTriangle_.assign(meshes.size() + 1, 0);
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const MeshCpuData* data = meshes[i].getCpuData();
+        MeshState& state = meshStates_[i];
+        state.Ka = meshes[i].getKa();
+        state.Kd = meshes[i].getKd();
+        state.Ks = meshes[i].getKs();
+        state.Ns = meshes[i].getNs();
+        state.texture = (data && !data->texture.empty()) ? getTexture(data) : nullptr;
+        meshFirstTriangle_[i + 1] = meshFirstTriangle_[i] + (data ? data->vertices.size() / 24 : 0);
+    }
+
+    // Mesmos coeficientes que ClusteredLighting envia no bloco Lights
+    for (int i = 0; i < EnvironmentLighting::SH_COEFFICIENTS; ++i)
+        shAmbient_[i] = environment_ ? environment_->getCoefficients()[i] : glm::vec3(0.0f);
+
+    lights_.clear();
+    for (const auto& light : lights)
+    {
+        shAmbient_[0] += light.ambient;
+        lights_.push_back({ light.position, light.range(), light.diffuse * light.intensity, light.specular * light.intensity });
+    }
+    viewPos_ = camera.getCameraPos();
+    glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+
+    int chunkCount = (int)jobs.getThreadCount();
+    chunkTriangles_.resize(chunkCount);
+    chunkBins_.resize(chunkCount);
+    for (auto& bins : chunkBins_)
+        bins.resize((size_t)tilesX_ * tilesY_);
+
+    jobs.parallelFor(chunkCount, [this, chunkCount, &viewProjection](int chunk) { setupChunk(chunk, chunkCount, viewProjection); });
+    jobs.parallelFor(tilesX_ * tilesY_, [this](int tile) { rasterizeTile(tile); });
+
+    lastTriangles_ = 0;
+    for (const auto& triangles : chunkTriangles_)
+        lastTriangles_ += triangles.size();
+    lastMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SoftwareRasterizer::setupChunk(int chunk, int chunkCount, const glm::mat4& viewProjection)
+{
+    chunkTriangles_[chunk].clear();
+    for (auto& bin : chunkBins_[chunk])
+        bin.clear();
+
+    size_t total = meshFirstTriangle_.back();
+    size_t begin = total * chunk / chunkCount;
+    size_t end = total * (chunk + 1) / chunkCount;
+    if (begin >= end) return;
+
+    int mesh = (int)(std::upper_bound(meshFirstTriangle_.begin(), meshFirstTriangle_.end(), begin) - meshFirstTriangle_.begin()) - 1;
+    int currentMesh = -1;
+    glm::mat4 model(1.0f);
+    glm::mat3 normalMatrix(1.0f);
+
+    for (size_t t = begin; t < end; ++t)
+    {
+        while (t >= meshFirstTriangle_[mesh + 1]) ++mesh;
+        if (mesh != currentMesh)
+        {
+            currentMesh = mesh;
+            model = (*meshes_)[mesh].getModelMatrix();
+            normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+        }
+
+        const MeshCpuData* data = (*meshes_)[mesh].getCpuData();
+        size_t firstVertex = (t - meshFirstTriangle_[mesh]) * 3;
+        const float* v = &data->vertices[firstVertex * 8];
+        ClipVertex in[3];
+        int inside = 0;
+        for (int k = 0; k < 3; ++k, v += 8)
+        {
+            glm::vec4 world = model * glm::vec4(v[0], v[1], v[2], 1.0f);
+            in[k].world = glm::vec3(world);
+            in[k].clip = viewProjection * world;
+            in[k].normal = normalMatrix * glm::vec3(v[3], v[4], v[5]);
+            in[k].uv = glm::vec2(v[6], v[7]);
+            in[k].occlusion = data->occlusion.empty() ? 1.0f : data->occlusion[firstVertex + k];
+            if (in[k].clip.z >= -in[k].clip.w) ++inside;
+        }
+        if (inside == 0) continue;
+
+        // Recorte contra o plano near (z >= -w); os outros planos ficam com o recorte do bbox na tela
+        ClipVertex polygon[4];
+        int count = 0;
+        if (inside == 3)
+        {
+            polygon[0] = in[0]; polygon[1] = in[1]; polygon[2] = in[2];
+            count = 3;
+        }
+        else
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const ClipVertex& a = in[k];
+                const ClipVertex& b = in[(k + 1) % 3];
+                float da = a.clip.z + a.clip.w;
+                float db = b.clip.z + b.clip.w;
+                if (da >= 0.0f) polygon[count++] = a;
+                if ((da >= 0.0f) != (db >= 0.0f)) polygon[count++] = lerpVertex(a, b, da / (da - db));
+            }
+        }
+
+        for (int k = 1; k + 1 < count; ++k)
+        {
+            glm::vec4 clip[3] = { polygon[0].clip, polygon[k].clip, polygon[k + 1].clip };
+            glm::vec3 world[3] = { polygon[0].world, polygon[k].world, polygon[k + 1].world };
+            glm::vec3 normal[3] = { polygon[0].normal, polygon[k].normal, polygon[k + 1].normal };
+            glm::vec2 uv[3] = { polygon[0].uv, polygon[k].uv, polygon[k + 1].uv };
+            float occlusion[3] = { polygon[0].occlusion, polygon[k].occlusion, polygon[k + 1].occlusion };
+            addTriangle(chunk, mesh, clip, world, normal, uv, occlusion);
+        }
+    }
+}
+
+void SoftwareRasterizer::addTriangle(int chunk, int mesh, const glm::vec4 clip[3], const glm::vec3 world[3], const glm::vec3 normal[3], const glm::vec2 uv[3],
+                                     const float occlusion[3])
+{
+    float sx[3], sy[3], depth[3], invW[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        invW[k] = 1.0f / clip[k].w;
+        sx[k] = (clip[k].x * invW[k] * 0.5f + 0.5f) * width_;
+        sy[k] = (clip[k].y * invW[k] * 0.5f + 0.5f) * height_;
+        depth[k] = clip[k].z * invW[k] * 0.5f + 0.5f;
+    }
+
+    float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+    if (std::fabs(area) < 1e-8f) return;
+
+    // Sem culling (a OpenGL do trab desenha as duas faces): inverte a ordem dos horários
+    int order[3] = { 0, 1, 2 };
+    if (area < 0.0f)
+    {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    Triangle tri;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    for (int k = 0; k < 3; ++k)
+    {
+        int i = order[k];
+        tri.depth[k] = depth[i];
+        tri.invW[k] = invW[i];
+        tri.world[k] = world[i];
+        tri.normal[k] = normal[i];
+        tri.uv[k] = uv[i];
+        tri.occlusion[k] = occlusion[i];
+        minX = std::min(minX, sx[i]); maxX = std::max(maxX, sx[i]);
+        minY = std::min(minY, sy[i]); maxY = std::max(maxY, sy[i]);
+    }
+
+    // Aresta k é a oposta ao vértice k; a função vale a área (x2) no próprio vértice
+    for (int k = 0; k < 3; ++k)
+    {
+        int a = order[(k + 1) % 3];
+        int b = order[(k + 2) % 3];
+        tri.edgeA[k] = sy[a] - sy[b];
+        tri.edgeB[k] = sx[b] - sx[a];
+        tri.edgeC[k] = sx[a] * sy[b] - sy[a] * sx[b];
+        // Regra top-left: uma aresta compartilhada aparece com sinais opostos nos dois triângulos,
+        // então exatamente um deles fica com os pixels sobre ela
+        tri.topLeft[k] = tri.edgeA[k] > 0.0f || (tri.edgeA[k] == 0.0f && tri.edgeB[k] < 0.0f);
+    }
+    tri.invArea = 1.0f / area;
+
+    tri.minX = std::max(0, (int)std::floor(minX));
+    tri.minY = std::max(0, (int)std::floor(minY));
+    tri.maxX = std::min(width_ - 1, (int)std::ceil(maxX));
+    tri.maxY = std::min(height_ - 1, (int)std::ceil(maxY));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+    tri.mesh = mesh;
+
+    std::vector<Triangle>& triangles = chunkTriangles_[chunk];
+    int index = (int)triangles.size();
+    triangles.push_back(tri);
+
+    std::vector<std::vector<int>>& bins = chunkBins_[chunk];
+    for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ++ty)
+        for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; ++tx)
+            bins[(size_t)ty * tilesX_ + tx].push_back(index);
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile)
+{
+    int tileX0 = (tile % tilesX_) * TILE_SIZE;
+    int tileY0 = (tile / tilesX_) * TILE_SIZE;
+    int tileX1 = std::min(tileX0 + TILE_SIZE, width_) - 1;
+    int tileY1 = std::min(tileY0 + TILE_SIZE, height_) - 1;
+
+    float tileDepth[TILE_SIZE * TILE_SIZE];
+    std::fill(tileDepth, tileDepth + TILE_SIZE * TILE_SIZE, 1.0f);
+
+    unsigned char clear[4] = { toByte(clearColor_.r), toByte(clearColor_.g), toByte(clearColor_.b), 255 };
+    for (int y = tileY0; y <= tileY1; ++y)
+        for (int x = tileX0; x <= tileX1; ++x)
+        {
+            unsigned char* pixel = &color_[((size_t)y * width_ + x) * 4];
+            pixel[0] = clear[0]; pixel[1] = clear[1]; pixel[2] = clear[2]; pixel[3] = clear[3];
+        }
+
+    for (size_t chunk = 0; chunk < chunkBins_.size(); ++chunk)
+    {
+        const std::vector<Triangle>& triangles = chunkTriangles_[chunk];
+        for (int index : chunkBins_[chunk][tile])
+            rasterizeTriangle(triangles[index], tileX0, tileY0, tileX1, tileY1, tileDepth);
+    }
+}
+
+void SoftwareRasterizer::rasterizeTriangle(const Triangle& tri, int tileX0, int tileY0, int tileX1, int tileY1, float* tileDepth)
+{
+    int minX = std::max(tri.minX, tileX0);
+    int minY = std::max(tri.minY, tileY0);
+    int maxX = std::min(tri.maxX, tileX1);
+    int maxY = std::min(tri.maxY, tileY1);
+    if (minX > maxX || minY > maxY) return;
+    // Os tiles começam em coordenada par, então os quads 2x2 ficam alinhados com o tile
+    minX &= ~1;
+    minY &= ~1;
+
+    const MeshState& material = meshStates_[tri.mesh];
+    const Float4 laneX(0.5f, 1.5f, 0.5f, 1.5f);
+    const Float4 laneY(0.5f, 0.5f, 1.5f, 1.5f);
+    const Float4 zero(0.0f), one(1.0f);
+
+    for (int y = minY; y <= maxY; y += 2)
+    {
+        int rowMask = (y + 1 > tileY1) ? 0x3 : 0xF;
+        for (int x = minX; x <= maxX; x += 2)
+        {
+            int mask = rowMask & ((x + 1 > tileX1) ? 0x5 : 0xF);
+            Float4 px = Float4((float)x) + laneX;
+            Float4 py = Float4((float)y) + laneY;
+
+            Float4 edge[3];
+            for (int e = 0; e < 3; ++e)
+            {
+                edge[e] = Float4(tri.edgeA[e]) * px + Float4(tri.edgeB[e]) * py + Float4(tri.edgeC[e]);
+                mask &= tri.topLeft[e] ? cmpGreaterEqual(edge[e], zero) : cmpGreater(edge[e], zero);
+            }
+            if (!mask) continue;
+
+            Float4 l0 = edge[0] * Float4(tri.invArea);
+            Float4 l1 = edge[1] * Float4(tri.invArea);
+            Float4 l2 = edge[2] * Float4(tri.invArea);
+
+            // Profundidade é linear em tela; teste GL_LESS contra o buffer do tile
+            Float4 depth = interpolate(l0, l1, l2, tri.depth[0], tri.depth[1], tri.depth[2]);
+            float depthLanes[4];
+            depth.store(depthLanes);
+            for (int i = 0; i < 4; ++i)
+            {
+                if (!(mask & (1 << i))) continue;
+                int dx = x + (i & 1) - tileX0, dy = y + (i >> 1) - tileY0;
+                float stored = tileDepth[dy * TILE_SIZE + dx];
+                if (!(depthLanes[i] < stored) || depthLanes[i] > 1.0f)
+                    mask &= ~(1 << i);
+            }
+            if (!mask) continue;
+
+            // Interpolação com correção de perspectiva (pesos divididos por w)
+            Float4 q0 = l0 * Float4(tri.invW[0]);
+            Float4 q1 = l1 * Float4(tri.invW[1]);
+            Float4 q2 = l2 * Float4(tri.invW[2]);
+            Float4 invSum = one / (q0 + q1 + q2);
+            q0 = q0 * invSum; q1 = q1 * invSum; q2 = q2 * invSum;
+
+            Vec3x4 world = {
+                interpolate(q0, q1, q2, tri.world[0].x, tri.world[1].x, tri.world[2].x),
+                interpolate(q0, q1, q2, tri.world[0].y, tri.world[1].y, tri.world[2].y),
+                interpolate(q0, q1, q2, tri.world[0].z, tri.world[1].z, tri.world[2].z) };
+            Vec3x4 normal = normalize(Vec3x4{
+                interpolate(q0, q1, q2, tri.normal[0].x, tri.normal[1].x, tri.normal[2].x),
+                interpolate(q0, q1, q2, tri.normal[0].y, tri.normal[1].y, tri.normal[2].y),
+                interpolate(q0, q1, q2, tri.normal[0].z, tri.normal[1].z, tri.normal[2].z) });
+            Vec3x4 view = normalize(fromPoint(viewPos_, world));
+
+            // object.fs: ambiente em SH (vezes a oclusão assada) + soma das luzes com atenuação (1 - d/r)^2
+            Float4 sh[EnvironmentLighting::SH_COEFFICIENTS] = {
+                one, normal.y, normal.z, normal.x,
+                normal.x * normal.y, normal.y * normal.z, Float4(3.0f) * normal.z * normal.z - one,
+                normal.x * normal.z, normal.x * normal.x - normal.y * normal.y };
+            Float4 r = zero, g = zero, b = zero;
+            for (int i = 0; i < EnvironmentLighting::SH_COEFFICIENTS; ++i)
+            {
+                r = r + Float4(shAmbient_[i].r) * sh[i];
+                g = g + Float4(shAmbient_[i].g) * sh[i];
+                b = b + Float4(shAmbient_[i].b) * sh[i];
+            }
+            Float4 occlusion = interpolate(q0, q1, q2, tri.occlusion[0], tri.occlusion[1], tri.occlusion[2]);
+            r = max4(r, zero) * occlusion * Float4(material.Ka.r);
+            g = max4(g, zero) * occlusion * Float4(material.Ka.g);
+            b = max4(b, zero) * occlusion * Float4(material.Ka.b);
+            for (const ShadingLight& light : lights_)
+            {
+                Vec3x4 toLight = fromPoint(light.position, world);
+                Float4 dist2 = dot(toLight, toLight);
+                if (!(cmpLess(dist2, Float4(light.radius * light.radius)) & mask)) continue;
+
+                Float4 dist = sqrt4(dist2);
+                Float4 attenuation = max4(one - dist * Float4(1.0f / light.radius), zero);
+                attenuation = attenuation * attenuation;
+
+                Float4 invDist = one / dist;
+                Vec3x4 lightDir = { toLight.x * invDist, toLight.y * invDist, toLight.z * invDist };
+                Float4 nDotL = dot(normal, lightDir);
+                Float4 diff = max4(nDotL, zero);
+
+                Float4 twoNDotL = nDotL + nDotL;
+                Vec3x4 reflectDir = { normal.x * twoNDotL - lightDir.x, normal.y * twoNDotL - lightDir.y, normal.z * twoNDotL - lightDir.z };
+                float specLanes[4];
+                max4(dot(view, reflectDir), zero).store(specLanes);
+                for (int i = 0; i < 4; ++i)
+                    specLanes[i] = std::pow(specLanes[i], material.Ns);
+                Float4 spec(specLanes[0], specLanes[1], specLanes[2], specLanes[3]);
+
+                glm::vec3 kd = light.diffuse * material.Kd;
+                glm::vec3 ks = light.specular * material.Ks;
+                r = r + (Float4(kd.r) * diff + Float4(ks.r) * spec) * attenuation;
+                g = g + (Float4(kd.g) * diff + Float4(ks.g) * spec) * attenuation;
+                b = b + (Float4(kd.b) * diff + Float4(ks.b) * spec) * attenuation;
+            }
+
+            float red[4], green[4], blue[4];
+            r.store(red); g.store(green); b.store(blue);
+
+            if (material.texture)
+            {
+                float u[4], v[4];
+                interpolate(q0, q1, q2, tri.uv[0].x, tri.uv[1].x, tri.uv[2].x).store(u);
+                interpolate(q0, q1, q2, tri.uv[0].y, tri.uv[1].y, tri.uv[2].y).store(v);
+
+                // Mip pelo maior passo de UV no quad, em texels do nível 0
+                const std::vector<MipLevel>& levels = material.texture->levels;
+                float w0 = (float)levels[0].width, h0 = (float)levels[0].height;
+                float dudx = (u[1] - u[0]) * w0, dvdx = (v[1] - v[0]) * h0;
+                float dudy = (u[2] - u[0]) * w0, dvdy = (v[2] - v[0]) * h0;
+                float rho = std::max(std::sqrt(dudx * dudx + dvdx * dvdx), std::sqrt(dudy * dudy + dvdy * dvdy));
+                float lod = rho > 1.0f ? std::log2(rho) : 0.0f;
+                lod = std::min(lod, (float)(levels.size() - 1));
+                int level0 = (int)lod;
+                int level1 = std::min(level0 + 1, (int)levels.size() - 1);
+                float blend = lod - (float)level0;
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (!(mask & (1 << i))) continue;
+                    const MipLevel& a = levels[level0];
+                    glm::vec3 texel = sampleBilinear(a.width, a.height, a.texels.data(), u[i], v[i]);
+                    if (blend > 0.0f && level1 != level0)
+                    {
+                        const MipLevel& c = levels[level1];
+                        texel = glm::mix(texel, sampleBilinear(c.width, c.height, c.texels.data(), u[i], v[i]), blend);
+                    }
+                    red[i] *= texel.r; green[i] *= texel.g; blue[i] *= texel.b;
+                }
+            }
+
+            for (int i = 0; i < 4; ++i)
+            {
+                if (!(mask & (1 << i))) continue;
+                int px = x + (i & 1), py = y + (i >> 1);
+                tileDepth[(py - tileY0) * TILE_SIZE + (px - tileX0)] = depthLanes[i];
+                unsigned char* pixel = &color_[((size_t)py * width_ + px) * 4];
+                pixel[0] = toByte(red[i]);
+                pixel[1] = toByte(green[i]);
+                pixel[2] = toByte(blue[i]);
+                pixel[3] = 255;
+            }
+        }
+    }
+}
+
+ImageDifference SoftwareRasterizer::compare(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance)
+{
+    ImageDifference result = { 0.0, 0, 0.0 };
+    size_t pixels = std::min(a.size(), b.size()) / 4;
+    if (pixels == 0) return result;
+
+    unsigned long long sum = 0;
+    size_t mismatched = 0;
+    for (size_t i = 0; i < pixels; ++i)
+    {
+        int worst = 0;
+        for (int c = 0; c < 3; ++c)
+        {
+            int diff = std::abs((int)a[i * 4 + c] - (int)b[i * 4 + c]);
+            sum += diff;
+            worst = std::max(worst, diff);
+        }
+        result.maxError = std::max(result.maxError, worst);
+        if (worst > tolerance) ++mismatched;
+    }
+    result.meanError = (double)sum / (pixels * 3);
+    result.mismatchPercent = 100.0 * mismatched / pixels;
+    return result;
+}
@@ -0,0 +1,146 @@
+#include "TextureArrays.h"
+#include "TextureCache.h"
+#include "GLExtensions.h"
+#include "GpuResources.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <utility>
+#include <stb_image.h>
+
+TextureArrays::TextureArrays() : minSize_(256), maxSize_(2048), buildMs_(0.0)
+{
+}
+
+TextureArrays::~TextureArrays()
+{
+    release();
+}
+
+void TextureArrays::release()
+{
+    for (const ArrayInfo& info : arrays_)
+    {
+        if (info.texture != 0)
+            glDeleteTextures(1, &info.texture);
+    }
+    for (int resource : resources_)
+        GpuResources::instance().remove(resource);
+    arrays_.clear();
+    slots_.clear();
+    resources_.clear();
+}
+
+int TextureArrays::bucketSize(int width, int height, int minSize, int maxSize)
+{
+    // Potência de 2 mais próxima em escala log: a área muda no máximo por um fator de 2
+    double side = std::sqrt((double)width * height);
+    int size = 1 << (int)std::lround(std::log2(std::max(side, 1.0)));
+    return std::min(std::max(size, minSize), maxSize);
+}
+
+const char* TextureArrays::formatName(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+    case GL_RED: return "R8";
+    case GL_RGB: return "RGB8";
+    default: return "RGBA8";
+    }
+}
+
+size_t TextureArrays::getTotalBytes() const
+{
+    size_t total = 0;
+    for (const ArrayInfo& info : arrays_)
+        total += info.bytes;
+    return total;
+}
+
+TextureArraySlot TextureArrays::find(const std::string& path) const
+{
+    auto it = slots_.find(path);
+    return it != slots_.end() ? it->second : TextureArraySlot();
+}
+
+bool TextureArrays::build(const std::vector<std::string>& inputPaths, bool createTextures)
+{
+    auto start = std::chrono::steady_clock::now();
+    release();
+
+    std::vector<std::string> paths;
+    for (const std::string& path : inputPaths)
+    {
+        if (std::find(paths.begin(), paths.end(), path) == paths.end())
+            paths.push_back(path);
+    }
+
+    // Um array por (lado, formato interno): todas as camadas precisam do mesmo formato e da mesma cadeia
+    std::vector<std::unique_ptr<CookedTexture>> images(paths.size());
+    std::map<std::pair<int, GLenum>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        int width, height, channels;
+        if (!stbi_info(paths[i].c_str(), &width, &height, &channels))
+            continue;
+        int size = bucketSize(width, height, minSize_, maxSize_);
+        images[i].reset(new CookedTexture());
+        if (!TextureCache::instance().open(paths[i], *images[i], size, size))
+        {
+            images[i].reset();
+            continue;
+        }
+        groups[{ size, TextureCache::internalFormat(*images[i]) }].push_back(i);
+    }
+
+    for (const auto& group : groups)
+    {
+        const std::vector<size_t>& members = group.second;
+        const CookedTexture& first = *images[members[0]];
+        ArrayInfo info = { 0, group.first.first, group.first.second, (int)members.size(), first.getLevelCount(), 0 };
+        for (int level = 0; level < first.getLevelCount(); ++level)
+            info.bytes += first.getLevel(level).size * members.size();
+
+        if (createTextures)
+        {
+            glGenTextures(1, &info.texture);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, info.texture);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, info.levels - 1);
+
+            // Aloca cada nível com todas as camadas e depois envia camada por camada do container mapeado
+            for (int level = 0; level < info.levels; ++level)
+            {
+                const CookedTexture::Level& levelInfo = first.getLevel(level);
+                if (first.isCompressed())
+                    glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, info.internalFormat, levelInfo.width, levelInfo.height, info.layers,
+                                           0, (GLsizei)(levelInfo.size * info.layers), nullptr);
+                else
+                    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, info.internalFormat, levelInfo.width, levelInfo.height, info.layers,
+                                 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+            for (int layer = 0; layer < info.layers; ++layer)
+            {
+                const CookedTexture& image = *images[members[layer]];
+                for (int level = 0; level < info.levels; ++level)
+                    TextureCache::uploadLayer(image, level, layer, image.getData() + image.getLevel(level).offset);
+            }
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            resources_.push_back(GpuResources::instance().add(GpuCategory::Texture, info.bytes));
+        }
+
+        for (int layer = 0; layer < info.layers; ++layer)
+            slots_[paths[members[layer]]] = { info.texture, layer };
+        arrays_.push_back(info);
+    }
+
+    buildMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return !slots_.empty();
+}
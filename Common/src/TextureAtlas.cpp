@@ -0,0 +1,376 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x54414356; // "VCAT"
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t pages;
+        uint32_t entries;
+    };
+
+    struct CachePage {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // Na ordem das imagens de entrada; page = -1 para as que ficaram de fora
+    struct CacheEntry {
+        int32_t page;
+        int32_t x;
+        int32_t y;
+        int32_t width;
+        int32_t height;
+    };
+
+    void fnv1a(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    bool readFile(const std::string& path, std::vector<unsigned char>& bytes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !bytes.empty();
+    }
+
+    int roundUp(int value, int multiple)
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+}
+
+TextureAtlas::TextureAtlas() :
+    pageSize_(4096), padding_(8), directory_("../cache/atlas/"), cached_(false), buildMs_(0.0)
+{
+}
+
+int TextureAtlas::getAlignment() const
+{
+    int alignment = 4;
+    while (alignment < padding_ * 2)
+        alignment *= 2;
+    return alignment;
+}
+
+float TextureAtlas::getMaxLod() const
+{
+    // Nível L: texels cobrem 2^L texels do nível 0 (precisa do alinhamento) e o bilinear alcança
+    // meio texel além da borda da imagem, 2^(L-1) texels do nível 0 (precisa da margem)
+    if (padding_ == 0) return 0.0f;
+    int lod = 0;
+    while ((2 << lod) <= getAlignment() && (1 << lod) <= padding_)
+        ++lod;
+    return (float)lod;
+}
+
+glm::vec4 TextureAtlas::getUvTransform(const TextureAtlasEntry& entry) const
+{
+    const Page& page = pages_[entry.page];
+    return glm::vec4((float)entry.width / page.width, (float)entry.height / page.height,
+                     (float)entry.x / page.width, (float)entry.y / page.height);
+}
+
+void TextureAtlas::remapUVs(const TextureAtlasEntry& entry, std::vector<float>& vertices) const
+{
+    glm::vec4 transform = getUvTransform(entry);
+    for (size_t v = 0; v + 8 <= vertices.size(); v += 8)
+    {
+        vertices[v + 6] = vertices[v + 6] * transform.x + transform.z;
+        vertices[v + 7] = vertices[v + 7] * transform.y + transform.w;
+    }
+}
+
+bool TextureAtlas::uvsInUnitSquare(const std::vector<float>& vertices)
+{
+    for (size_t v = 0; v + 8 <= vertices.size(); v += 8)
+    {
+        if (vertices[v + 6] < 0.0f || vertices[v + 6] > 1.0f || vertices[v + 7] < 0.0f || vertices[v + 7] > 1.0f)
+            return false;
+    }
+    return true;
+}
+
+const TextureAtlasEntry* TextureAtlas::find(const std::string& path) const
+{
+    auto it = entries_.find(path);
+    return it != entries_.end() ? &it->second : nullptr;
+}
+
+// Bottom-left: a posição com o topo mais baixo, e entre essas a mais à esquerda
+bool TextureAtlas::place(std::vector<SkylineNode>& skyline, int width, int height, int& x, int& y) const
+{
+    int bestIndex = -1;
+    int bestY = INT_MAX;
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        if (skyline[i].x + width > pageSize_) break;
+        int top = 0;
+        int remaining = width;
+        for (size_t j = i; remaining > 0 && j < skyline.size(); ++j)
+        {
+            top = std::max(top, skyline[j].y);
+            remaining -= skyline[j].width;
+        }
+        if (top + height <= pageSize_ && top < bestY)
+        {
+            bestY = top;
+            bestIndex = (int)i;
+        }
+    }
+    if (bestIndex < 0) return false;
+
+    x = skyline[bestIndex].x;
+    y = bestY;
+    skyline.insert(skyline.begin() + bestIndex, { x, y + height, width });
+
+    // Os nós cobertos pelo novo encolhem ou somem; vizinhos na mesma altura se juntam
+    for (size_t i = bestIndex + 1; i < skyline.size();)
+    {
+        int overlap = x + width - skyline[i].x;
+        if (overlap <= 0) break;
+        if (skyline[i].width <= overlap)
+        {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        skyline[i].x += overlap;
+        skyline[i].width -= overlap;
+        break;
+    }
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+            ++i;
+    }
+    return true;
+}
+
+std::string TextureAtlas::pathFor(uint64_t key, const char* suffix) const
+{
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)key);
+    return directory_ + hex + suffix;
+}
+
+bool TextureAtlas::loadCache(uint64_t key, const std::vector<std::string>& paths)
+{
+    std::ifstream file(pathFor(key, ".atl"), std::ios::binary);
+    if (!file.is_open()) return false;
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.entries != paths.size())
+        return false;
+
+    std::vector<CachePage> pages(header.pages);
+    std::vector<CacheEntry> entries(header.entries);
+    if (!file.read(reinterpret_cast<char*>(pages.data()), pages.size() * sizeof(CachePage)) ||
+        !file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(CacheEntry)))
+        return false;
+
+    for (uint32_t i = 0; i < header.pages; ++i)
+    {
+        std::string pagePath = pathFor(key, ("_" + std::to_string(i) + ".png").c_str());
+        std::error_code error;
+        if (!std::filesystem::exists(pagePath, error))
+            return false;
+        pages_.push_back({ pagePath, (int)pages[i].width, (int)pages[i].height });
+    }
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (entries[i].page < 0) continue;
+        if (entries[i].page >= (int)pages_.size())
+        {
+            pages_.clear();
+            entries_.clear();
+            return false;
+        }
+        entries_[paths[i]] = { entries[i].page, entries[i].x, entries[i].y, entries[i].width, entries[i].height };
+    }
+    return true;
+}
+
+void TextureAtlas::storeCache(uint64_t key, const std::vector<std::string>& paths) const
+{
+    std::ofstream file(pathFor(key, ".atl"), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "TextureAtlas: não foi possível gravar " << pathFor(key, ".atl") << std::endl;
+        return;
+    }
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, (uint32_t)pages_.size(), (uint32_t)paths.size() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const Page& page : pages_)
+    {
+        CachePage cachePage = { (uint32_t)page.width, (uint32_t)page.height };
+        file.write(reinterpret_cast<const char*>(&cachePage), sizeof(cachePage));
+    }
+    for (const std::string& path : paths)
+    {
+        const TextureAtlasEntry* entry = find(path);
+        CacheEntry cacheEntry = { -1, 0, 0, 0, 0 };
+        if (entry)
+            cacheEntry = { entry->page, entry->x, entry->y, entry->width, entry->height };
+        file.write(reinterpret_cast<const char*>(&cacheEntry), sizeof(cacheEntry));
+    }
+}
+
+bool TextureAtlas::build(const std::vector<std::string>& inputPaths)
+{
+    auto start = std::chrono::steady_clock::now();
+    pages_.clear();
+    entries_.clear();
+    cached_ = false;
+
+    std::vector<std::string> paths;
+    for (const std::string& path : inputPaths)
+    {
+        if (std::find(paths.begin(), paths.end(), path) == paths.end())
+            paths.push_back(path);
+    }
+
+    // Só os arquivos são lidos por execução; decodificar e empacotar fica para quando algo muda
+    std::vector<std::vector<unsigned char>> sources(paths.size());
+    uint64_t key = 14695981039346656037ULL;
+    fnv1a(key, &pageSize_, sizeof(pageSize_));
+    fnv1a(key, &padding_, sizeof(padding_));
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        fnv1a(key, paths[i].data(), paths[i].size());
+        if (readFile(paths[i], sources[i]))
+            fnv1a(key, sources[i].data(), sources[i].size());
+    }
+
+    if (loadCache(key, paths))
+    {
+        cached_ = true;
+        buildMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return !entries_.empty();
+    }
+
+    int alignment = getAlignment();
+    std::vector<Cell> cells;
+    std::vector<glm::ivec2> sizes(paths.size(), glm::ivec2(0));
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        int width, height, channels;
+        if (sources[i].empty() || !stbi_info_from_memory(sources[i].data(), (int)sources[i].size(), &width, &height, &channels))
+            continue;
+        // Cinza e cinza + alfa são amostrados como GL_RED/GL_RG fora do atlas
+        if (channels < 3) continue;
+        Cell cell = { (int)i, roundUp(width + padding_ * 2, alignment), roundUp(height + padding_ * 2, alignment), 0, 0, -1 };
+        if (cell.width > pageSize_ || cell.height > pageSize_) continue;
+        sizes[i] = glm::ivec2(width, height);
+        cells.push_back(cell);
+    }
+
+    std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+        return a.height != b.height ? a.height > b.height : a.width > b.width;
+    });
+
+    std::vector<std::vector<SkylineNode>> skylines;
+    for (Cell& cell : cells)
+    {
+        for (size_t page = 0; page < skylines.size() && cell.page < 0; ++page)
+        {
+            if (place(skylines[page], cell.width, cell.height, cell.x, cell.y))
+                cell.page = (int)page;
+        }
+        if (cell.page < 0)
+        {
+            skylines.push_back({ { 0, 0, pageSize_ } });
+            place(skylines.back(), cell.width, cell.height, cell.x, cell.y);
+            cell.page = (int)skylines.size() - 1;
+        }
+    }
+
+    // Uma imagem sozinha numa página só ganharia margem: continua como textura própria
+    std::vector<int> cellsPerPage(skylines.size(), 0);
+    for (const Cell& cell : cells)
+        ++cellsPerPage[cell.page];
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+
+    for (size_t page = 0; page < skylines.size(); ++page)
+    {
+        if (cellsPerPage[page] < 2) continue;
+
+        int width = 0, height = 0;
+        for (const Cell& cell : cells)
+        {
+            if (cell.page != (int)page) continue;
+            width = std::max(width, cell.x + cell.width);
+            height = std::max(height, cell.y + cell.height);
+        }
+
+        int pageIndex = (int)pages_.size();
+        std::vector<unsigned char> pixels((size_t)width * height * 4, 0);
+        for (const Cell& cell : cells)
+        {
+            if (cell.page != (int)page) continue;
+            const std::vector<unsigned char>& source = sources[cell.source];
+            int imageWidth, imageHeight, channels;
+            unsigned char* image = stbi_load_from_memory(source.data(), (int)source.size(), &imageWidth, &imageHeight, &channels, 4);
+            if (!image) continue;
+
+            // A célula inteira recebe a imagem com as bordas replicadas até o fim da célula
+            for (int row = 0; row < cell.height; ++row)
+            {
+                int sourceRow = std::min(std::max(row - padding_, 0), imageHeight - 1);
+                const unsigned char* src = image + (size_t)sourceRow * imageWidth * 4;
+                unsigned char* dst = pixels.data() + ((size_t)(cell.y + row) * width + cell.x) * 4;
+                for (int x = 0; x < padding_; ++x)
+                    memcpy(dst + x * 4, src, 4);
+                memcpy(dst + padding_ * 4, src, (size_t)imageWidth * 4);
+                for (int x = padding_ + imageWidth; x < cell.width; ++x)
+                    memcpy(dst + x * 4, src + (imageWidth - 1) * 4, 4);
+            }
+            stbi_image_free(image);
+
+            entries_[paths[cell.source]] = { pageIndex, cell.x + padding_, cell.y + padding_,
+                                             sizes[cell.source].x, sizes[cell.source].y };
+        }
+
+        std::string pagePath = pathFor(key, ("_" + std::to_string(pageIndex) + ".png").c_str());
+        if (!stbi_write_png(pagePath.c_str(), width, height, 4, pixels.data(), width * 4))
+        {
+            std::cerr << "TextureAtlas: não foi possível gravar " << pagePath << std::endl;
+            pages_.clear();
+            entries_.clear();
+            break;
+        }
+        pages_.push_back({ pagePath, width, height });
+    }
+
+    if (!pages_.empty())
+        storeCache(key, paths);
+    buildMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return !entries_.empty();
+}
@@ -0,0 +1,503 @@
+#include "TextureCache.h"
+#include "GLExtensions.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <stb_image.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXTURE_CACHE_USE_SSE 1
+#endif
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x58544356; // "VCTX"
+    const uint32_t CACHE_VERSION = 2;
+    const size_t DATA_ALIGNMENT = 16;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levels;
+        uint32_t channels; // canais da imagem original: define o formato interno no upload
+        uint32_t format;   // CookedTexture::Format
+        uint32_t compression; // 1 se cozido com compressão ligada (mesmo que a imagem tenha ficado em RGBA8)
+    };
+
+    struct CacheLevel {
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;   // a partir do início do arquivo
+        uint64_t size;
+    };
+
+    void fnv1a(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    bool readFile(const std::string& path, std::vector<unsigned char>& bytes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !bytes.empty();
+    }
+
+    size_t levelBytes(CookedTexture::Format format, uint32_t width, uint32_t height)
+    {
+        if (format == CookedTexture::BC1) return BlockCompressor::compressedSize(BlockCompressor::BC1, (int)width, (int)height);
+        if (format == CookedTexture::BC3) return BlockCompressor::compressedSize(BlockCompressor::BC3, (int)width, (int)height);
+        return (size_t)width * height * 4;
+    }
+
+    BlockCompressor::Format blockFormat(CookedTexture::Format format)
+    {
+        return format == CookedTexture::BC3 ? BlockCompressor::BC3 : BlockCompressor::BC1;
+    }
+}
+
+size_t CookedTexture::getRowPitch(int level) const
+{
+    int width = levels_[level].width;
+    if (format_ == BC1 || format_ == BC3)
+        return (size_t)((width + 3) / 4) * BlockCompressor::blockBytes(blockFormat(format_));
+    return (size_t)width * 4;
+}
+
+TextureCache::TextureCache() :
+    directory_("../cache/textures/"), enabled_(true), compression_(false), compressionSet_(false), recook_(false), hits_(0), misses_(0), loadMs_(0.0)
+{
+}
+
+TextureCache& TextureCache::instance()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+bool TextureCache::isCompressionEnabled() const
+{
+    // Exercícios que não inicializam o GLExtensions ficam em RGBA8: DXT sem a extensão é GL_INVALID_ENUM
+    if (compressionSet_)
+        return compression_;
+    return GLExtensions::isInitialized() && GLExtensions::hasTextureCompressionS3TC();
+}
+
+std::string TextureCache::pathFor(const std::string& sourcePath, int width, int height) const
+{
+    uint64_t hash = 14695981039346656037ULL;
+    fnv1a(hash, sourcePath.data(), sourcePath.size());
+    if (width > 0 && height > 0)
+    {
+        fnv1a(hash, &width, sizeof(width));
+        fnv1a(hash, &height, sizeof(height));
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return directory_ + hex + ".tex";
+}
+
+void TextureCache::downsample(const unsigned char* src, int width, int height, unsigned char* dst)
+{
+    int dstWidth = std::max(1, width / 2);
+    int dstHeight = std::max(1, height / 2);
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        const unsigned char* row0 = src + (size_t)std::min(y * 2, height - 1) * width * 4;
+        const unsigned char* row1 = src + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+        unsigned char* out = dst + (size_t)y * dstWidth * 4;
+        int x = 0;
+
+#ifdef TEXTURE_CACHE_USE_SSE
+        // 4 texels de cada linha viram 2 de saída: soma vertical e horizontal em 16 bits, (soma + 2) / 4
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; x + 2 <= dstWidth && x * 2 + 4 <= width; x += 2)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+            __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+            high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+            __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(low, high), rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, zero));
+        }
+#endif
+        for (; x < dstWidth; ++x)
+        {
+            int x0 = std::min(x * 2, width - 1) * 4, x1 = std::min(x * 2 + 1, width - 1) * 4;
+            for (int c = 0; c < 4; ++c)
+                out[x * 4 + c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+        }
+    }
+}
+
+void TextureCache::resize(const unsigned char* src, int width, int height, unsigned char* dst, int dstWidth, int dstHeight)
+{
+    // Pesos de cada texel de saída num eixo: triângulo de raio max(1, escala) em volta do centro
+    struct Tap {
+        int first;
+        std::vector<float> weights;
+    };
+    auto makeTaps = [](int srcSize, int dstSize) {
+        std::vector<Tap> taps(dstSize);
+        float scale = (float)srcSize / dstSize;
+        float radius = std::max(1.0f, scale);
+        for (int i = 0; i < dstSize; ++i)
+        {
+            float center = (i + 0.5f) * scale - 0.5f;
+            int first = (int)std::ceil(center - radius);
+            int last = (int)std::floor(center + radius);
+            float total = 0.0f;
+            taps[i].first = first;
+            for (int s = first; s <= last; ++s)
+            {
+                float weight = std::max(0.0f, 1.0f - std::fabs(s - center) / radius);
+                taps[i].weights.push_back(weight);
+                total += weight;
+            }
+            for (float& weight : taps[i].weights)
+                weight /= total;
+        }
+        return taps;
+    };
+    std::vector<Tap> columns = makeTaps(width, dstWidth);
+    std::vector<Tap> rows = makeTaps(height, dstHeight);
+
+    // Horizontal para um buffer em float, vertical direto para a saída; bordas repetem o último texel
+    std::vector<float> horizontal((size_t)dstWidth * height * 4);
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char* row = src + (size_t)y * width * 4;
+        float* out = horizontal.data() + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth; ++x)
+        {
+            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (size_t t = 0; t < columns[x].weights.size(); ++t)
+            {
+                int sx = std::min(std::max(columns[x].first + (int)t, 0), width - 1);
+                for (int c = 0; c < 4; ++c)
+                    sum[c] += row[sx * 4 + c] * columns[x].weights[t];
+            }
+            for (int c = 0; c < 4; ++c)
+                out[x * 4 + c] = sum[c];
+        }
+    }
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        unsigned char* out = dst + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth * 4; ++x)
+        {
+            float sum = 0.0f;
+            for (size_t t = 0; t < rows[y].weights.size(); ++t)
+            {
+                int sy = std::min(std::max(rows[y].first + (int)t, 0), height - 1);
+                sum += horizontal[(size_t)sy * dstWidth * 4 + x] * rows[y].weights[t];
+            }
+            out[x] = (unsigned char)std::min(255.0f, std::max(0.0f, sum + 0.5f));
+        }
+    }
+}
+
+bool TextureCache::build(const std::vector<unsigned char>& source, uint64_t sourceHash, const std::string& path,
+                         int resizeWidth, int resizeHeight, JobSystem* jobs, std::vector<unsigned char>& container)
+{
+    int width, height, channels;
+    unsigned char* pixels = stbi_load_from_memory(source.data(), (int)source.size(), &width, &height, &channels, 4);
+    if (!pixels)
+    {
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return false;
+    }
+    if (channels == 2)
+    {
+        std::cerr << "Unsupported number of channels for texture: " << path << std::endl;
+        stbi_image_free(pixels);
+        return false;
+    }
+    std::vector<unsigned char> resized;
+    if (resizeWidth > 0 && resizeHeight > 0 && (resizeWidth != width || resizeHeight != height))
+    {
+        resized.resize((size_t)resizeWidth * resizeHeight * 4);
+        resize(pixels, width, height, resized.data(), resizeWidth, resizeHeight);
+        width = resizeWidth;
+        height = resizeHeight;
+    }
+
+    // Cadeia RGBA8 primeiro (os mips saem dos texels originais, nunca de blocos)
+    std::vector<CacheLevel> levels;
+    std::vector<size_t> chainOffsets;
+    size_t chainSize = 0;
+    int levelWidth = width, levelHeight = height;
+    for (;;)
+    {
+        levels.push_back({ (uint32_t)levelWidth, (uint32_t)levelHeight, 0, 0 });
+        chainOffsets.push_back(chainSize);
+        chainSize += (size_t)levelWidth * levelHeight * 4;
+        if (levelWidth == 1 && levelHeight == 1) break;
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+    std::vector<unsigned char> chain(chainSize);
+    std::memcpy(chain.data(), resized.empty() ? pixels : resized.data(), (size_t)width * height * 4);
+    stbi_image_free(pixels);
+    for (size_t i = 1; i < levels.size(); ++i)
+        downsample(chain.data() + chainOffsets[i - 1], (int)levels[i - 1].width, (int)levels[i - 1].height, chain.data() + chainOffsets[i]);
+
+    // BC1 para imagens opacas, BC3 quando algum texel tem alfa
+    CookedTexture::Format format = CookedTexture::RGBA8;
+    if (isCompressionEnabled() && channels != 1)
+    {
+        format = CookedTexture::BC1;
+        for (size_t i = 0; i < (size_t)width * height; ++i)
+            if (chain[i * 4 + 3] != 255)
+            {
+                format = CookedTexture::BC3;
+                break;
+            }
+    }
+
+    size_t offset = sizeof(CacheHeader) + levels.size() * sizeof(CacheLevel);
+    for (auto& level : levels)
+    {
+        offset = (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+        level.offset = offset;
+        level.size = levelBytes(format, level.width, level.height);
+        offset += (size_t)level.size;
+    }
+
+    container.assign(offset, 0);
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, sourceHash, (uint32_t)width, (uint32_t)height, (uint32_t)levels.size(),
+                           (uint32_t)channels, (uint32_t)format, isCompressionEnabled() ? 1u : 0u };
+    std::memcpy(container.data(), &header, sizeof(header));
+    std::memcpy(container.data() + sizeof(header), levels.data(), levels.size() * sizeof(CacheLevel));
+
+    TextureCookReport report = { path, width, height, format, chainSize, 0, std::numeric_limits<double>::infinity(), 0.0 };
+    BlockCompressor compressor;
+    compressor.setJobSystem(jobs);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        if (format == CookedTexture::RGBA8)
+            std::memcpy(container.data() + levels[i].offset, chain.data() + chainOffsets[i], (size_t)levels[i].size);
+        else
+            compressor.encode(blockFormat(format), chain.data() + chainOffsets[i], (int)levels[i].width, (int)levels[i].height,
+                               container.data() + levels[i].offset);
+        report.cookedBytes += (size_t)levels[i].size;
+    }
+    if (format != CookedTexture::RGBA8)
+    {
+        report.encodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::vector<unsigned char> decoded((size_t)width * height * 4);
+        BlockCompressor::decode(blockFormat(format), container.data() + levels[0].offset, width, height, decoded.data());
+        report.psnr = BlockCompressor::psnr(chain.data(), decoded.data(), (size_t)width * height, channels);
+    }
+    std::lock_guard<std::mutex> lock(reportMutex_);
+    reports_.push_back(report);
+    return true;
+}
+
+bool TextureCache::open(const std::string& path, CookedTexture& texture, int width, int height, JobSystem* jobs)
+{
+    // Só o hash do arquivo de origem é calculado por execução; decodificar fica para quando ele muda
+    std::vector<unsigned char> source;
+    if (!readFile(path, source))
+    {
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return false;
+    }
+    uint64_t sourceHash = 14695981039346656037ULL;
+    fnv1a(sourceHash, source.data(), source.size());
+
+    std::string cookedPath = pathFor(path, width, height);
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+    if (enabled_ && !recook_ && texture.mapped_.open(cookedPath))
+    {
+        base = texture.mapped_.data();
+        size = texture.mapped_.size();
+        const CacheHeader* header = reinterpret_cast<const CacheHeader*>(base);
+        bool valid = size >= sizeof(CacheHeader) && header->magic == CACHE_MAGIC && header->version == CACHE_VERSION &&
+                     header->sourceHash == sourceHash && header->levels > 0 && header->format <= CookedTexture::BC3 &&
+                     header->compression == (isCompressionEnabled() ? 1u : 0u) &&
+                     (width <= 0 || height <= 0 || (header->width == (uint32_t)width && header->height == (uint32_t)height)) &&
+                     size >= sizeof(CacheHeader) + header->levels * sizeof(CacheLevel);
+        const CacheLevel* levels = reinterpret_cast<const CacheLevel*>(base + sizeof(CacheHeader));
+        CookedTexture::Format format = valid ? (CookedTexture::Format)header->format : CookedTexture::RGBA8;
+        for (uint32_t i = 0; valid && i < header->levels; ++i)
+            valid = levels[i].offset + levels[i].size <= size && levels[i].size == levelBytes(format, levels[i].width, levels[i].height);
+        if (valid)
+            ++hits_;
+        else
+        {
+            texture.mapped_.close();
+            base = nullptr;
+        }
+    }
+
+    if (!base)
+    {
+        ++misses_;
+        if (!build(source, sourceHash, path, width, height, jobs, texture.memory_))
+            return false;
+        base = texture.memory_.data();
+
+        if (enabled_)
+        {
+            // Nome temporário + rename: outra thread pode estar mapeando a versão anterior
+            std::error_code error;
+            std::filesystem::create_directories(directory_, error);
+            std::string temporary = cookedPath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (file.is_open())
+            {
+                file.write(reinterpret_cast<const char*>(texture.memory_.data()), texture.memory_.size());
+                file.close();
+                std::filesystem::rename(temporary, cookedPath, error);
+            }
+            if (!file || error)
+                std::cerr << "TextureCache: não foi possível gravar " << cookedPath << std::endl;
+        }
+    }
+
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(base);
+    const CacheLevel* levels = reinterpret_cast<const CacheLevel*>(base + sizeof(CacheHeader));
+    texture.base_ = base + levels[0].offset;
+    texture.channels_ = (int)header->channels;
+    texture.format_ = (CookedTexture::Format)header->format;
+    texture.levels_.resize(header->levels);
+    for (uint32_t i = 0; i < header->levels; ++i)
+        texture.levels_[i] = { (int)levels[i].width, (int)levels[i].height, (size_t)(levels[i].offset - levels[0].offset), (size_t)levels[i].size };
+    return true;
+}
+
+GLenum TextureCache::internalFormat(const CookedTexture& texture)
+{
+    if (texture.getFormat() == CookedTexture::BC1) return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    if (texture.getFormat() == CookedTexture::BC3) return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    // Dados em RGBA8; o formato interno segue a imagem original (GL_RED pega só o R)
+    if (texture.getChannels() == 1) return GL_RED;
+    if (texture.getChannels() == 3) return GL_RGB;
+    return GL_RGBA;
+}
+
+void TextureCache::uploadLevel(const CookedTexture& texture, int level, const void* data)
+{
+    const CookedTexture::Level& info = texture.getLevel(level);
+    if (texture.isCompressed())
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat(texture), info.width, info.height, 0, (GLsizei)info.size, data);
+    else
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat(texture), info.width, info.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+void TextureCache::uploadRows(const CookedTexture& texture, int level, int y, int rows, const void* data)
+{
+    const CookedTexture::Level& info = texture.getLevel(level);
+    if (texture.isCompressed())
+    {
+        size_t bytes = (size_t)((rows + 3) / 4) * texture.getRowPitch(level);
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, y, info.width, rows, internalFormat(texture), (GLsizei)bytes, data);
+    }
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, y, info.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+void TextureCache::uploadLayer(const CookedTexture& texture, int level, int layer, const void* data)
+{
+    const CookedTexture::Level& info = texture.getLevel(level);
+    if (texture.isCompressed())
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, info.width, info.height, 1,
+                                  internalFormat(texture), (GLsizei)info.size, data);
+    else
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, info.width, info.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+GLuint TextureCache::load(const std::string& path)
+{
+    GLuint texID;
+    glGenTextures(1, &texID);
+    if (upload(path, texID) == 0)
+    {
+        glDeleteTextures(1, &texID);
+        return 0;
+    }
+    return texID;
+}
+
+size_t TextureCache::upload(const std::string& path, GLuint texID)
+{
+    auto start = std::chrono::steady_clock::now();
+    CookedTexture cooked;
+    if (!open(path, cooked))
+        return 0;
+
+    glBindTexture(GL_TEXTURE_2D, texID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, cooked.getLevelCount() - 1);
+
+    size_t bytes = 0;
+    for (int i = 0; i < cooked.getLevelCount(); ++i)
+    {
+        uploadLevel(cooked, i, cooked.getData() + cooked.getLevel(i).offset);
+        bytes += cooked.getLevel(i).size;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    loadMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return bytes;
+}
+
+bool TextureCache::loadPixels(const std::string& path, std::vector<unsigned char>& rgba, int& width, int& height)
+{
+    auto start = std::chrono::steady_clock::now();
+    CookedTexture cooked;
+    if (!open(path, cooked))
+        return false;
+
+    const CookedTexture::Level& level = cooked.getLevel(0);
+    width = level.width;
+    height = level.height;
+    if (cooked.isCompressed())
+    {
+        rgba.resize((size_t)width * height * 4);
+        BlockCompressor::decode(blockFormat(cooked.getFormat()), cooked.getData(), width, height, rgba.data());
+    }
+    else
+        rgba.assign(cooked.getData(), cooked.getData() + level.size);
+    loadMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool TextureCache::cook(const std::string& path)
+{
+    CookedTexture cooked;
+    return open(path, cooked);
+}
+
+std::vector<TextureCookReport> TextureCache::getCookReports() const
+{
+    std::lock_guard<std::mutex> lock(reportMutex_);
+    return reports_;
+}
@@ -0,0 +1,171 @@
+#include "World.h"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    std::atomic<int> componentCount(0);
+    size_t componentSizes[World::MAX_COMPONENTS];
+
+    size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+int World::registerComponent(size_t size)
+{
+    int id = componentCount++;
+    if (id >= MAX_COMPONENTS)
+        throw std::runtime_error("World: tipos de componente demais");
+    componentSizes[id] = size;
+    return id;
+}
+
+const World::Record* World::find(Entity entity) const
+{
+    if (entity.index >= records_.size())
+        return nullptr;
+    const Record& record = records_[entity.index];
+    return record.archetype && record.generation == entity.generation ? &record : nullptr;
+}
+
+bool World::isAlive(Entity entity) const
+{
+    return find(entity) != nullptr;
+}
+
+World::Archetype* World::archetypeFor(Mask mask)
+{
+    for (auto& archetype : archetypes_)
+    {
+        if (archetype->mask == mask)
+            return archetype.get();
+    }
+
+    std::unique_ptr<Archetype> archetype(new Archetype());
+    archetype->mask = mask;
+    size_t rowBytes = sizeof(Entity);
+    for (int id = 0; id < MAX_COMPONENTS; ++id)
+    {
+        archetype->columns[id] = -1;
+        if (mask & (Mask(1) << id))
+        {
+            archetype->columns[id] = (int)archetype->components.size();
+            archetype->components.push_back(id);
+            archetype->sizes.push_back(componentSizes[id]);
+            rowBytes += componentSizes[id];
+        }
+    }
+    // Colunas alinhadas a 16 bytes dentro do chunk; a folga do alinhamento sai da capacidade
+    archetype->capacity = std::max<size_t>(1, (CHUNK_BYTES - 16 * archetype->components.size()) / rowBytes);
+    size_t offset = alignUp(archetype->capacity * sizeof(Entity), 16);
+    for (size_t size : archetype->sizes)
+    {
+        archetype->offsets.push_back(offset);
+        offset = alignUp(offset + archetype->capacity * size, 16);
+    }
+    archetypes_.push_back(std::move(archetype));
+    return archetypes_.back().get();
+}
+
+size_t World::appendRow(Archetype& archetype, Entity entity)
+{
+    if (archetype.count == archetype.chunks.size() * archetype.capacity)
+    {
+        size_t bytes = archetype.offsets.empty() ? archetype.capacity * sizeof(Entity)
+                     : archetype.offsets.back() + archetype.capacity * archetype.sizes.back();
+        archetype.chunks.emplace_back(new unsigned char[bytes]);
+    }
+    size_t row = archetype.count++;
+    archetype.entities(row / archetype.capacity)[row % archetype.capacity] = entity;
+    return row;
+}
+
+// Tapa o buraco com a última linha do arquétipo (o registro dela passa a apontar para row)
+void World::removeRow(Archetype& archetype, size_t row)
+{
+    size_t last = archetype.count - 1;
+    if (row != last)
+    {
+        Entity moved = archetype.entities(last / archetype.capacity)[last % archetype.capacity];
+        archetype.entities(row / archetype.capacity)[row % archetype.capacity] = moved;
+        for (size_t column = 0; column < archetype.sizes.size(); ++column)
+            memcpy(archetype.at((int)column, row), archetype.at((int)column, last), archetype.sizes[column]);
+        records_[moved.index].row = row;
+    }
+    --archetype.count;
+    if (archetype.count <= (archetype.chunks.size() - 1) * archetype.capacity)
+        archetype.chunks.pop_back();
+}
+
+Entity World::createEntity(Mask mask)
+{
+    Entity entity;
+    if (!freeRecords_.empty())
+    {
+        entity.index = freeRecords_.back();
+        freeRecords_.pop_back();
+    }
+    else
+    {
+        entity.index = (uint32_t)records_.size();
+        records_.push_back(Record());
+    }
+    Record& record = records_[entity.index];
+    entity.generation = record.generation;
+    record.archetype = archetypeFor(mask);
+    record.row = appendRow(*record.archetype, entity);
+    return entity;
+}
+
+void World::destroy(Entity entity)
+{
+    if (!find(entity))
+        return;
+    Record& record = records_[entity.index];
+    removeRow(*record.archetype, record.row);
+    record.archetype = nullptr;
+    ++record.generation;
+    freeRecords_.push_back(entity.index);
+}
+
+// Copia os componentes em comum para o arquétipo de mask; os novos ficam para quem chamou preencher
+void World::move(Entity entity, Mask mask)
+{
+    Record& record = records_[entity.index];
+    Archetype& from = *record.archetype;
+    Archetype& to = *archetypeFor(mask);
+    size_t row = appendRow(to, entity);
+    for (size_t column = 0; column < from.components.size(); ++column)
+    {
+        int target = to.columns[from.components[column]];
+        if (target >= 0)
+            memcpy(to.at(target, row), from.at((int)column, record.row), from.sizes[column]);
+    }
+    removeRow(from, record.row);
+    record.archetype = &to;
+    record.row = row;
+}
+
+void World::clear()
+{
+    for (Record& record : records_)
+    {
+        if (record.archetype)
+            ++record.generation;
+        record.archetype = nullptr;
+    }
+    freeRecords_.clear();
+    for (uint32_t index = (uint32_t)records_.size(); index > 0; --index)
+        freeRecords_.push_back(index - 1);
+    archetypes_.clear();
+}
+
+size_t World::getChunkCount() const
+{
+    size_t chunks = 0;
+    for (const auto& archetype : archetypes_)
+        chunks += archetype->chunks.size();
+    return chunks;
+}
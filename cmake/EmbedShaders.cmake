@@ -0,0 +1,22 @@
+# Gera um header com o código de todos os shaders em SHADER_DIR.
+# Uso: cmake -DSHADER_DIR=<dir> -DOUTPUT=<header> -P EmbedShaders.cmake
+file(GLOB SHADER_FILES "${SHADER_DIR}/*.vs" "${SHADER_DIR}/*.fs")
+list(SORT SHADER_FILES)
+
+set(CONTENT "// Gerado por cmake/EmbedShaders.cmake - não editar\n#pragma once\n\n")
+string(APPEND CONTENT "struct EmbeddedShader {\n    const char* name;\n    const char* source;\n};\n\n")
+string(APPEND CONTENT "static const EmbeddedShader EMBEDDED_SHADERS[] = {\n")
+foreach(SHADER_FILE ${SHADER_FILES})
+    get_filename_component(SHADER_NAME ${SHADER_FILE} NAME)
+    file(READ ${SHADER_FILE} SHADER_SOURCE)
+    string(APPEND CONTENT "    { \"${SHADER_NAME}\", R\"glsl(${SHADER_SOURCE})glsl\" },\n")
+endforeach()
+string(APPEND CONTENT "};\n")
+
+# Só reescreve se mudou, para não recompilar tudo a cada build
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
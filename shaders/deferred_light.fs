@@ -0,0 +1,130 @@
+#version 330 core
+out vec4 FragColor;
+
+#define MAX_LIGHTS 256
+
+// Mesmo bloco de object.fs, preenchido por ClusteredLighting
+layout (std140) uniform Lights {
+    vec4 ambient;
+    uvec4 clusterDims;
+    vec4 clusterDepth;
+    vec4 clusterTile;
+    vec4 shAmbient[9];
+    vec4 lightPosRadius[MAX_LIGHTS];
+    vec4 lightDiffuse[MAX_LIGHTS];
+    vec4 lightSpecular[MAX_LIGHTS];
+};
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gSpecular;
+uniform sampler2D gAmbient;
+uniform sampler2D gDepth;
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer clusterLights;
+
+// Preenchido por ShadowMaps: regiões do atlas de profundidade por luz com sombra
+#define MAX_SHADOWED_LIGHTS 4
+uniform sampler2DShadow shadowAtlas;
+uniform int shadowCount;
+uniform int shadowLight[MAX_SHADOWED_LIGHTS];
+uniform mat4 shadowMatrix[MAX_SHADOWED_LIGHTS];
+uniform vec4 shadowRect[MAX_SHADOWED_LIGHTS];
+uniform float shadowTexel;
+
+uniform mat4 invViewProjection;
+uniform vec3 viewPos;
+
+// Mesmo polinômio de object.fs
+vec3 ambientLight(vec3 n)
+{
+    vec3 sh = shAmbient[0].rgb
+            + shAmbient[1].rgb * n.y + shAmbient[2].rgb * n.z + shAmbient[3].rgb * n.x
+            + shAmbient[4].rgb * (n.x * n.y) + shAmbient[5].rgb * (n.y * n.z)
+            + shAmbient[6].rgb * (3.0 * n.z * n.z - 1.0)
+            + shAmbient[7].rgb * (n.x * n.z) + shAmbient[8].rgb * (n.x * n.x - n.y * n.y);
+    return max(sh, vec3(0.0));
+}
+
+in vec2 TexCoord;
+
+int clusterIndex(float depth)
+{
+    float n = clusterDepth.x;
+    float f = clusterDepth.y;
+    float zNdc = depth * 2.0 - 1.0;
+    float viewZ = 2.0 * n * f / (f + n - zNdc * (f - n));
+
+    int slice = int(max(log(viewZ) * clusterDepth.z - clusterDepth.w, 0.0));
+    ivec2 tile = ivec2(gl_FragCoord.xy / clusterTile.xy);
+    ivec3 dims = ivec3(clusterDims.xyz);
+    tile = min(tile, dims.xy - 1);
+    slice = min(slice, dims.z - 1);
+    return tile.x + dims.x * (tile.y + dims.y * slice);
+}
+
+// PCF 3x3; cada amostra já é filtrada bilinearmente pela comparação em hardware
+float shadowFactor(int light, vec3 worldPos, vec3 normal)
+{
+    for (int s = 0; s < shadowCount; ++s)
+    {
+        if (shadowLight[s] != light) continue;
+
+        vec4 p = shadowMatrix[s] * vec4(worldPos + normal * 0.01, 1.0);
+        if (p.w <= 0.0) return 1.0;
+        vec3 coord = p.xyz / p.w;
+        if (coord.z > 1.0) return 1.0;
+        // Fora do frustum da luz (cone de 120° das luzes dentro da cena) não há o que comparar: as
+        // amostras presas na borda da região dariam faixas de sombra falsas
+        vec2 margin = vec2(0.5 * shadowTexel);
+        if (any(lessThan(coord.xy, shadowRect[s].xy - margin)) || any(greaterThan(coord.xy, shadowRect[s].zw + margin))) return 1.0;
+
+        float lit = 0.0;
+        for (int y = -1; y <= 1; ++y)
+            for (int x = -1; x <= 1; ++x)
+            {
+                vec2 uv = clamp(coord.xy + vec2(x, y) * shadowTexel, shadowRect[s].xy, shadowRect[s].zw);
+                lit += texture(shadowAtlas, vec3(uv, coord.z - 0.0005));
+            }
+        return lit / 9.0;
+    }
+    return 1.0;
+}
+
+void main()
+{
+    float depth = texture(gDepth, TexCoord).r;
+    if (depth >= 1.0)
+        discard; // fundo: mantém a cor de limpeza
+
+    vec4 clipPos = vec4(vec3(TexCoord, depth) * 2.0 - 1.0, 1.0);
+    vec4 worldPos = invViewProjection * clipPos;
+    vec3 fragPos = worldPos.xyz / worldPos.w;
+
+    vec3 albedo = texture(gAlbedo, TexCoord).rgb;
+    vec4 normalNs = texture(gNormal, TexCoord);
+    vec3 specColor = texture(gSpecular, TexCoord).rgb;
+    vec3 norm = normalize(normalNs.xyz);
+    vec3 viewDir = normalize(viewPos - fragPos);
+
+    vec3 result = texture(gAmbient, TexCoord).rgb * ambientLight(norm);
+
+    uvec2 cluster = texelFetch(clusterGrid, clusterIndex(depth)).rg;
+    for (uint i = 0u; i < cluster.y; ++i)
+    {
+        int l = int(texelFetch(clusterLights, int(cluster.x + i)).r);
+        vec3 toLight = lightPosRadius[l].xyz - fragPos;
+        float dist = length(toLight);
+        float attenuation = clamp(1.0 - dist / lightPosRadius[l].w, 0.0, 1.0);
+        attenuation *= attenuation * shadowFactor(l, fragPos, norm);
+
+        vec3 lightDir = toLight / dist;
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), normalNs.w);
+
+        result += (lightDiffuse[l].rgb * diff * albedo + lightSpecular[l].rgb * spec * specColor) * attenuation;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 330 core
+// Triângulo de tela cheia gerado a partir de gl_VertexID (sem VBO)
+out vec2 TexCoord;
+
+void main()
+{
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,45 @@
+#version 330 core
+layout (location = 0) out vec4 gAlbedo;   // rgb: Kd * textura
+layout (location = 1) out vec4 gNormal;   // xyz: normal em mundo, w: Ns
+layout (location = 2) out vec4 gSpecular; // rgb: Ks * textura
+layout (location = 3) out vec4 gAmbient;  // rgb: Ka * textura * oclusão; a luz ambiente (SH) entra no passe de luz
+
+// Transformação e material do objeto, do FrameRing (Mesh::ObjectBlock, layout std140)
+layout (std140) uniform Object {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 Ka;
+    vec4 Kd;
+    vec4 Ks; // a: Ns
+} object;
+#ifdef TEXTURED
+#ifdef TEXTURE_ARRAY
+// Camada do objeto no array do seu bucket de tamanho (TextureArrays)
+uniform sampler2DArray texture_diffuse1;
+uniform int textureLayer;
+#else
+uniform sampler2D texture_diffuse1;
+#endif
+#endif
+
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 TexCoord;
+in float Occlusion;
+
+void main()
+{
+#ifdef TEXTURED
+#ifdef TEXTURE_ARRAY
+    vec3 texColor = texture(texture_diffuse1, vec3(TexCoord, float(textureLayer))).rgb;
+#else
+    vec3 texColor = texture(texture_diffuse1, TexCoord).rgb;
+#endif
+#else
+    vec3 texColor = vec3(1.0);
+#endif
+    gAlbedo = vec4(object.Kd.rgb * texColor, 1.0);
+    gNormal = vec4(normalize(Normal), object.Ks.a);
+    gSpecular = vec4(object.Ks.rgb * texColor, 1.0);
+    gAmbient = vec4(object.Ka.rgb * texColor * Occlusion, 1.0);
+}
@@ -1,46 +1,167 @@
 #version 330 core
 out vec4 FragColor;
 
-struct Material {
-    vec3 Ka;
-    vec3 Kd;
-    vec3 Ks;
-    float Ns;
-}; 
-
-struct Light {
-    vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+#define MAX_LIGHTS 256
+
+// Preenchido por ClusteredLighting (layout std140)
+layout (std140) uniform Lights {
+    vec4 ambient;        // rgb: soma dos termos ambientes
+    uvec4 clusterDims;   // xyz: clusters por eixo, w: número de luzes
+    vec4 clusterDepth;   // x: near, y: far, z/w: escala e bias da fatia logarítmica
+    vec4 clusterTile;    // xy: tamanho do tile em pixels
+    vec4 shAmbient[9];   // rgb: ambiente em SH de ordem 2 (EnvironmentLighting), já com o ambiente plano
+    vec4 lightPosRadius[MAX_LIGHTS];
+    vec4 lightDiffuse[MAX_LIGHTS];
+    vec4 lightSpecular[MAX_LIGHTS];
 };
 
-uniform Material material;
-uniform Light light;
+// Transformação e material do objeto, do FrameRing (Mesh::ObjectBlock, layout std140)
+layout (std140) uniform Object {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 Ka;
+    vec4 Kd;
+    vec4 Ks; // a: Ns
+} object;
 uniform vec3 viewPos;
+#ifdef TEXTURED
+#ifdef TEXTURE_ARRAY
+// Camada do objeto no array do seu bucket de tamanho (TextureArrays)
+uniform sampler2DArray texture_diffuse1;
+uniform int textureLayer;
+#else
 uniform sampler2D texture_diffuse1;
+#endif
+#endif
+uniform usamplerBuffer clusterGrid;   // (offset, count) por cluster
+uniform usamplerBuffer clusterLights; // índices de luz
+
+// Preenchido por ShadowMaps: regiões do atlas de profundidade por luz com sombra
+#define MAX_SHADOWED_LIGHTS 4
+uniform sampler2DShadow shadowAtlas;
+uniform int shadowCount;
+uniform int shadowLight[MAX_SHADOWED_LIGHTS];
+uniform mat4 shadowMatrix[MAX_SHADOWED_LIGHTS];
+uniform vec4 shadowRect[MAX_SHADOWED_LIGHTS];
+uniform float shadowTexel;
 
 in vec3 Normal;
 in vec3 FragPos;
 in vec2 TexCoord;
+in float Occlusion;
+
+#ifdef LIGHTMAP
+// Difuso (sem Kd) das luzes com índice < bakedLights, com as sombras dos estáticos, assado pelo
+// LightmapBaker. O atlas estático (só objetos sem animação) separa a sombra dos animados
+uniform sampler2D lightmap;
+uniform int bakedLights;
+uniform sampler2DShadow staticShadowAtlas;
+in vec2 LightmapUV;
+#endif
+
+// Luz ambiente na direção da normal: só multiplicações e somas sobre os 9 coeficientes
+vec3 ambientLight(vec3 n)
+{
+    vec3 sh = shAmbient[0].rgb
+            + shAmbient[1].rgb * n.y + shAmbient[2].rgb * n.z + shAmbient[3].rgb * n.x
+            + shAmbient[4].rgb * (n.x * n.y) + shAmbient[5].rgb * (n.y * n.z)
+            + shAmbient[6].rgb * (3.0 * n.z * n.z - 1.0)
+            + shAmbient[7].rgb * (n.x * n.z) + shAmbient[8].rgb * (n.x * n.x - n.y * n.y);
+    return max(sh, vec3(0.0));
+}
+
+int clusterIndex()
+{
+    float n = clusterDepth.x;
+    float f = clusterDepth.y;
+    float zNdc = gl_FragCoord.z * 2.0 - 1.0;
+    float viewZ = 2.0 * n * f / (f + n - zNdc * (f - n));
+
+    int slice = int(max(log(viewZ) * clusterDepth.z - clusterDepth.w, 0.0));
+    ivec2 tile = ivec2(gl_FragCoord.xy / clusterTile.xy);
+    ivec3 dims = ivec3(clusterDims.xyz);
+    tile = min(tile, dims.xy - 1);
+    slice = min(slice, dims.z - 1);
+    return tile.x + dims.x * (tile.y + dims.y * slice);
+}
+
+// PCF 3x3; cada amostra já é filtrada bilinearmente pela comparação em hardware
+float shadowFactor(sampler2DShadow atlas, int light, vec3 worldPos, vec3 normal)
+{
+    for (int s = 0; s < shadowCount; ++s)
+    {
+        if (shadowLight[s] != light) continue;
+
+        vec4 p = shadowMatrix[s] * vec4(worldPos + normal * 0.01, 1.0);
+        if (p.w <= 0.0) return 1.0;
+        vec3 coord = p.xyz / p.w;
+        if (coord.z > 1.0) return 1.0;
+        // Fora do frustum da luz (cone de 120° das luzes dentro da cena) não há o que comparar: as
+        // amostras presas na borda da região dariam faixas de sombra falsas
+        vec2 margin = vec2(0.5 * shadowTexel);
+        if (any(lessThan(coord.xy, shadowRect[s].xy - margin)) || any(greaterThan(coord.xy, shadowRect[s].zw + margin))) return 1.0;
+
+        float lit = 0.0;
+        for (int y = -1; y <= 1; ++y)
+            for (int x = -1; x <= 1; ++x)
+            {
+                vec2 uv = clamp(coord.xy + vec2(x, y) * shadowTexel, shadowRect[s].xy, shadowRect[s].zw);
+                lit += texture(atlas, vec3(uv, coord.z - 0.0005));
+            }
+        return lit / 9.0;
+    }
+    return 1.0;
+}
 
 void main()
-{    
+{
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+
     // Ambient
-    vec3 ambient = light.ambient * material.Ka;
+    vec3 result = ambientLight(norm) * object.Ka.rgb * Occlusion;
 
-    // Diffuse 
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(light.position - FragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * (diff * material.Kd);
+    uvec2 cluster = texelFetch(clusterGrid, clusterIndex()).rg;
+    for (uint i = 0u; i < cluster.y; ++i)
+    {
+        int l = int(texelFetch(clusterLights, int(cluster.x + i)).r);
+        vec3 toLight = lightPosRadius[l].xyz - FragPos;
+        float dist = length(toLight);
+        float attenuation = clamp(1.0 - dist / lightPosRadius[l].w, 0.0, 1.0);
+        attenuation *= attenuation;
+        float shadow = shadowFactor(shadowAtlas, l, FragPos, norm);
 
-    // Specular
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);  
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.Ns);
-    vec3 specular = light.specular * (spec * material.Ks);  
+        // Diffuse
+        vec3 lightDir = toLight / dist;
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = lightDiffuse[l].rgb * (diff * object.Kd.rgb);
+
+        // Specular
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), object.Ks.a);
+        vec3 specular = lightSpecular[l].rgb * (spec * object.Ks.rgb);
+
+        vec3 lit = (diffuse + specular) * shadow;
+#ifdef LIGHTMAP
+        // O difuso desta luz já está no lightmap; aqui só sai a parte que os objetos animados tapam
+        // (acesa no atlas estático e na sombra no do frame)
+        if (l < bakedLights) {
+            float moving = max(shadowFactor(staticShadowAtlas, l, FragPos, norm) - shadow, 0.0);
+            lit = specular * shadow - diffuse * moving;
+        }
+#endif
+        result += lit * attenuation;
+    }
 
-    vec3 result = (ambient + diffuse + specular) * texture(texture_diffuse1, TexCoord).rgb;
+#ifdef LIGHTMAP
+    result = max(result + texture(lightmap, LightmapUV).rgb * object.Kd.rgb, vec3(0.0));
+#endif
+#ifdef TEXTURED
+#ifdef TEXTURE_ARRAY
+    result *= texture(texture_diffuse1, vec3(TexCoord, float(textureLayer))).rgb;
+#else
+    result *= texture(texture_diffuse1, TexCoord).rgb;
+#endif
+#endif
     FragColor = vec4(result, 1.0);
-}
\ No newline at end of file
+}
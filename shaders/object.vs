@@ -2,19 +2,37 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aOcclusion; // oclusão ambiente assada por vértice
+#ifdef LIGHTMAP
+layout (location = 4) in vec2 aLightmapUV; // segunda UV, no atlas do LightmapBaker
+out vec2 LightmapUV;
+#endif
 
 out vec3 Normal;
 out vec3 FragPos;
 out vec2 TexCoord;
+out float Occlusion;
+
+// Transformação e material do objeto, do FrameRing (Mesh::ObjectBlock, layout std140)
+layout (std140) uniform Object {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 Ka;
+    vec4 Kd;
+    vec4 Ks; // a: Ns
+} object;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
+    FragPos = vec3(object.model * vec4(aPos, 1.0));
+    Normal = mat3(object.normalMatrix) * aNormal;
     TexCoord = aTexCoord;
+    Occlusion = aOcclusion;
+#ifdef LIGHTMAP
+    LightmapUV = aLightmapUV;
+#endif
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 330 core
+
+// Só profundidade: nenhum alvo de cor está ligado
+void main()
+{
+}
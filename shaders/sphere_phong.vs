@@ -0,0 +1,21 @@
+#version 400
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec3 normal;
+layout (location = 3) in vec2 texc;
+
+uniform mat4 projection;
+uniform mat4 model;
+
+out vec2 texCoord;
+out vec3 vNormal;
+out vec4 fragPos; 
+out vec4 vColor;
+void main()
+{
+   	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
+	fragPos = model * vec4(position.x, position.y, position.z, 1.0);
+	texCoord = texc;
+	vNormal = normal;
+	vColor = vec4(color,1.0);
+}
@@ -23,21 +23,28 @@ struct PointLight {
     float constant;
     float linear;
     float quadratic;
-    bool enabled;
 };
 
+// Quantidade de luzes ativas escolhida na compilação (ShaderDefines), na ordem key, fill, back.
+// Sem o define nenhuma luz é avaliada, como acontecia com enabled = false.
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS 0
+#endif
+
+#if NUM_LIGHTS > 0
 uniform PointLight keyLight;
+#endif
+#if NUM_LIGHTS > 1
 uniform PointLight fillLight;
+#endif
+#if NUM_LIGHTS > 2
 uniform PointLight backLight;
+#endif
 
 uniform vec3 viewPos;
 
 vec3 calculateLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
-    if (!light.enabled) {
-        return vec3(0.0);
-    }
-
     vec3 ambient = light.ambient * material.Ka;
 
     vec3 lightDir = normalize(light.position - fragPos);
@@ -65,9 +72,15 @@ void main()
     vec3 viewDir = normalize(viewPos - FragPos);
     vec3 result = vec3(0.0);
 
+#if NUM_LIGHTS > 0
     result += calculateLight(keyLight, norm, FragPos, viewDir);
+#endif
+#if NUM_LIGHTS > 1
     result += calculateLight(fillLight, norm, FragPos, viewDir);
+#endif
+#if NUM_LIGHTS > 2
     result += calculateLight(backLight, norm, FragPos, viewDir);
+#endif
 
     FragColor = vec4(result, 1.0) * texture(tex_buffer, TexCoords);
 }
\ No newline at end of file
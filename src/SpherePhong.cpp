@@ -27,15 +27,17 @@ using namespace std;
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "Shader.h"
+
 using namespace glm;
 
 #include <cmath>
+#include <vector>
 
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
 // Protótipos das funções
-int setupShader();
 int setupGeometry();
 GLuint loadTexture(string filePath, int &width, int &height);
 
@@ -45,73 +47,6 @@ GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVert
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 800;
 
-// Código fonte do Vertex Shader (em GLSL): ainda hardcoded
-const GLchar *vertexShaderSource = R"(
-#version 400
-layout (location = 0) in vec3 position;
-layout (location = 1) in vec3 color;
-layout (location = 2) in vec3 normal;
-layout (location = 3) in vec2 texc;
-
-uniform mat4 projection;
-uniform mat4 model;
-
-out vec2 texCoord;
-out vec3 vNormal;
-out vec4 fragPos; 
-out vec4 vColor;
-void main()
-{
-   	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
-	fragPos = model * vec4(position.x, position.y, position.z, 1.0);
-	texCoord = texc;
-	vNormal = normal;
-	vColor = vec4(color,1.0);
-})";
-
-// Código fonte do Fragment Shader (em GLSL): ainda hardcoded
-const GLchar *fragmentShaderSource = R"(
-#version 400
-in vec2 texCoord;
-uniform sampler2D texBuff;
-uniform vec3 lightPos;
-uniform vec3 camPos;
-uniform float ka;
-uniform float kd;
-uniform float ks;
-uniform float q;
-out vec4 color;
-in vec4 fragPos;
-in vec3 vNormal;
-in vec4 vColor;
-void main()
-{
-
-	vec3 lightColor = vec3(1.0,1.0,1.0);
-	//vec4 objectColor = texture(texBuff,texCoord);
-	vec4 objectColor = vColor;
-
-	//Coeficiente de luz ambiente
-	vec3 ambient = ka * lightColor;
-
-	//Coeficiente de reflexão difusa
-	vec3 N = normalize(vNormal);
-	vec3 L = normalize(lightPos - vec3(fragPos));
-	float diff = max(dot(N, L),0.0);
-	vec3 diffuse = kd * diff * lightColor;
-
-	//Coeficiente de reflexão especular
-	vec3 R = normalize(reflect(-L,N));
-	vec3 V = normalize(camPos - vec3(fragPos));
-	float spec = max(dot(R,V),0.0);
-	spec = pow(spec,q);
-	vec3 specular = ks * spec * lightColor; 
-
-	vec3 result = (ambient + diffuse) * vec3(objectColor) + specular;
-	color = vec4(result,1.0);
-
-})";
-
 // Função MAIN
 int main()
 {
@@ -156,7 +91,9 @@ int main()
 	glViewport(0, 0, width, height);
 
 	// Compilando e buildando o programa de shader
-	GLuint shaderID = setupShader();
+	// Sem TEXTURED a esfera usa a cor por vértice; passe { "TEXTURED", "" } para usar pixelWall.png
+	Shader sphereShader("../shaders/sphere_phong.vs", "../shaders/sphere_phong.fs", ShaderDefines());
+	GLuint shaderID = sphereShader.ID;
 
 	// Gerando um buffer simples, com a geometria de um triângulo
 	int nVertices;
@@ -171,7 +108,7 @@ int main()
 	vec3 camPos = vec3(0.0,0.0,-3.0);
 
 
-	glUseProgram(shaderID);
+	sphereShader.Use();
 
 	// Enviar a informação de qual variável armazenará o buffer da textura
 	glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
@@ -234,58 +171,6 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 		glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
-// Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
-//  shader simples e único neste exemplo de código
-//  O código fonte do vertex e fragment shader está nos arrays vertexShaderSource e
-//  fragmentShader source no iniçio deste arquivo
-//  A função retorna o identificador do programa de shader
-int setupShader()
-{
-	// Vertex shader
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Fragment shader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Linkando os shaders e criando o identificador do programa de shader
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	// Checando por erros de linkagem
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 // Esta função está bastante harcoded - objetivo é criar os buffers que armazenam a
 // geometria de um triângulo
 // Apenas atributo coordenada nos vértices
@@ -0,0 +1,255 @@
+/*
+ * jobbench.cpp - Escalabilidade do JobSystem de 1 a N threads
+ *
+ * Funcionalidades:
+ * - Transformações e frustum culling de muitos objetos sintéticos (o laço por mesh do trab)
+ * - Avaliação de uma curva de Bezier longa (Bezier::generateCurve, sem GPU)
+ * - Recursão fork-join aninhada (parallelFor dentro de parallelFor)
+ * - Rasterização em CPU da cena do trabalho (SoftwareRasterizer), se o scene_config.json carregar
+ * - Para cada contagem de threads: melhor tempo de --runs execuções, aceleração sobre 1 thread e roubos
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Camera.h"
+#include "Mesh.h"
+#include "Bezier.h"
+#include "Scene.h"
+#include "SoftwareRasterizer.h"
+#include "JobSystem.h"
+
+struct Options {
+    std::string config = "../assets/scene_config.json";
+    unsigned int maxThreads = 0;  // 0 = núcleos da máquina
+    int runs = 5;
+    int objects = 200000;
+    int segments = 4096;
+    int recursion = 1 << 22;
+    int frames = 10;
+    bool raster = true;
+};
+
+struct SyntheticObject {
+    glm::vec3 position;
+    glm::vec3 axis;
+    float angle;
+    float scale;
+    float radius;
+};
+
+// Mesmo trabalho do trab por objeto: matriz de modelo, matriz normal, esfera no mundo e 6 planos
+int cullObjects(JobSystem& jobs, const std::vector<SyntheticObject>& objects, const glm::vec4 (&planes)[6],
+                std::vector<Mesh::ObjectBlock>& blocks, std::vector<char>& visible) {
+    jobs.parallelFor((int)objects.size(), [&](int i) {
+        const SyntheticObject& object = objects[i];
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), object.position);
+        model = glm::rotate(model, object.angle, object.axis);
+        model = glm::scale(model, glm::vec3(object.scale));
+        blocks[i].model = model;
+        blocks[i].normalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model))));
+
+        glm::vec3 center = glm::vec3(model[3]);
+        float radius = object.radius * object.scale;
+        visible[i] = 1;
+        for (const glm::vec4& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius * glm::length(glm::vec3(plane))) {
+                visible[i] = 0;
+                break;
+            }
+        }
+    }, 256);
+
+    int count = 0;
+    for (char v : visible) {
+        count += v;
+    }
+    return count;
+}
+
+// Divide ao meio até LEAF elementos; cada metade é um parallelFor de 2 itens, então quem espera
+// executa (ou rouba) os filhos dos outros níveis
+const int LEAF = 4096;
+
+double sumRange(JobSystem& jobs, const std::vector<float>& values, int begin, int end) {
+    if (end - begin <= LEAF) {
+        double sum = 0.0;
+        for (int i = begin; i < end; ++i) {
+            sum += std::sqrt(values[i]) * std::sin(values[i]);
+        }
+        return sum;
+    }
+    int middle = begin + (end - begin) / 2;
+    double halves[2];
+    jobs.parallelFor(2, [&](int half) {
+        halves[half] = half == 0 ? sumRange(jobs, values, begin, middle) : sumRange(jobs, values, middle, end);
+    }, 1);
+    return halves[0] + halves[1];
+}
+
+double bestOf(int runs, const std::function<void()>& fn) {
+    double best = 1e30;
+    for (int run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            options.config = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.maxThreads = (unsigned int)atoi(argv[++i]);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            options.runs = atoi(argv[++i]);
+        } else if (arg == "--objects" && i + 1 < argc) {
+            options.objects = atoi(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            options.frames = atoi(argv[++i]);
+        } else if (arg == "--no-raster") {
+            options.raster = false;
+        } else {
+            cerr << "Uso: jobbench [--threads MAX] [--runs N] [--objects N] [--frames N] [--config ARQ] [--no-raster]" << endl;
+            return 1;
+        }
+    }
+    if (options.runs < 1 || options.objects < 1 || options.frames < 1) {
+        cerr << "Parâmetros inválidos." << endl;
+        return 1;
+    }
+    if (options.maxThreads == 0) {
+        options.maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options.maxThreads = std::min<unsigned int>(options.maxThreads, JobSystem::MAX_THREADS);
+
+    // Objetos espalhados num cubo de 200 unidades em volta de uma câmera na origem
+    std::vector<SyntheticObject> objects(options.objects);
+    srand(1);
+    auto random = []() { return (float)rand() / (float)RAND_MAX; };
+    for (SyntheticObject& object : objects) {
+        object.position = glm::vec3(random(), random(), random()) * 200.0f - glm::vec3(100.0f);
+        object.axis = glm::normalize(glm::vec3(random(), random(), random()) + glm::vec3(0.01f));
+        object.angle = random() * 6.283f;
+        object.scale = 0.5f + random();
+        object.radius = 1.0f;
+    }
+    glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 800.0f / 700.0f, 0.1f, 150.0f) *
+                               glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec4 planes[6];
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec4 row(viewProjection[0][axis], viewProjection[1][axis], viewProjection[2][axis], viewProjection[3][axis]);
+        glm::vec4 w(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+        planes[axis * 2] = w + row;
+        planes[axis * 2 + 1] = w - row;
+    }
+    std::vector<Mesh::ObjectBlock> blocks(objects.size());
+    std::vector<char> visible(objects.size());
+
+    std::vector<glm::vec3> controlPoints;
+    for (int i = 0; i <= options.segments * 3; ++i) {
+        controlPoints.push_back(glm::vec3(std::cos(i * 0.1f), std::sin(i * 0.07f), i * 0.01f));
+    }
+    Bezier bezier;
+    bezier.setGpuUpload(false);
+    bezier.setControlPoints(controlPoints);
+
+    std::vector<float> values(options.recursion);
+    for (int i = 0; i < options.recursion; ++i) {
+        values[i] = (float)(i % 1000) * 0.01f;
+    }
+
+    Scene scene;
+    Camera camera;
+    std::vector<Mesh> meshes;
+    std::vector<Bezier> bezierCurves;
+    if (options.raster) {
+        options.raster = scene.loadConfig(options.config);
+        if (options.raster) {
+            scene.uploadToGpu = false;
+            scene.keepCpuData = true;
+            scene.bakeLightmaps = false;
+            scene.setupScene(nullptr, nullptr, &camera, meshes, bezierCurves);
+            camera.setCameraPosInitial(scene.cameraInitialPos);
+            camera.setCameraFrontInitial(scene.cameraInitialFront);
+            camera.setCameraUpInitial(scene.cameraInitialUp);
+            camera.setProjection(scene.cameraFov, 800.0f / 700.0f, scene.cameraNearPlane, scene.cameraFarPlane);
+            for (Mesh& mesh : meshes) {
+                mesh.update(false, false, false);
+            }
+        } else {
+            cerr << "Sem a cena (" << options.config << "): rasterização fora da medida" << endl;
+        }
+    }
+
+    cout << options.objects << " objetos, curva de " << options.segments << " segmentos, recursão sobre "
+         << options.recursion << " valores" << (options.raster ? ", " + std::to_string(options.frames) + " frames de raster" : "")
+         << "; melhor de " << options.runs << " execuções" << endl;
+    printf("%8s %18s %18s %18s %18s %10s\n", "threads", "culling ms", "bezier ms", "fork-join ms", "raster ms", "roubos");
+
+    double baseline[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int referenceVisible = -1;
+    double referenceSum = 0.0;
+    for (unsigned int threads = 1; threads <= options.maxThreads; ++threads) {
+        JobSystem jobs(threads);
+        bezier.setJobSystem(&jobs);
+
+        int visibleCount = 0;
+        double sum = 0.0;
+        double ms[4] = { 0.0, 0.0, 0.0, 0.0 };
+        ms[0] = bestOf(options.runs, [&]() { visibleCount = cullObjects(jobs, objects, planes, blocks, visible); });
+        ms[1] = bestOf(options.runs, [&]() { bezier.generateCurve(100); });
+        ms[2] = bestOf(options.runs, [&]() { sum = sumRange(jobs, values, 0, (int)values.size()); });
+        if (options.raster) {
+            SoftwareRasterizer rasterizer;
+            rasterizer.setJobSystem(&jobs);
+            rasterizer.setEnvironment(&scene.environment);
+            rasterizer.resize(800, 700);
+            ms[3] = bestOf(options.runs, [&]() {
+                for (int frame = 0; frame < options.frames; ++frame) {
+                    rasterizer.render(camera, meshes, scene.lightSources);
+                }
+            });
+        }
+
+        // A divisão em jobs não pode mudar o resultado
+        if (threads == 1) {
+            std::copy(ms, ms + 4, baseline);
+            referenceVisible = visibleCount;
+            referenceSum = sum;
+        } else if (visibleCount != referenceVisible || sum != referenceSum) {
+            cerr << "Resultado diferente com " << threads << " threads: " << visibleCount << " visíveis (esperado "
+                 << referenceVisible << "), soma " << sum << " (esperado " << referenceSum << ")" << endl;
+            return 1;
+        }
+
+        char cells[4][32];
+        for (int k = 0; k < 4; ++k) {
+            if (k == 3 && !options.raster) {
+                snprintf(cells[k], sizeof(cells[k]), "-");
+            } else {
+                snprintf(cells[k], sizeof(cells[k]), "%.2f (%.2fx)", ms[k], baseline[k] / ms[k]);
+            }
+        }
+        printf("%8u %18s %18s %18s %18s %10llu\n", threads, cells[0], cells[1], cells[2], cells[3], jobs.getSteals());
+    }
+    cout << referenceVisible << " de " << options.objects << " objetos visíveis" << endl;
+    return 0;
+}
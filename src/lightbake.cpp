@@ -0,0 +1,95 @@
+/*
+ * lightbake.cpp - Pré-calcula os dados estáticos da cena do trabalho
+ *
+ * Funcionalidades:
+ * - Lê o mesmo scene_config.json do trab, sem contexto OpenGL
+ * - Assa lightmaps (luz difusa direta com sombras) e oclusão ambiente dos objetos estáticos
+ * - Cozinha as texturas dos objetos com a cadeia de mips completa (TextureCache), em BC1/BC3,
+ *   e informa tamanho, PSNR e a vazão da compressão de cada uma
+ * - Grava tudo no cache em disco (../cache/), que o trab só lê ao iniciar
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "Mesh.h"
+#include "Bezier.h"
+#include "Scene.h"
+#include "TextureCache.h"
+
+int main(int argc, char** argv) {
+    std::string config = "../assets/scene_config.json";
+    int resolution = 0; // 0 = o do scene_config.json
+    bool recook = false;
+    bool compression = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            config = argv[++i];
+        } else if (arg == "--resolution" && i + 1 < argc) {
+            resolution = atoi(argv[++i]);
+        } else if (arg == "--recook") {
+            recook = true;
+        } else if (arg == "--no-compression") {
+            compression = false;
+        } else {
+            cerr << "Uso: lightbake [--config ARQ] [--resolution N] [--recook] [--no-compression]" << endl;
+            return 1;
+        }
+    }
+
+    Scene scene;
+    if (!scene.loadConfig(config)) {
+        cerr << "Falha ao carregar configuração da cena. Saindo." << endl;
+        return 1;
+    }
+    scene.uploadToGpu = false;
+    scene.bakeLightmaps = true;
+    if (resolution > 0) {
+        scene.lightmapResolution = resolution;
+    }
+
+    TextureCache::instance().setRecook(recook);
+    TextureCache::instance().setCompression(compression);
+
+    Camera camera;
+    std::vector<Mesh> meshes;
+    std::vector<Bezier> bezierCurves;
+    auto start = std::chrono::steady_clock::now();
+    scene.setupScene(nullptr, nullptr, &camera, meshes, bezierCurves);
+    int textures = 0;
+    for (const auto& objConfig : scene.objects) {
+        textures += TextureCache::instance().cook(objConfig.texture_path) ? 1 : 0;
+    }
+    for (int page = 0; scene.atlasTextures && page < scene.atlas.getPageCount(); ++page) {
+        textures += TextureCache::instance().cook(scene.atlas.getPagePath(page)) ? 1 : 0;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    cout << meshes.size() << " objetos carregados e assados, " << textures << " texturas cozidas ("
+         << TextureCache::instance().getMisses() << " atualizadas) em " << seconds << " s" << endl;
+
+    const char* formats[] = { "RGBA8", "BC1", "BC3" };
+    double rgbaMegabytes = 0.0, encodeMs = 0.0;
+    for (const auto& report : TextureCache::instance().getCookReports()) {
+        printf("  %s %dx%d %s: %.1f MB -> %.1f MB, PSNR %.2f dB, %.0f ms\n", report.path.c_str(), report.width, report.height,
+               formats[report.format], report.rgbaBytes / 1048576.0, report.cookedBytes / 1048576.0, report.psnr, report.encodeMs);
+        if (report.format != CookedTexture::RGBA8) {
+            rgbaMegabytes += report.rgbaBytes / 1048576.0;
+            encodeMs += report.encodeMs;
+        }
+    }
+    if (encodeMs > 0.0) {
+        printf("  compressão: %.1f MB/s\n", rgbaMegabytes / (encodeMs / 1000.0));
+    }
+    return 0;
+}
@@ -21,6 +21,7 @@ using namespace std;
 #include "stb_image.h"
 
 #include "Shader.h"
+#include "TextureCache.h"
 
 vector<GLfloat> vertices;
 vector<GLfloat> textures;
@@ -344,35 +345,8 @@ void readFromObj(string path) {
 
 int loadTexture(string path)
 {
-    GLuint texID;
-
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data)
-    {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        cout << "Falha ao carregar textura: " << path << endl;
-    }
-
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    return texID;
+    // Mips cozidos e mapeados do cache em disco, como no trab
+    return TextureCache::instance().load(path);
 }
 
 
@@ -396,7 +370,7 @@ int main()
     
     GLuint VAO = setupGeometry();
 
-    glUseProgram(shader.ID);
+    shader.Use();
 
     glUniform1i(glGetUniformLocation(shader.ID, "tex_buffer"), 0);
 
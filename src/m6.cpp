@@ -22,6 +22,7 @@ using namespace std;
 
 #include "Shader.h"
 #include "Camera.h"
+#include "TextureCache.h"
 #include "Mesh.h"
 #include "Bezier.h"
 
@@ -227,35 +228,8 @@ void readFromObj(string path) {
 
 int loadTexture(string path)
 {
-    GLuint texID;
-
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data)
-    {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        cout << "Falha ao carregar textura: " << path << endl;
-    }
-
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    return texID;
+    // Mips cozidos e mapeados do cache em disco, como no trab
+    return TextureCache::instance().load(path);
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
@@ -457,7 +431,7 @@ int main()
     
     GLuint VAO = setupGeometry();
 
-    glUseProgram(shader.ID);
+    shader.Use();
 
     shader.setInt("tex_buffer", 0); 
 
@@ -7,11 +7,35 @@
  * - Controle de câmera com mouse e teclado
  * - Animação por curvas de Bezier
  * - Iluminação Phong com materiais do arquivo MTL
+ * - Forward+ clusterizado: centenas de luzes pontuais (tecla L adiciona luzes)
+ * - Modo deferred selecionável em tempo de execução (tecla R), tempos por passe no título
+ * - Shadow maps com cache para objetos estáticos e camada por frame para os animados
+ * - Modo headless (--headless): renderiza num FBO com passo fixo e grava os frames em PNG/PPM
+ * - Gravação dos frames da janela (tecla C), com leitura assíncrona por PBOs
+ * - Rasterizador em CPU (--software) para máquinas sem GPU; --compare mede a diferença para a OpenGL
+ * - Oclusão ambiente assada por vértice nos objetos estáticos, com cache em disco
+ * - Luz ambiente de um mapa de ambiente opcional, em harmônicos esféricos
+ * - Lightmaps assados com a luz difusa direta (e sombras) das luzes da cena nos objetos estáticos
+ * - Texturas decodificadas em threads e enviadas por PBOs sem bloquear o loop de render
+ * - Texturas comprimidas em BC1/BC3 no cozimento quando a GPU tem S3TC
+ * - Memória de vídeo contabilizada por categoria, com orçamento opcional (tecla M mostra o uso)
+ * - Carga da cena, animação, transformações e frustum culling num sistema de jobs com roubo de trabalho
+ * - Objetos e luzes como entidades (World, por arquétipos): a animação só percorre os objetos animados
+ * - Dados temporários do frame e da carga em arenas lineares (std::pmr), sem alocações no heap em regime
  */
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <chrono>
+#include <memory>
 
 using namespace std;
 
@@ -25,17 +49,78 @@ using namespace std;
 #include "Mesh.h"
 #include "Bezier.h"
 #include "Scene.h"
+#include "ClusteredLighting.h"
+#include "DeferredRenderer.h"
+#include "GpuTimer.h"
+#include "ShadowMaps.h"
+#include "GLExtensions.h"
+#include "ShaderCache.h"
+#include "ShaderLibrary.h"
+#include "OffscreenTarget.h"
+#include "FrameCapture.h"
+#include "SoftwareRasterizer.h"
+#include "JobSystem.h"
+#include "AsyncTextureLoader.h"
+#include "TextureCache.h"
+#include "GpuResources.h"
+#include "FrameRing.h"
+#include "World.h"
+#include "LinearArena.h"
+#include "Components.h"
 
 const int WINDOW_WIDTH = 800;
 const int WINDOW_HEIGHT = 700;
 
+enum class RenderMode { Forward, Deferred };
+
+// Passo de simulação do modo headless: o frame N é sempre igual, independente da máquina
+const double HEADLESS_TIMESTEP = 1.0 / 60.0;
+
+// Objetos por job na escrita dos blocos "Object": cenas pequenas ficam num job só
+const int OBJECT_GRAIN = 64;
+
+struct HeadlessOptions {
+    bool enabled = false;
+    bool deferred = false;
+    int frames = 300;
+    int width = WINDOW_WIDTH;
+    int height = WINDOW_HEIGHT;
+    std::string outputDir = "../frames/";
+    std::string format = "png";
+    bool writeFrames = true;
+    bool software = false;     // sem OpenGL: cada frame sai do SoftwareRasterizer
+    bool compare = false;      // renderiza também em CPU e compara com o frame da OpenGL
+    int tolerance = 8;         // diferença por canal aceita no --compare
+    unsigned int threads = 0;  // 0 = JobSystem::shared()
+};
+
 class Application {
 private:
     GLFWwindow* window;
     Camera camera;
+    // Recursos de desenho de cada objeto (Renderable::mesh) e as curvas dos animados (BezierPath::curve)
     std::vector<Mesh> meshes;
     std::vector<Bezier> bezierCurves;
+    // Objetos e luzes da cena como entidades; objectEntities segue a ordem de meshes (teclas 1-9)
+    World world;
+    std::vector<Entity> objectEntities;
     Scene scene;
+    ClusteredLighting clusteredLights;
+    // Dados por frame (blocos "Object" dos meshes e "Lights"), vinculados por intervalo
+    FrameRing frameRing;
+    std::vector<FrameRing::Allocation> objectBlocks;
+    // Meshes visíveis que não couberam no anel neste frame: o bloco vai por glBufferSubData para
+    // objectFallback a cada draw, até o anel dobrar no frame seguinte
+    std::vector<char> overflowedObjects;
+    GLBuffer objectFallback;
+    bool ringOverflowLogged = false;
+    DeferredRenderer deferredRenderer;
+    GpuTimer forwardTimer;
+    ShadowMaps shadowMaps;
+    ShaderLibrary shaderLibrary;
+    std::vector<bool> staticObjects;
+    RenderMode renderMode = RenderMode::Forward;
+    bool deferredAvailable = false;
 
     bool rotateX = false;
     bool rotateY = false;
@@ -46,49 +131,113 @@ private:
     Shader* objectShader = nullptr;
     Shader* curveShader = nullptr;
 
-    std::vector<float> trajectoryProgress;
+    // Ordem do forward: por permutação e depois por textura (meshes continua na ordem da cena)
+    std::vector<size_t> forwardOrder;
+    // Dados que só valem durante o frame (resultado do culling): voltam ao início a cada renderFrame
+    LinearArena frameArena;
+    int textureBinds = 0;
+
+    // Só com --threads; senão JobSystem::shared()
+    std::unique_ptr<JobSystem> jobSystem;
+
+    HeadlessOptions headless;
+    FrameCapture frameCapture;
+    AsyncTextureLoader textureLoader;
+    bool texturesReported = false;
+    bool recording = false;
+    int recordedFrames = 0;
+    bool showCurves = true;
 
 public:
-    Application() : window(nullptr) {}
+    explicit Application(const HeadlessOptions& options) : window(nullptr), headless(options) {}
 
     void run() {
-        setupWindow();
+        if (headless.software) {
+            runSoftware();
+            return;
+        }
+        if (!setupWindow()) {
+            glfwTerminate();
+            return;
+        }
 
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
+        int width = headless.width, height = headless.height;
+        if (!headless.enabled) {
+            glfwGetFramebufferSize(window, &width, &height);
+        }
         glViewport(0, 0, width, height);
 
-        Shader objShader("../shaders/object.vs", "../shaders/object.fs");
-        Shader curShader("../shaders/curve.vs", "../shaders/curve.fs");
-        objectShader = &objShader;
-        curveShader = &curShader;
+        // Todos os programas são disparados antes de carregar a cena; o driver compila enquanto
+        // a CPU lê OBJs e texturas, e cada um só é verificado no primeiro Use()
+        double startupTime = glfwGetTime();
+        objectShader = shaderLibrary.get("object.vs", "object.fs", { { "TEXTURED", "" } });
+        curveShader = shaderLibrary.get("curve.vs", "curve.fs");
+        deferredAvailable = deferredRenderer.initialize(width, height);
+        shadowMaps.initialize();
 
         if (!scene.loadConfig("../assets/scene_config.json")) {
             cerr << "Falha ao carregar configuração da cena. Saindo." << endl;
+            cleanup();
             glfwTerminate();
             return;
         }
 
-        camera.initialize(objectShader, WINDOW_WIDTH, WINDOW_HEIGHT);
+        camera.initialize(objectShader, width, height);
+
+        // O rasterizador em CPU não tem sombras, lightmaps nem curvas; para comparar, a OpenGL também não
+        if (headless.enabled && headless.compare) {
+            scene.keepCpuData = true;
+            scene.bakeLightmaps = false;
+            showCurves = false;
+            for (auto& light : scene.lightSources) {
+                light.castsShadows = false;
+            }
+        }
 
+        // Headless precisa de frames reproduzíveis: todos os mips carregados, sem depender da câmera
+        textureLoader.setStreaming(scene.streamTextures && !headless.enabled);
+        textureLoader.setPreviewSize(scene.texturePreviewSize);
+        textureLoader.setMemoryBudget((size_t)scene.textureMemoryBudgetMB << 20);
+        textureLoader.initialize();
+        scene.textureLoader = &textureLoader;
+        GpuResources::instance().setBudget((size_t)scene.gpuMemoryBudgetMB << 20);
         scene.setupScene(window, objectShader, &camera, meshes, bezierCurves);
+        // Frames do headless precisam ser reproduzíveis: não começa com as texturas provisórias
+        if (headless.enabled) {
+            textureLoader.finish();
+        }
+        assignForwardShaders();
+        applySceneCamera(width, height);
+        spawnEntities();
 
-        camera.setCameraPosInitial(scene.cameraInitialPos);
-        camera.setCameraFrontInitial(scene.cameraInitialFront);
-        camera.setCameraUpInitial(scene.cameraInitialUp);
-        camera.setProjection(scene.cameraFov, (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, scene.cameraNearPlane, scene.cameraFarPlane);
+        // Bloco "Lights" (~13 KB) e um "Object" por mesh, com folga para o alinhamento; dobra se faltar
+        frameRing.initialize(32 * 1024 + meshes.size() * 256);
+        objectBlocks.resize(meshes.size());
+        overflowedObjects.resize(meshes.size());
+        clusteredLights.initialize(width, height);
+        gatherLights();
+        clusteredLights.setLights(scene.lightSources);
+        clusteredLights.setEnvironment(scene.environment);
+        clusteredLights.setFrameRing(&frameRing);
 
-        objectShader->Use();
-        if (!scene.lightSources.empty()) {
-            objectShader->setVec3("light.position", scene.lightSources[0].position);
-            objectShader->setVec3("light.ambient", scene.lightSources[0].ambient);
-            objectShader->setVec3("light.diffuse", scene.lightSources[0].diffuse);
-            objectShader->setVec3("light.specular", scene.lightSources[0].specular);
+        cout << "Inicialização: " << (glfwGetTime() - startupTime) * 1000.0 << " ms (compilação paralela de shaders "
+             << (GLExtensions::hasParallelShaderCompile() ? "ativa" : "indisponível") << ")" << endl;
+        cout << "Cache de shaders: " << (ShaderCache::instance().isActive() ? "ativo" : "indisponível")
+             << " (" << ShaderCache::instance().getHits() << " hits, " << ShaderCache::instance().getMisses() << " misses)" << endl;
+        if (headless.enabled) {
+            if (headless.deferred) {
+                setRenderMode(RenderMode::Deferred);
+            }
+            reportTextures();
+            runHeadless(width, height);
+            reportGpuMemory();
+            cleanup();
+            glfwTerminate();
+            return;
         }
 
-        trajectoryProgress.resize(bezierCurves.size(), 0.0f);
-
         double lastFrameTime = glfwGetTime();
+        double lastTitleTime = lastFrameTime;
 
         while (!glfwWindowShouldClose(window)) {
             double currentFrameTime = glfwGetTime();
@@ -97,56 +246,465 @@ public:
 
             glfwPollEvents();
 
-            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            objectShader->Use();
-            camera.update();
+            renderFrame(deltaTime);
 
-            updateBezierAnimations(deltaTime);
+            if (recording) {
+                char fileName[32];
+                snprintf(fileName, sizeof(fileName), "window_%05d.%s", recordedFrames++, headless.format.c_str());
+                frameCapture.capture(0, headless.outputDir + fileName);
+            }
 
-            updateAndDrawMeshes();
+            if (currentFrameTime - lastTitleTime > 0.5) {
+                updateWindowTitle();
+                lastTitleTime = currentFrameTime;
+            }
 
-            drawBezierCurves();
+            if (!texturesReported && textureLoader.getPending() == 0) {
+                reportTextures();
+            }
 
             glfwSwapBuffers(window);
         }
 
+        frameCapture.flush();
         cleanup();
 
         glfwTerminate();
     }
 
 private:
-    void updateBezierAnimations(double deltaTime) {
+    // Desenha um frame no framebuffer vinculado (janela ou alvo offscreen)
+    void renderFrame(double deltaTime) {
+        frameArena.reset();
+        frameRing.beginFrame();
+        updateTextureStreaming();
+        textureLoader.update();
+
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        clusteredLights.update(camera);
+
+        updatePaths(deltaTime);
+        updateSelectedRotation();
+
+        shadowMaps.update(scene.lightSources, meshes, staticObjects);
+        // O que fica fora do frustum não é desenhado nem conta como uso no GpuResources (char e não
+        // bool: os jobs do teste escrevem elementos vizinhos ao mesmo tempo)
+        std::pmr::vector<char> visibleObjects(meshes.size(), 0, &frameArena);
+        updateVisibility(visibleObjects);
+        writeObjectBlocks(visibleObjects);
+        frameRing.flush();
+
+        if (renderMode == RenderMode::Deferred) {
+            deferredRenderer.beginGeometryPass(camera);
+            drawMeshes();
+            deferredRenderer.endGeometryPass();
+            shadowMaps.bind(deferredRenderer.getLightingShader());
+            deferredRenderer.lightingPass(camera, clusteredLights);
+        } else {
+            forwardTimer.begin();
+            drawMeshesForward();
+            forwardTimer.end();
+        }
+
+        if (showCurves) {
+            curveShader->Use();
+            camera.apply(curveShader);
+            drawBezierCurves();
+        }
+
+        frameRing.endFrame();
+        GpuResources::instance().endFrame();
+    }
+
+    JobSystem& jobs() {
+        return jobSystem ? *jobSystem : JobSystem::shared();
+    }
+
+    // Bloco "Object" de cada mesh visível no segmento do frame: os draws só vinculam o intervalo.
+    // Os intervalos saem do anel em ordem; os blocos são montados na pilha em paralelo e copiados
+    // inteiros, já que a memória mapeada é write-combined
+    void writeObjectBlocks(const std::pmr::vector<char>& visibleObjects) {
+        int overflowed = 0;
         for (size_t i = 0; i < meshes.size(); ++i) {
-            if (i < bezierCurves.size() && bezierCurves[i].getFollowTrajectory()) {
-                int numCurvePoints = bezierCurves[i].getNbCurvePoints();
-                if (numCurvePoints > 0) {
-                    trajectoryProgress[i] += bezierCurves[i].getSpeed() * deltaTime * 100.0f;
-                    if (trajectoryProgress[i] >= 1.0f) {
-                        trajectoryProgress[i] = 0.0f;
-                    }
-                    int curveIndex = static_cast<int>(trajectoryProgress[i] * numCurvePoints);
-                    curveIndex = glm::min(curveIndex, numCurvePoints - 1);
-                    glm::vec3 newPos = bezierCurves[i].getPointOnCurve(curveIndex);
-                    meshes[i].setCurrentPosition(newPos);
+            objectBlocks[i] = visibleObjects[i] ? frameRing.allocate(sizeof(Mesh::ObjectBlock)) : FrameRing::Allocation();
+            overflowedObjects[i] = visibleObjects[i] && !objectBlocks[i].data;
+            overflowed += overflowedObjects[i];
+        }
+        if (overflowed > 0 && !ringOverflowLogged) {
+            ringOverflowLogged = true;
+            cerr << "Anel por frame cheio: " << overflowed << " blocos \"Object\" enviados fora dele (o anel dobra no próximo frame)" << endl;
+        }
+        jobs().parallelFor((int)meshes.size(), [this](int i) {
+            if (objectBlocks[i].data) {
+                Mesh::ObjectBlock block;
+                meshes[i].writeObjectBlock(block);
+                memcpy(objectBlocks[i].data, &block, sizeof(block));
+            }
+        }, OBJECT_GRAIN);
+    }
+
+    // Esfera envolvente de cada mesh contra os 6 planos do frustum (extraídos da view-projection)
+    void updateVisibility(std::pmr::vector<char>& visibleObjects) {
+        glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+        glm::vec4 planes[6];
+        for (int axis = 0; axis < 3; ++axis) {
+            glm::vec4 row(viewProjection[0][axis], viewProjection[1][axis], viewProjection[2][axis], viewProjection[3][axis]);
+            glm::vec4 w(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+            planes[axis * 2] = w + row;
+            planes[axis * 2 + 1] = w - row;
+        }
+        world.parallelEach<Renderable>(jobs(), [this, &planes, &visibleObjects](Entity, Renderable& renderable) {
+            glm::vec3 center = meshes[renderable.mesh].getWorldBoundsCenter();
+            float radius = meshes[renderable.mesh].getWorldBoundsRadius();
+            for (const glm::vec4& plane : planes) {
+                if (glm::dot(glm::vec3(plane), center) + plane.w < -radius * glm::length(glm::vec3(plane))) {
+                    return;
                 }
             }
+            visibleObjects[renderable.mesh] = 1;
+        });
+    }
+
+    // Tamanho na tela de cada textura do loader, pela esfera envolvente do objeto: o diâmetro projetado
+    // vezes 2 (a superfície desdobrada é maior que a silhueta), dividido pela parte da imagem que as UVs cobrem
+    void updateTextureStreaming() {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        float pixelsPerUnit = height / std::tan(glm::radians(camera.getFov()) * 0.5f);
+        glm::vec3 eye = camera.getCameraPos();
+        for (const auto& mesh : meshes) {
+            if (mesh.getTextureID() == 0 || mesh.getTextureLayer() >= 0) {
+                continue;
+            }
+            float radius = mesh.getWorldBoundsRadius();
+            float distance = std::max(glm::length(mesh.getWorldBoundsCenter() - eye), std::max(radius, 1e-3f));
+            textureLoader.requestScreenSize(mesh.getTextureID(), 2.0f * radius / distance * pixelsPerUnit / mesh.getTextureExtent());
         }
     }
 
-    void updateAndDrawMeshes() {
-        for (size_t i = 0; i < meshes.size(); ++i) {
-            bool currentObjectRotationX = (i == selectedObjectIndex) ? rotateX : false;
-            bool currentObjectRotationY = (i == selectedObjectIndex) ? rotateY : false;
-            bool currentObjectRotationZ = (i == selectedObjectIndex) ? rotateZ : false;
+    void applySceneCamera(int width, int height) {
+        camera.setCameraPosInitial(scene.cameraInitialPos);
+        camera.setCameraFrontInitial(scene.cameraInitialFront);
+        camera.setCameraUpInitial(scene.cameraInitialUp);
+        camera.setProjection(scene.cameraFov, (float)width / (float)height, scene.cameraNearPlane, scene.cameraFarPlane);
+    }
+
+    // Sem vsync nem swap: renderiza o mais rápido possível num FBO, com passo fixo
+    void runHeadless(int width, int height) {
+        OffscreenTarget target;
+        if (!target.initialize(width, height)) {
+            return;
+        }
+        if (headless.writeFrames) {
+            std::error_code error;
+            std::filesystem::create_directories(headless.outputDir, error);
+            frameCapture.initialize(width, height);
+        }
+
+        SoftwareRasterizer rasterizer;
+        std::vector<unsigned char> glPixels;
+        ImageDifference worst = { 0.0, 0, 0.0 };
+        if (headless.compare) {
+            rasterizer.setEnvironment(&scene.environment);
+            rasterizer.resize(width, height);
+            glPixels.resize((size_t)width * height * 4);
+        }
 
-            meshes[i].update(currentObjectRotationX, currentObjectRotationY, currentObjectRotationZ);
+        double start = glfwGetTime();
+        // A leitura do frame e o rasterizador em CPU ficam fora do tempo da OpenGL
+        double compareSeconds = 0.0;
+
+        for (int frame = 0; frame < headless.frames; ++frame) {
+            target.bind();
+            renderFrame(HEADLESS_TIMESTEP);
+
+            if (headless.writeFrames) {
+                char fileName[32];
+                snprintf(fileName, sizeof(fileName), "frame_%05d.%s", frame, headless.format.c_str());
+                frameCapture.capture(target.getFramebuffer(), headless.outputDir + fileName);
+            }
+
+            if (headless.compare) {
+                double compareStart = glfwGetTime();
+                target.readPixels(glPixels);
+                rasterizer.render(camera, meshes, scene.lightSources);
+                ImageDifference difference = SoftwareRasterizer::compare(glPixels, rasterizer.getColor(), headless.tolerance);
+                if (difference.mismatchPercent >= worst.mismatchPercent) {
+                    worst = difference;
+                }
+                compareSeconds += glfwGetTime() - compareStart;
+            }
+        }
+        glFinish();
+        double renderSeconds = glfwGetTime() - start - compareSeconds;
+
+        frameCapture.flush();
+        double seconds = glfwGetTime() - start - compareSeconds;
+
+        cout << headless.frames << " frames " << width << "x" << height << " em " << seconds << " s: "
+             << headless.frames / seconds << " FPS";
+        if (headless.writeFrames) {
+            cout << " (render " << renderSeconds << " s, captura " << frameCapture.getCaptureMs() << " ms/frame no thread de render, "
+                 << frameCapture.getWrittenFrames() << " arquivos em " << headless.outputDir << ")";
+        }
+        cout << endl;
+        if (headless.compare) {
+            cout << "OpenGL x CPU (pior frame): erro médio " << worst.meanError << ", máximo " << worst.maxError
+                 << ", " << worst.mismatchPercent << "% dos pixels acima da tolerância " << headless.tolerance
+                 << " (comparação " << compareSeconds << " s, fora do tempo acima)" << endl;
+        }
+        target.release();
+    }
+
+    // Sem contexto OpenGL: a cena fica só na memória e cada frame sai do rasterizador em CPU
+    void runSoftware() {
+        int width = headless.width, height = headless.height;
+
+        if (!scene.loadConfig("../assets/scene_config.json")) {
+            cerr << "Falha ao carregar configuração da cena. Saindo." << endl;
+            return;
+        }
+        scene.uploadToGpu = false;
+        scene.keepCpuData = true;
+        scene.bakeLightmaps = false;
+        scene.setupScene(nullptr, nullptr, &camera, meshes, bezierCurves);
+        applySceneCamera(width, height);
+        spawnEntities();
+        gatherLights();
+
+        if (headless.threads > 0) {
+            jobSystem.reset(new JobSystem(headless.threads));
+        }
+        SoftwareRasterizer rasterizer;
+        rasterizer.setJobSystem(jobSystem.get());
+        rasterizer.setEnvironment(&scene.environment);
+        rasterizer.resize(width, height);
+
+        if (headless.writeFrames) {
+            std::error_code error;
+            std::filesystem::create_directories(headless.outputDir, error);
+            frameCapture.initialize(width, height, 0);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        double rasterMs = 0.0;
+        for (int frame = 0; frame < headless.frames; ++frame) {
+            updatePaths(HEADLESS_TIMESTEP);
+            updateSelectedRotation();
+            rasterizer.render(camera, meshes, scene.lightSources);
+            rasterMs += rasterizer.getLastMs();
+
+            if (headless.writeFrames) {
+                char fileName[32];
+                snprintf(fileName, sizeof(fileName), "frame_%05d.%s", frame, headless.format.c_str());
+                frameCapture.write(headless.outputDir + fileName, rasterizer.getColor().data());
+            }
+        }
+        frameCapture.flush();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        unsigned int threads = jobs().getThreadCount();
+        cout << headless.frames << " frames " << width << "x" << height << " em CPU (" << threads << " threads) em "
+             << seconds << " s: " << headless.frames / seconds << " FPS, " << (headless.frames > 0 ? rasterMs / headless.frames : 0.0) << " ms/frame de raster, "
+             << rasterizer.getLastTriangleCount() << " triângulos" << endl;
+        reportArenas();
+    }
+
+    void toggleRecording() {
+        if (!recording) {
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            std::error_code error;
+            std::filesystem::create_directories(headless.outputDir, error);
+            frameCapture.initialize(width, height);
+            recordedFrames = 0;
+            recording = true;
+            cout << "Gravando frames em " << headless.outputDir << endl;
+        } else {
+            frameCapture.flush();
+            recording = false;
+            cout << "Gravação parada: " << frameCapture.getWrittenFrames() << " frames, "
+                 << frameCapture.getCaptureMs() << " ms/frame no thread de render" << endl;
+        }
+    }
+
+    // Uma entidade por objeto carregado (Transform e Renderable; os animados também BezierPath e
+    // PathProgress) e uma por luz (Transform e Light)
+    void spawnEntities() {
+        world.clear();
+        objectEntities.clear();
+        staticObjects.clear();
+        for (size_t i = 0; i < scene.loadedObjects.size(); ++i) {
+            const LoadedObject& loaded = scene.loadedObjects[i];
+            const ObjectConfig& config = scene.objects[loaded.config];
+            const ObjectTransformConfig& pose = config.initial_transform;
+            Transform transform = { pose.position, pose.rotation_angle, pose.rotation_axis, pose.scale, glm::mat4(1.0f) };
+            transform.updateModel();
+            meshes[i].setModelMatrix(transform.model, transform.scale);
+            Renderable renderable = { (int)i };
+            if (loaded.curve >= 0) {
+                const Bezier& curve = bezierCurves[loaded.curve];
+                BezierPath path = { loaded.curve, curve.getSpeed(), curve.getFollowTrajectory() };
+                objectEntities.push_back(world.create(transform, renderable, path, PathProgress{ 0.0f }));
+            } else {
+                objectEntities.push_back(world.create(transform, renderable));
+            }
+            staticObjects.push_back(config.animation.type == "none");
+        }
+        for (const LightSourceConfig& source : scene.lightSources) {
+            spawnLight(source);
+        }
+    }
+
+    void spawnLight(const LightSourceConfig& source) {
+        Transform transform = { source.position, 0.0f, glm::vec3(0.0f, 1.0f, 0.0f), 1.0f, glm::mat4(1.0f) };
+        transform.updateModel();
+        world.create(transform, Light{ source.ambient, source.diffuse, source.specular, source.intensity,
+                                       source.radius, source.castsShadows, source.shadowResolution });
+    }
+
+    // Lista compacta das luzes para os renderers, refeita só quando as entidades de luz mudam
+    void gatherLights() {
+        scene.lightSources.clear();
+        world.each<Transform, Light>([this](Entity, Transform& transform, Light& light) {
+            scene.lightSources.push_back({ transform.position, light.ambient, light.diffuse, light.specular,
+                                           light.intensity, light.radius, light.castsShadows, light.shadowResolution });
+        });
+    }
+
+    // Só as entidades com curva: o custo acompanha os objetos animados, não a cena inteira
+    void updatePaths(double deltaTime) {
+        world.parallelEach<Transform, Renderable, BezierPath, PathProgress>(jobs(),
+            [this, deltaTime](Entity, Transform& transform, Renderable& renderable, BezierPath& path, PathProgress& progress) {
+            int numCurvePoints = bezierCurves[path.curve].getNbCurvePoints();
+            if (!path.follow || numCurvePoints == 0) {
+                return;
+            }
+            progress.t += path.speed * deltaTime * 100.0f;
+            if (progress.t >= 1.0f) {
+                progress.t = 0.0f;
+            }
+            int curveIndex = static_cast<int>(progress.t * numCurvePoints);
+            curveIndex = glm::min(curveIndex, numCurvePoints - 1);
+            transform.position = bezierCurves[path.curve].getPointOnCurve(curveIndex);
+            transform.updateModel();
+            meshes[renderable.mesh].setModelMatrix(transform.model, transform.scale);
+        });
+    }
+
+    // Rotação contínua do objeto selecionado (teclas X/Y/Z): como no Mesh::update, o ângulo inicial
+    // mais o tempo, em radianos, no lugar da rotação do Transform
+    void updateSelectedRotation() {
+        if ((!rotateX && !rotateY && !rotateZ) || selectedObjectIndex >= (int)objectEntities.size()) {
+            return;
+        }
+        Entity entity = objectEntities[selectedObjectIndex];
+        Transform& transform = *world.get<Transform>(entity);
+        glm::vec3 axis = rotateX ? glm::vec3(1.0f, 0.0f, 0.0f) : rotateY ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), transform.position);
+        model = glm::rotate(model, transform.rotationAngle + (GLfloat)glfwGetTime(), axis);
+        model = glm::scale(model, glm::vec3(transform.scale));
+        transform.model = model;
+        meshes[world.get<Renderable>(entity)->mesh].setModelMatrix(model, transform.scale);
+    }
+
+    // Refaz a matriz depois de uma mudança de pose fora dos sistemas (teclado)
+    void commitTransform(Entity entity) {
+        Transform& transform = *world.get<Transform>(entity);
+        transform.updateModel();
+        meshes[world.get<Renderable>(entity)->mesh].setModelMatrix(transform.model, transform.scale);
+    }
+
+    // Vincula o bloco "Object" do mesh: o intervalo no anel ou, se ele não coube, uma cópia em objectFallback
+    void bindMeshBlock(size_t i) {
+        if (objectBlocks[i].data) {
+            frameRing.bindRange(GL_UNIFORM_BUFFER, Mesh::OBJECT_UBO_BINDING, objectBlocks[i]);
+            return;
+        }
+        Mesh::ObjectBlock block;
+        meshes[i].writeObjectBlock(block);
+        objectFallback.upload(sizeof(block), &block);
+        glBindBufferRange(GL_UNIFORM_BUFFER, Mesh::OBJECT_UBO_BINDING, objectFallback.get(), 0, sizeof(block));
+    }
+
+    // Meshes sem bloco (no anel ou fora dele) ficaram fora do frustum
+    void drawMeshes() {
+        Shader* current = nullptr;
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            if (!objectBlocks[i].data && !overflowedObjects[i]) {
+                continue;
+            }
+            if (meshes[i].getShader() != current) {
+                current = meshes[i].getShader();
+                current->Use();
+                Mesh::bindObjectBlock(current);
+            }
+            bindMeshBlock(i);
             meshes[i].draw();
         }
     }
 
+    // Meshes com a mesma permutação ficam em sequência; os uniforms globais só são
+    // reenviados quando o programa muda, e a textura só quando muda de um mesh para o seguinte
+    // (objetos na mesma página do atlas não trocam de textura)
+    void drawMeshesForward() {
+        Shader* current = nullptr;
+        GLuint boundTexture = 0;
+        textureBinds = 0;
+        for (size_t index : forwardOrder) {
+            if (!objectBlocks[index].data && !overflowedObjects[index]) {
+                continue;
+            }
+            Mesh& mesh = meshes[index];
+            if (mesh.getShader() != current) {
+                current = mesh.getShader();
+                current->Use();
+                camera.apply(current);
+                clusteredLights.bind(current);
+                shadowMaps.bind(current);
+                Mesh::bindObjectBlock(current);
+            }
+            bindMeshBlock(index);
+            bool bindTexture = textureBinds == 0 || mesh.getTextureID() != boundTexture;
+            if (bindTexture) {
+                boundTexture = mesh.getTextureID();
+                ++textureBinds;
+            }
+            mesh.draw(bindTexture);
+        }
+    }
+
+    // Objetos sem textura usam a permutação sem TEXTURED, os com camada num texture array a
+    // TEXTURE_ARRAY e os estáticos com lightmap a LIGHTMAP, cada uma compilada só se algum objeto precisar dela
+    void assignForwardShaders() {
+        for (auto& mesh : meshes) {
+            ShaderDefines defines;
+            if (mesh.getTextureID() != 0) {
+                defines["TEXTURED"] = "";
+                if (mesh.getTextureLayer() >= 0) {
+                    defines["TEXTURE_ARRAY"] = "";
+                }
+            }
+            if (mesh.getLightmapID() != 0) {
+                defines["LIGHTMAP"] = "";
+            }
+            mesh.setShader(shaderLibrary.get("object.vs", "object.fs", defines));
+        }
+
+        forwardOrder.resize(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            forwardOrder[i] = i;
+        }
+        std::stable_sort(forwardOrder.begin(), forwardOrder.end(), [this](size_t a, size_t b) {
+            if (meshes[a].getShader() != meshes[b].getShader()) {
+                return meshes[a].getShader() < meshes[b].getShader();
+            }
+            return meshes[a].getTextureID() < meshes[b].getTextureID();
+        });
+    }
+
     void drawBezierCurves() {
         for (size_t i = 0; i < bezierCurves.size(); ++i) {
             if (bezierCurves[i].getNbCurvePoints() > 0) {
@@ -156,32 +714,161 @@ private:
         }
     }
 
-    void cleanup() {
-        for (const auto& mesh : meshes) {
-            glDeleteVertexArrays(1, &mesh.VAO);
+    // Espalha luzes pontuais aleatórias ao redor da cena para testar o forward+ clusterizado
+    void addRandomLights(int count) {
+        static std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> pos(-5.0f, 5.0f);
+        std::uniform_real_distribution<float> color(0.2f, 1.0f);
+        for (int i = 0; i < count; ++i) {
+            glm::vec3 c(color(rng), color(rng), color(rng));
+            spawnLight({
+                glm::vec3(pos(rng), pos(rng) * 0.5f, pos(rng)),
+                glm::vec3(0.0f), c, c, 1.0f, 1.5f, false, 0
+            });
+        }
+        gatherLights();
+        clusteredLights.setLights(scene.lightSources);
+        cout << "Luzes na cena: " << clusteredLights.getLightCount() << endl;
+    }
+
+    void setRenderMode(RenderMode mode) {
+        if (mode == RenderMode::Deferred && !deferredAvailable) {
+            cout << "Modo deferred indisponível (G-buffer não foi criado)." << endl;
+            return;
+        }
+        renderMode = mode;
+        if (mode == RenderMode::Deferred) {
+            for (auto& mesh : meshes) {
+                mesh.setShader(deferredRenderer.getGeometryShader(mesh.getTextureID() != 0, mesh.getTextureLayer() >= 0));
+            }
+        } else {
+            assignForwardShaders();
+        }
+        cout << "Modo de renderização: " << (mode == RenderMode::Deferred ? "deferred" : "forward") << endl;
+    }
+
+    void updateWindowTitle() {
+        char title[160];
+        if (renderMode == RenderMode::Deferred) {
+            snprintf(title, sizeof(title), "PreparacaoGrauB - Gabriel | deferred | G-buffer %.2f ms | luzes %.2f ms | %d luzes",
+                     deferredRenderer.getGeometryMs(), deferredRenderer.getLightingMs(), clusteredLights.getLightCount());
+        } else {
+            snprintf(title, sizeof(title), "PreparacaoGrauB - Gabriel | forward | %.2f ms | %d luzes",
+                     forwardTimer.getMilliseconds(), clusteredLights.getLightCount());
         }
+        glfwSetWindowTitle(window, title);
+    }
+
+    void reportTextures() {
+        cout << "Texturas: " << textureLoader.getCompleted() << " carregadas em " << textureLoader.getLoadMs()
+             << " ms em segundo plano (PBO " << (textureLoader.isPersistent() ? "persistente" : "de streaming")
+             << ", no máximo " << textureLoader.getMaxUpdateMs() << " ms por frame no thread de render, "
+             << (TextureCache::instance().isCompressionEnabled() ? "BC1/BC3" : "RGBA8") << ")" << endl;
+        if (scene.streamTextures && !headless.enabled) {
+            cout << "Streaming de texturas: " << textureLoader.getResidentBytes() / (1024.0 * 1024.0) << " MB residentes de "
+                 << textureLoader.getMemoryBudget() / (1024.0 * 1024.0) << " MB (prévia de " << textureLoader.getPreviewSize()
+                 << " texels, " << textureLoader.getStreamedLevels() << " níveis sob demanda, "
+                 << textureLoader.getEvictions() << " devoluções)" << endl;
+        }
+        reportGpuMemory();
+        if (renderMode == RenderMode::Forward) {
+            cout << "Forward: " << textureBinds << " trocas de textura por frame para " << meshes.size() << " objetos"
+                 << (scene.atlasTextures ? " (atlas ligado)" : "") << endl;
+        }
+        texturesReported = true;
+    }
+
+    void reportGpuMemory() {
+        GLBufferPool& pool = GLBufferPool::instance();
+        cout << "Memória de vídeo: " << GpuResources::instance().describe() << endl;
+        cout << "Pool de buffers: " << pool.getHits() << " reaproveitados, " << pool.getMisses() << " criados, "
+             << pool.getPooledBytes() / (1024.0 * 1024.0) << " MB livres" << endl;
+        cout << "Anel por frame: " << (frameRing.isPersistent() ? "mapeamento persistente" : "orphaning") << ", "
+             << frameRing.getFrameBytes() / 1024.0 << " KB x " << FrameRing::FRAMES << ", pico " << frameRing.getPeakBytes() / 1024.0
+             << " KB, " << frameRing.getWaits() << " esperas por fence (" << frameRing.getWaitMs() << " ms)" << endl;
+        reportArenas();
+    }
+
+    // Cada alocação servida por um arena (o do frame e os de rascunho dos threads) seria um new no heap
+    void reportArenas() {
+        uint64_t allocations = LinearArena::getTotalAllocations();
+        uint64_t blocks = LinearArena::getTotalBlockAllocations();
+        cout << "Arenas: " << allocations << " alocações temporárias (" << LinearArena::getTotalBytes() / (1024.0 * 1024.0)
+             << " MB) com " << blocks << " blocos pedidos ao heap, " << allocations - blocks << " alocações no heap evitadas; "
+             << frameArena.getAllocations() << " no arena do frame (" << frameArena.getReservedBytes() / 1024.0 << " KB)" << endl;
+    }
+
+    // Meshes e curvas soltam a geometria com a última cópia (os buffers voltam ao pool, esvaziado no fim);
+    // texturas e lightmaps são da cena. Tudo o que guarda objetos GL é solto aqui, antes do glfwTerminate:
+    // os destrutores dos membros só rodam depois, sem contexto
+    void cleanup() {
+        world.clear();
+        objectEntities.clear();
+        meshes.clear();
+        bezierCurves.clear();
+        objectFallback.reset();
+        scene.release();
+        GLBufferPool::instance().clear();
+        frameRing.release();
+        textureLoader.release();
+        clusteredLights.release();
+        forwardTimer.release();
+        deferredRenderer.release();
+        frameCapture.release();
+        shadowMaps.release();
+        objectShader = nullptr;
+        curveShader = nullptr;
+        shaderLibrary.release();
     }
 
-    void setupWindow() {
+    bool setupWindow() {
+#ifdef __linux__
+        // Sem servidor gráfico (servidores sem GPU) usa a plataforma nula da GLFW com contexto
+        // OSMesa/EGL, que funcionam com o llvmpipe do Mesa
+        if (headless.enabled && !getenv("DISPLAY") && !getenv("WAYLAND_DISPLAY")) {
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        }
+#endif
         glfwInit();
 
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+        if (headless.enabled) {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            if (glfwGetPlatform() == GLFW_PLATFORM_NULL) {
+                glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            }
+        }
+
         window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "PreparacaoGrauB - Gabriel", nullptr, nullptr);
+        if (!window && headless.enabled) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+            window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "PreparacaoGrauB - Gabriel", nullptr, nullptr);
+        }
+        if (!window) {
+            cerr << "Falha ao criar o contexto OpenGL" << endl;
+            return false;
+        }
         glfwMakeContextCurrent(window);
 
-        glfwSetWindowUserPointer(window, this);
+        if (headless.enabled) {
+            glfwSwapInterval(0);
+        } else {
+            glfwSetWindowUserPointer(window, this);
 
-        glfwSetKeyCallback(window, keyCallbackStatic);
-        glfwSetCursorPosCallback(window, mouseCallbackStatic);
+            glfwSetKeyCallback(window, keyCallbackStatic);
+            glfwSetCursorPosCallback(window, mouseCallbackStatic);
 
-        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        }
 
         if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
             cout << "Falha ao inicializar GLAD" << endl;
         }
+        // Também decide a compressão do TextureCache: sem S3TC as texturas são cozidas (e enviadas) em RGBA8
+        GLExtensions::initialize((GLADloadproc)glfwGetProcAddress);
 
         const GLubyte* renderer = glGetString(GL_RENDERER);
         const GLubyte* version = glGetString(GL_VERSION);
@@ -189,12 +876,30 @@ private:
         cout << "OpenGL version supported " << version << endl;
 
         glEnable(GL_DEPTH_TEST);
+        return true;
     }
 
     void resetAllRotate() {
         rotateX = false;
         rotateY = false;
         rotateZ = false;
+        // A rotação contínua só existia na matriz: o selecionado volta para a pose do Transform
+        if (selectedObjectIndex < (int)objectEntities.size()) {
+            commitTransform(objectEntities[selectedObjectIndex]);
+        }
+    }
+
+    // Como no Mesh::update de antes, que refazia todos os meshes a cada frame: o objeto que deixa a
+    // seleção para de girar e volta à sua rotação configurada (o novo só gira com X/Y/Z)
+    void selectObject(int index) {
+        int previous = selectedObjectIndex;
+        rotateX = false;
+        rotateY = false;
+        rotateZ = false;
+        selectedObjectIndex = index;
+        if (previous < (int)objectEntities.size()) {
+            commitTransform(objectEntities[previous]);
+        }
     }
 
     // Callbacks need to be static to match GLFW signature, so we forward to instance methods
@@ -215,24 +920,37 @@ private:
         if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
             glfwSetWindowShouldClose(window, GL_TRUE);
 
+        if (key == GLFW_KEY_L && action == GLFW_PRESS)
+            addRandomLights(32);
+
+        if (key == GLFW_KEY_R && action == GLFW_PRESS)
+            setRenderMode(renderMode == RenderMode::Forward ? RenderMode::Deferred : RenderMode::Forward);
+
+        if (key == GLFW_KEY_C && action == GLFW_PRESS)
+            toggleRecording();
+
+        if (key == GLFW_KEY_M && action == GLFW_PRESS)
+            reportGpuMemory();
+
         if (key >= GLFW_KEY_1 && key <= GLFW_KEY_9 && action == GLFW_PRESS) {
             int index = key - GLFW_KEY_1;
-            if (index < meshes.size()) {
-                selectedObjectIndex = index;
-                resetAllRotate();
-                cout << "Objeto selecionado: " << scene.objects[selectedObjectIndex].name << endl;
+            if (index < (int)objectEntities.size()) {
+                selectObject(index);
+                cout << "Objeto selecionado: " << scene.objects[scene.loadedObjects[selectedObjectIndex].config].name << endl;
             }
         }
 
-        if (selectedObjectIndex < meshes.size()) {
-            glm::vec3 currentObjectPos = meshes[selectedObjectIndex].getPosition();
+        if (selectedObjectIndex < (int)objectEntities.size()) {
+            Entity selected = objectEntities[selectedObjectIndex];
+            Transform& transform = *world.get<Transform>(selected);
+            const ObjectConfig& config = scene.objects[scene.loadedObjects[selectedObjectIndex].config];
             if (action == GLFW_PRESS || action == GLFW_REPEAT) {
                 switch (key) {
                     case GLFW_KEY_LEFT_BRACKET:
-                        meshes[selectedObjectIndex].setScale(meshes[selectedObjectIndex].scale_ * (1.0f - scaleStep));
+                        transform.scale *= 1.0f - scaleStep;
                         break;
                     case GLFW_KEY_RIGHT_BRACKET:
-                        meshes[selectedObjectIndex].setScale(meshes[selectedObjectIndex].scale_ * (1.0f + scaleStep));
+                        transform.scale *= 1.0f + scaleStep;
                         break;
                     case GLFW_KEY_X:
                         resetAllRotate();
@@ -248,49 +966,40 @@ private:
                         break;
                     case GLFW_KEY_P:
                         resetAllRotate();
-                        meshes[selectedObjectIndex].setPosition(scene.objects[selectedObjectIndex].initial_transform.position);
-                        meshes[selectedObjectIndex].setRotation(scene.objects[selectedObjectIndex].initial_transform.rotation_angle, scene.objects[selectedObjectIndex].initial_transform.rotation_axis);
-                        meshes[selectedObjectIndex].setScale(scene.objects[selectedObjectIndex].initial_transform.scale);
-                        cout << "Transformações do objeto " << scene.objects[selectedObjectIndex].name << " resetadas." << endl;
+                        transform.position = config.initial_transform.position;
+                        transform.rotationAngle = config.initial_transform.rotation_angle;
+                        transform.rotationAxis = config.initial_transform.rotation_axis;
+                        transform.scale = config.initial_transform.scale;
+                        cout << "Transformações do objeto " << config.name << " resetadas." << endl;
                         break;
                     case GLFW_KEY_UP:
-                        currentObjectPos.z -= translateStep;
-                        meshes[selectedObjectIndex].setCurrentPosition(currentObjectPos);
+                        transform.position.z -= translateStep;
                         break;
                     case GLFW_KEY_DOWN:
-                        currentObjectPos.z += translateStep;
-                        meshes[selectedObjectIndex].setCurrentPosition(currentObjectPos);
+                        transform.position.z += translateStep;
                         break;
                     case GLFW_KEY_LEFT:
-                        currentObjectPos.x -= translateStep;
-                        meshes[selectedObjectIndex].setCurrentPosition(currentObjectPos);
+                        transform.position.x -= translateStep;
                         break;
                     case GLFW_KEY_RIGHT:
-                        currentObjectPos.x += translateStep;
-                        meshes[selectedObjectIndex].setCurrentPosition(currentObjectPos);
+                        transform.position.x += translateStep;
                         break;
                     case GLFW_KEY_PAGE_UP:
-                        currentObjectPos.y += translateStep;
-                        meshes[selectedObjectIndex].setCurrentPosition(currentObjectPos);
+                        transform.position.y += translateStep;
                         break;
                     case GLFW_KEY_PAGE_DOWN:
-                        currentObjectPos.y -= translateStep;
-                        meshes[selectedObjectIndex].setCurrentPosition(currentObjectPos);
+                        transform.position.y -= translateStep;
                         break;
                     case GLFW_KEY_V:
-                        if (selectedObjectIndex < bezierCurves.size()) {
-                            if (selectedObjectIndex < scene.objects.size() && scene.objects[selectedObjectIndex].animation.type == "bezier") {
-                                bezierCurves[selectedObjectIndex].setFollowTrajectory(!bezierCurves[selectedObjectIndex].getFollowTrajectory());
-                                cout << "Trajetória para " << scene.objects[selectedObjectIndex].name << " "
-                                     << (bezierCurves[selectedObjectIndex].getFollowTrajectory() ? "ativada." : "desativada.") << endl;
-                            } else {
-                                cout << "Nenhuma trajetória Bezier definida para o objeto selecionado." << endl;
-                            }
+                        if (BezierPath* path = world.get<BezierPath>(selected)) {
+                            path->follow = !path->follow;
+                            cout << "Trajetória para " << config.name << " " << (path->follow ? "ativada." : "desativada.") << endl;
                         } else {
-                            cout << "Nenhum dado de trajetória disponível para o objeto selecionado." << endl;
+                            cout << "Nenhuma trajetória Bezier definida para o objeto selecionado." << endl;
                         }
                         break;
                 }
+                commitTransform(selected);
             }
         }
 
@@ -304,8 +1013,48 @@ private:
     }
 };
 
-int main() {
-    Application app;
+int main(int argc, char** argv) {
+    HeadlessOptions headless;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless.enabled = true;
+        } else if (arg == "--deferred") {
+            headless.deferred = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            headless.frames = atoi(argv[++i]);
+        } else if (arg == "--size" && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &headless.width, &headless.height);
+        } else if (arg == "--output" && i + 1 < argc) {
+            headless.outputDir = argv[++i];
+            if (!headless.outputDir.empty() && headless.outputDir.back() != '/') headless.outputDir += '/';
+        } else if (arg == "--format" && i + 1 < argc) {
+            headless.format = argv[++i];
+        } else if (arg == "--no-output") {
+            headless.writeFrames = false;
+        } else if (arg == "--software") {
+            headless.enabled = true;
+            headless.software = true;
+        } else if (arg == "--compare") {
+            headless.compare = true;
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            headless.tolerance = atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            headless.threads = (unsigned int)atoi(argv[++i]);
+        } else {
+            cerr << "Uso: trab [--headless [--deferred] [--compare [--tolerance N]] | --software [--threads N]] [--frames N] [--size LxA]"
+                 << " [--output DIR] [--format png|ppm] [--no-output]" << endl;
+            return 1;
+        }
+    }
+
+    // A comparação roda dentro do runHeadless: na janela ou só em CPU não há o que comparar
+    if (headless.compare && (!headless.enabled || headless.software)) {
+        cerr << "--compare precisa de --headless (sem --software)" << endl;
+        return 1;
+    }
+
+    Application app(headless);
     app.run();
     return 0;
 }
\ No newline at end of file